@@ -24,6 +24,7 @@ limitations under the License.
 #include    "TCartoolDocManager.h"
 #include    "TCartoolMdiChild.h"
 #include    "Dialogs.Input.h"
+#include    "Time.Utils.h"
 
 #include    "TBaseDoc.h"
 #include    "TEegBIDMC128Doc.h"
@@ -87,9 +88,29 @@ TCartoolMdiClient*  TCartoolObjects::CartoolMdiClient       = 0;
 
 bool    TCartoolObjects::IsInteractive      () const    { return CartoolApplication && CartoolApplication->IsInteractive    (); }
 bool    TCartoolObjects::IsNotInteractive   () const    { return CartoolApplication && CartoolApplication->IsNotInteractive (); }
+
+
 void    TCartoolObjects::UpdateApplication  () const    { if ( IsMainThread () && CartoolApplication )  CartoolApplication->PumpWaitingMessages (); }
 
 
+void    TCartoolObjects::UpdateApplicationThrottled () const
+{
+if ( ! IsMainThread () || CartoolApplication == 0 )
+    return;
+
+                                        // main thread only, no need for atomics here
+static ULONGLONG    lasttime        = 0;
+ULONGLONG           now             = GetWindowsTimeInMillisecond ();
+
+if ( now - lasttime < UpdateApplicationDelay )
+    return;
+
+lasttime    = now;
+
+CartoolApplication->PumpWaitingMessages ();
+}
+
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 // To add a new type of EEG file:
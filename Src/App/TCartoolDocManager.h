@@ -51,8 +51,13 @@ public:
     bool                                IsNotInteractive () const;
                                         // Used to force the event list to be processed, keeping the application responsive
     void                                UpdateApplication() const;
+                                        // Same, for tight and parallel loops: only the main thread will actually process the messages, and not more often than UpdateApplicationDelay
+    void                                UpdateApplicationThrottled () const;
 };
 
+                                        // Processing messages more often than the screen refresh is just wasting time - [ms]
+constexpr ULONGLONG     UpdateApplicationDelay  = 15;
+
                                         // Creating a global object for those functions with a lack of class
 extern  TCartoolObjects     Cartool;
 
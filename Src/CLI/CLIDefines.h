@@ -296,6 +296,9 @@ constexpr char*     __savingtemplates           = "--savingtemplates";
 constexpr char*     __savingzscoreS             = "-z";
 constexpr char*     __savingzscore              = "--savingzscore";
 
+constexpr char*     __maxsubjects               = "--maxsubjects";
+constexpr char*     __maxmemory                 = "--maxmemory";
+
 
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
@@ -127,6 +127,16 @@ DefineCLIFlag           ( computingris,     __savingzscoreS,            __saving
 ExcludeCLIOptions       ( computingris,     __savingtemplates,      __savingsubjects );
 
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+DefineCLIOptionInt      ( computingris,     "",     __maxsubjects,          "Max number of subjects per centroids batch, computed concurrently - preprocessing is always one subject at a time (Default is the number of threads)" );
+DefineCLIOptionDouble   ( computingris,     "",     __maxmemory,            "Memory ceiling for subjects kept in memory, value in [MB] (Default is half the available memory)" )
+->CheckOption           ( [ &computingris ]( const string& str )   
+    {   if ( StringToDouble ( str.c_str () ) < 0 ) return "memory ceiling, in [MB], should be positive";
+        return ""; 
+    } );
+
+
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 DefineCLIFlag           ( computingris,     "",     __verbose,              __verbose_descr     );
@@ -407,6 +417,16 @@ if ( ! isprocessing ) {
     return;
     }
 
+                                        // default values will be set by the processing itself
+int                 maxsubjects             = 0;
+double              maxmemory               = 0;
+
+if ( HasCLIOption ( computingris, __maxsubjects ) )
+    maxsubjects     = AtLeast ( 0, GetCLIOptionInt    ( computingris, __maxsubjects ) );
+
+if ( HasCLIOption ( computingris, __maxmemory ) )
+    maxmemory       = AtLeast ( 0.0, GetCLIOptionDouble ( computingris, __maxmemory ) );
+
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // CanOpenFiles done here
@@ -572,6 +592,10 @@ verbose.NextTopic ( "Options:" );
 {
 verbose.Put ( "Verbose mode:",                          IsInteractive ( execflags ) );
 verbose.Put ( "Overwriting existing files:",            IsOverwrite   ( execflags ) );
+if ( maxsubjects )  verbose.Put ( "Max subjects per centroids batch:",   maxsubjects );
+else                verbose.Put ( "Max subjects per centroids batch:",   "Default" );
+if ( maxmemory   )  verbose.Put ( "Memory ceiling:",            maxmemory, 0, " [MB]" );
+else                verbose.Put ( "Memory ceiling:",            "Default" );
 }
 
 
@@ -597,6 +621,7 @@ ComputingRis    (   esicase,
 
                     savingindividualfiles,  savingepochfiles,       savingzscorefactors,
                     computegroupsaverages,  computegroupscentroids,
+                    maxsubjects,            maxmemory,
 
                     outputdir,
                     prefix.c_str (),
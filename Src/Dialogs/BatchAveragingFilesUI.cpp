@@ -218,9 +218,9 @@ if      (   tg.alleeg
                                         // Vectorial to scalar ris is also done here
        || ( tg.allris && ( ! tg.allrisv || risvtos ) ) )    BatchAveragingScalar        (   gof,
                                                                                             meanfile,           sdfile,             0,
-                                                                                            0,                  0,
-//                                                                                          meanfile,           sdfile,             snrfile,
-//                                                                                          medianfile,   madfile,
+                                                                                            0,                  0,                  0,
+//                                                                                          meanfile,           sdfile,             sefile,
+//                                                                                          snrfile,            medianfile,         madfile,
                                                                                             ExecFlags ( Interactive | DefaultOverwrite | OpenResults )
                                                                                         );
 else if   ( tg.allrisv ) {
@@ -2688,6 +2688,7 @@ if ( ! ComputingRis (   esicase,
 
                         savingindividualfiles,  savingepochfiles,       savingzscorefactors,
                         computegroupsaverages,  computegroupscentroids,
+                        0,                      0,                      // default concurrency and memory ceiling
                         0,                      // no output dir specified
                         basefilename,
                         execflags
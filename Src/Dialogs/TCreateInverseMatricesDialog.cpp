@@ -4701,7 +4701,7 @@ if ( leadfieldprocessing ) {
                     Verbose.PutTable ( statradius[ li ].Median ( false ) * ( IsTissuesLimitRel ( li ) ? 100 : 1 ), 2 );
 
                 for ( int li = 0; li < NumTissuesLimits; li++ )
-                    Verbose.PutTable ( statradius[ li ].Sn ( 1000 )      * ( IsTissuesLimitRel ( li ) ? 100 : 1 ), 2 );
+                    Verbose.PutTable ( statradius[ li ].Sn ()            * ( IsTissuesLimitRel ( li ) ? 100 : 1 ), 2 );
 
 
                 Verbose.EndTable ();
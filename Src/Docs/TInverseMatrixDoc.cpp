@@ -27,6 +27,7 @@ limitations under the License.
 #include    "Strings.Utils.h"
 #include    "Files.Utils.h"
 #include    "TTracks.h"
+#include    "TRois.h"
 
 #include    "Files.WriteInverseMatrix.h"
 
@@ -52,6 +53,8 @@ NumElectrodes       = 0;
 NumSolPoints        = 0;
 NumRegularizations  = 0;
 AveragingPrecedence = AverageDefault;
+
+ResetRoisMatrices ();
 }
 
 
@@ -97,6 +100,8 @@ bool    TInverseMatrixDoc::Revert ( bool clear )
 if ( ! TFileDocument::Revert ( clear ) )
     return  false;
 
+ResetRoisMatrices ();
+
 if ( ! clear )
     Open ( GetOpenMode (), GetDocPath () );
 //  Open ( ofRead, 0 );
@@ -118,6 +123,8 @@ return  true;
 
 bool    TInverseMatrixDoc::Close ()
 {
+ResetRoisMatrices ();
+
 return  TFileDocument::Close ();
 }
 
@@ -630,6 +637,147 @@ else {
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Averaging the results within each ROI is linear, so it can be moved onto the matrix itself:
+                                        // the mean of the rows of a ROI, times the EEG, is the mean of the results of that ROI
+                                        // This does not hold for the norm of vectorial results
+bool    TInverseMatrixDoc::CanReduceToRois ( const TRois* rois, bool vectorialresults )   const
+{
+return  rois                                // also ok when results are vectorial, as the 3 components are averaged separately
+     && rois->IsNotEmpty ()
+     && rois->GetDimension () == NumSolPoints
+     && ( vectorialresults || ! IsVector ( AtomTypeUseOriginal ) );
+}
+
+
+void    TInverseMatrixDoc::ResetRoisMatrices ()    const
+{
+MRois.clear ();
+
+MRoisContentId      = 0;
+MRoisNumRois        = 0;
+}
+
+                                        // Builds the reduced matrix for a given regularization, with one line per ROI and per component
+                                        // Not thread safe, but the doc is only accessed from the main thread
+void    TInverseMatrixDoc::UpdateRoisMatrix ( int reg, const TRois& rois )    const
+{
+                                        // new or modified ROIs invalidate all the reduced matrices
+if ( MRoisContentId != rois.GetContentId () ) {
+
+    ResetRoisMatrices ();
+
+    MRois.resize ( GetMaxRegularization () );
+
+    MRoisContentId      = rois.GetContentId ();
+    MRoisNumRois        = rois.GetNumRois ();
+    }
+
+if ( MRois[ reg ].IsAllocated () )
+    return;
+
+
+int                 numcomp         = IsVector ( AtomTypeUseOriginal ) ? 3 : 1;
+
+MRois[ reg ].Resize ( numcomp * MRoisNumRois, NumElectrodes );
+
+
+OmpParallelFor
+
+for ( int r = 0; r < MRoisNumRois; r++ ) {
+
+    const TSelection&   roisel          = rois[ r ].Selection;
+    double              numsp           = NonNull ( roisel.NumSet () );
+    TArray1<double>     rowsum ( NumElectrodes );
+
+    for ( int c = 0; c < numcomp; c++ ) {
+
+        rowsum.ResetMemory ();
+
+        for ( TIteratorSelectedForward seli ( roisel ); (bool) seli; ++seli ) {
+
+            const AReal*        toinvf      = &M[ reg ] ( numcomp * seli() + c, 0 );
+
+            for ( int el = 0; el < NumElectrodes; el++ )
+                rowsum[ el ]   += toinvf[ el ];
+            }
+
+
+        AReal*              toroi       = &MRois[ reg ] ( numcomp * r + c, 0 );
+
+        for ( int el = 0; el < NumElectrodes; el++ )
+            toroi[ el ]     = rowsum[ el ] / numsp;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Same results as MultiplyMatrix followed by rois.Average ( inv, FilterTypeMean ), caller should check CanReduceToRois first
+                                        // Each ROI gets its value on all its solution points, and solution points outside of any ROI are set to 0
+void    TInverseMatrixDoc::MultiplyMatrixRois ( int reg, const TMap& map, const TRois& rois, TArray1<float>& inv )  const
+{
+reg     = reg == RegularizationAutoLocal ? GetBestRegularization ( &map, 0, 0 ) 
+                                         : Clip ( reg, 0, GetMaxRegularization () - 1 );
+
+UpdateRoisMatrix ( reg, rois );
+
+
+inv.ResetMemory ();
+
+OmpParallelFor
+
+for ( int r = 0; r < MRoisNumRois; r++ ) {
+
+    const AReal*        toroi       = &MRois[ reg ] ( r, 0 );
+    double              sum         = 0;
+
+    for ( int el = 0; el < NumElectrodes; el++, toroi++ )
+        sum     += *toroi * map[ el ];
+
+                                        // overwrite on data (ok if no overlap in all selections)
+    for ( TIteratorSelectedForward seli ( rois[ r ].Selection ); (bool) seli; ++seli )
+        inv[ seli() ]   = sum;
+    }
+}
+
+
+void    TInverseMatrixDoc::MultiplyMatrixRois ( int reg, const TMap& map, const TRois& rois, TArray1<TVector3Float>& inv )  const
+{
+reg     = reg == RegularizationAutoLocal ? GetBestRegularization ( &map, 0, 0 ) 
+                                         : Clip ( reg, 0, GetMaxRegularization () - 1 );
+
+UpdateRoisMatrix ( reg, rois );
+
+
+bool                isvector        = IsVector ( AtomTypeUseOriginal );
+
+inv.ResetMemory ();
+
+OmpParallelFor
+
+for ( int r = 0; r < MRoisNumRois; r++ ) {
+
+    TVector3Float       v;
+
+    for ( int c = 0; c < ( isvector ? 3 : 1 ); c++ ) {
+                                        // inverse is scalar, results are vectorial so return dummy vectors ( value, 0, 0 )
+        const AReal*        toroi       = &MRois[ reg ] ( isvector ? 3 * r + c : r, 0 );
+        double              sum         = 0;
+
+        for ( int el = 0; el < NumElectrodes; el++, toroi++ )
+            sum     += *toroi * map[ el ];
+
+        v[ c ]  = sum;
+        }
+
+                                        // overwrite on data (ok if no overlap in all selections)
+    for ( TIteratorSelectedForward seli ( rois[ r ].Selection ); (bool) seli; ++seli )
+        inv[ seli() ]   = v;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // The real impact of  AveragingPrecedence  occurs when reading a vectorial inverse to a scalar buffer
 // otherwise the sums remain in their native dimensions, or better (scalar in a vector)
@@ -644,6 +792,27 @@ TTracks<float>      EegBuff;            // !will be resized in GetTracks!
 int                 numtf           = tf2 - tf1 + 1;
 
 
+if ( CanReduceToRois ( rois, false ) ) {
+                                        // everything is linear, so averaging the EEG before or after the inverse gives the same results
+    eegview->GetTracks ( tf1, tf2, EegBuff, ReferenceAverage );
+
+
+    TMap                EegBuffAvg ( NumElectrodes );
+
+    for ( int el = 0; el < NumElectrodes; el++ )
+    for ( int tf0 = 0; tf0 < numtf; tf0++ )
+        EegBuffAvg[ el ]   += EegBuff ( el, tf0 );
+
+
+    EegBuffAvg     /= numtf;
+
+                                        // then call the ROI-reduced inverse solution, which includes the ROIing
+    MultiplyMatrixRois ( reg, EegBuffAvg, *rois, inv );
+
+    return;
+    }
+
+
 if ( numtf == 1 ) {
                                         // always force average reference
     eegview->GetTracks ( tf1, tf1, EegBuff, ReferenceAverage );
@@ -714,6 +883,27 @@ TTracks<float>      EegBuff;            // !will be resized in GetTracks!
 int                 numtf           = tf2 - tf1 + 1;
 
 
+if ( CanReduceToRois ( rois, true ) ) {
+                                        // everything is linear, so averaging the EEG before or after the inverse gives the same results
+    eegview->GetTracks ( tf1, tf2, EegBuff, ReferenceAverage );
+
+
+    TMap                EegBuffAvg ( NumElectrodes );
+
+    for ( int el = 0; el < NumElectrodes; el++ )
+    for ( int tf0 = 0; tf0 < numtf; tf0++ )
+        EegBuffAvg[ el ]   += EegBuff ( el, tf0 );
+
+
+    EegBuffAvg     /= numtf;
+
+                                        // then call the ROI-reduced inverse solution, which includes the ROIing
+    MultiplyMatrixRois ( reg, EegBuffAvg, *rois, inv );
+
+    return;
+    }
+
+
 if ( numtf == 1 ) {
                                         // always force average reference
     eegview->GetTracks ( tf1, tf1, EegBuff, ReferenceAverage );
@@ -81,6 +81,11 @@ public:
     void            MultiplyMatrix ( int reg, const TArray2<float>&         eeg,    int tf, TArray1<TVector3Float>&    inv )    const; 
     void            MultiplyMatrix ( int reg, const AMatrix&                eeg,    int tf, TArray1<TVector3Float>&    inv )    const; 
 
+                                        // ROIs mean can be applied beforehand to the matrix rows when results are linear, so that only NumRois lines are multiplied
+    bool            CanReduceToRois     ( const TRois* rois, bool vectorialresults )                                                const;
+    void            MultiplyMatrixRois  ( int reg, const TMap& map, const TRois& rois,  TArray1<float>&            inv )    const;
+    void            MultiplyMatrixRois  ( int reg, const TMap& map, const TRois& rois,  TArray1<TVector3Float>&    inv )    const;
+
 
 protected:
                                         // Set of (at least 1) matrices, with increasing regularization if more than 1
@@ -97,8 +102,15 @@ protected:
     TArray1<double> RegularizationsValues;
     TStrings        RegularizationsNames;
 
+                                        // ROI-reduced matrices, one per regularization, built on demand for the last ROIs used
+    mutable std::vector<TArray2<AReal>> MRois;
+    mutable UINT            MRoisContentId;     // identifies the ROIs content, as a new TRois could be allocated at the same address
+    mutable int             MRoisNumRois;
+
 
     void            SetDefaultVariables ();
+    void            ResetRoisMatrices   ()                                          const;
+    void            UpdateRoisMatrix    ( int reg, const TRois& rois )              const;
 
 };
 
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include    "ESI.ComputingRis.h"
 
+#include    "System.h"                  // GetAvailableMemory
 #include    "Dialogs.TSuperGauge.h"
 #include    "Strings.Utils.h"
 #include    "Strings.Grep.h"
@@ -37,6 +38,7 @@ limitations under the License.
 #pragma     hdrstop
 //-=-=-=-=-=-=-=-=-
 
+using namespace std;
 using namespace owl;
 
 namespace crtl {
@@ -82,6 +84,7 @@ bool    ComputingRis    (   ComputingRisPresetsEnum esicase,
 
                             bool                savingindividualfiles,  bool                savingepochfiles,   bool            savingzscorefactors,
                             bool                computegroupsaverages,  bool                computegroupscentroids,
+                            int                 maxsubjects,            double              maxmemorymb,
                             const char*         outputdir,              // optional
                             const char*         prefix,
                             ExecFlags           execflags
@@ -318,6 +321,50 @@ if ( ! isprocessing )
     return false;
 
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Keeping each subject's results in memory, instead of writing then reading back intermediate files
+                                        // Epochs and frequencies still need to go through files, for their splitting & merging
+bool                inmemory                = ! CRISPresets[ esicase ].IsEpochs ()
+                                           && esicase != ComputingRisPresetFreq
+                                           && ( computegroupsaverages || computegroupscentroids );
+
+                                        // memory ceiling, either given or from the currently available physical memory
+size_t              memoryceiling           = maxmemorymb > 0   ? (size_t) ( maxmemorymb * MegaByte )
+                                                                : (size_t) ( GetAvailableMemory () * RisMemoryRatio );
+int                 maxsubjectnumtf         = 0;
+int                 maxfilenumtf            = 0;
+
+for ( int si = 0; si < numgroups; si++ ) {
+
+    Maxed ( maxsubjectnumtf, subjects[ si ].GetSumNumTF () );
+    Maxed ( maxfilenumtf,    subjects[ si ].GetMaxNumTF () );
+    }
+
+
+int                 numsp                   = isdoc->GetNumSolPoints ();
+int                 resultsdim              = rois ? rois->GetNumRois () : numsp * ( IsVector ( datatypeproc ) ? 3 : 1 );
+
+                                        // biggest subject results, all conditions together
+size_t              subjectmemory           = (size_t) maxsubjectnumtf * resultsdim * sizeof ( TMapAtomType );
+                                        // preprocessing peak, one file at a time: EEG, vectorial inverse and its norm, optional ROIs
+size_t              preprocmemory           = (size_t) maxfilenumtf 
+                                            * ( isdoc->GetNumElectrodes () + numsp * 3 + numsp + ( rois ? rois->GetNumRois () : 0 ) )
+                                            * sizeof ( TMapAtomType );
+                                        // centroid working memory, per concurrent subject: a copy of its biggest condition, plus about as much for the centroid computation
+size_t              centroidmemory          = computegroupscentroids ? 2 * (size_t) maxfilenumtf * resultsdim * sizeof ( TMapAtomType ) : 0;
+                                        // groups averages are also cumulated in memory, counting them as an extra subject
+size_t              fixedmemory             = preprocmemory + ( computegroupsaverages ? subjectmemory : 0 );
+
+int                 numsubjectsmemory       = subjectmemory == 0 || memoryceiling <= fixedmemory ? 0 
+                                            : (int) ( ( memoryceiling - fixedmemory ) / ( subjectmemory + centroidmemory ) );
+
+inmemory    = inmemory && numsubjectsmemory >= 1;
+
+                                        // number of subjects which centroids are computed concurrently - preprocessing itself remains sequential, but is already parallelized internally
+int                 numconcurrentsubjects   = inmemory  ? Clip ( NoMore ( numsubjectsmemory, maxsubjects > 0 ? maxsubjects : GetNumMaxThreads () ), 1, numgroups ) 
+                                                        : 1;
+
+
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 TFileName           BaseDir;
@@ -493,6 +540,17 @@ verbose.Put ( "Computing each groups' averages:",       computegroupsaverages
 verbose.Put ( "Computing each groups' centroids:",      computegroupscentroids  );
 verbose.Put ( "Saving standardization factors files:",  savingzscorefactors     );
 
+verbose.NextLine ();
+verbose.Put ( "Keeping intermediate results in memory:",inmemory                );
+if ( inmemory ) {
+    verbose.Put ( "Memory ceiling:",                    (double) memoryceiling / MegaByte, 0, " [MB]" );
+    verbose.Put ( "Estimated memory per subject:",      (double) ( subjectmemory + centroidmemory ) / MegaByte, 0, " [MB]" );
+    verbose.Put ( "Estimated preprocessing memory:",    (double) preprocmemory / MegaByte, 0, " [MB]" );
+    if ( computegroupscentroids )
+        verbose.Put ( "Subjects per centroids batch:",  numconcurrentsubjects   );   // preprocessing is always one subject at a time
+    }
+    }
+
 verbose.NextLine ();
 verbose.Put ( "Verbose file (this):", VerboseFile );
 }
@@ -730,6 +788,43 @@ centroidsgof            .Reset ();
 TArray1<RegularizationType>     usedregularizations;
 RegularizationType              usedregularization;
 
+                                        // In-memory results
+TGoMaps             groupsums;                                  // running sums, 1 per condition
+int                 numgroupsums        = 0;
+bool                groupsumsok         = true;                 // all subjects have the same conditions, with the same dimensions
+vector<TGoMaps>     batchmaps       ( inmemory ? numconcurrentsubjects : 0 );  // current subject, and the ones waiting for their centroids
+vector<int>         batchsubjects   ( inmemory ? numconcurrentsubjects : 0 );
+int                 numbatch            = 0;
+
+                                        // Centroids of all pending subjects are computed concurrently, each one into its own slot, then the memory is released
+auto                ComputeBatchCentroids   = [ & ] ()
+{
+if ( computegroupscentroids ) {
+
+    OmpParallelFor
+
+    for ( int bi = 0; bi < numbatch; bi++ )
+
+        ComputeCentroidMaps (   batchmaps[ bi ],        OneFileOneCentroid,
+                                centroidsmethod,
+                                centroidsdatatype,
+                                centroidspolarity, 
+                                centroidsref, 
+                                centroidsranking, 
+                                centroidsthresholding,  centroidsthreshold,
+                                centroidsnormalized,
+                                centroids[ batchsubjects[ bi ] ]
+                            );
+    }
+
+
+for ( int bi = 0; bi < numbatch; bi++ )
+
+    batchmaps[ bi ].DeallocateMemory ();
+
+numbatch    = 0;
+};
+
 
 for ( int absg = 0; absg < gogofpersubject.NumGroups (); absg++ ) {
 
@@ -832,10 +927,12 @@ for ( int absg = 0; absg < gogofpersubject.NumGroups (); absg++ ) {
                         Prefix,                                             // optional file prefix
                         -1,                        -1,                      // no filename clipping
                         false,                      0,                      // no temp dir
-                        computingindividualfiles,   risgogof,           0,          gofoutdirpreproc,   newfiles,
+                                        // in memory: writing only the files explicitly asked for
+                        inmemory ? savingindividualfiles : computingindividualfiles,    risgogof,   0,  gofoutdirpreproc,   newfiles,
                         actualsavingzscorefactors,  &zscoregofout,
                         execflags,
-                        &Gauge 
+                        &Gauge,
+                        inmemory ? &batchmaps[ numbatch ] : 0
                     );
 
 
@@ -901,7 +998,7 @@ for ( int absg = 0; absg < gogofpersubject.NumGroups (); absg++ ) {
 
                     else                                    BatchAveragingScalar    (   splitgogof[ condi ],
                                                                                         meanfile,       0,              0,
-                                                                                        0,              0,
+                                                                                        0,              0,              0,
                                                                                         execflags
                                                                                     );
                     }
@@ -1036,6 +1133,78 @@ for ( int absg = 0; absg < gogofpersubject.NumGroups (); absg++ ) {
 
         } // IsEpochs
 
+    else if ( inmemory ) {
+                                        // current subject, all conditions
+        const TGoMaps&      subjectmaps     = batchmaps[ numbatch ];
+
+                                        // cumulate each condition for the groups averages
+        if ( computegroupsaverages && groupsumsok ) {
+                                        // summing maps of different sizes would silently truncate them, while still dividing by the number of subjects
+            if ( numgroupsums > 0 ) {
+
+                groupsumsok     = subjectmaps.NumGroups () == groupsums.NumGroups ();
+
+                for ( int ci = 0; groupsumsok && ci < subjectmaps.NumGroups (); ci++ )
+
+                    groupsumsok = subjectmaps[ ci ].GetNumMaps   () == groupsums[ ci ].GetNumMaps   ()
+                               && subjectmaps[ ci ].GetDimension () == groupsums[ ci ].GetDimension ();
+
+
+                if ( ! groupsumsok ) {
+
+                    groupsums.DeallocateMemory ();
+
+                    if ( IsInteractive ( execflags ) )
+                        ShowMessage (   "Subjects don't have the same number of conditions or time frames!" NewLine 
+                                        "Groups averages will not be computed...", 
+                                        ComputingRisTitle, ShowMessageWarning );
+                    }
+                }
+
+
+            if ( groupsumsok ) {
+
+                for ( int ci = 0; ci < subjectmaps.NumGroups (); ci++ )
+                                        // first subject sets the number of conditions and their sizes
+                    if ( numgroupsums == 0 )    groupsums.Add ( &subjectmaps[ ci ], true );
+                    else                        groupsums[ ci ]    += subjectmaps[ ci ];
+
+                numgroupsums++;
+                }
+            }
+
+                                        // centroids are postponed until we have enough subjects, or this is the last one
+        if ( computegroupscentroids ) {
+
+            batchsubjects[ numbatch++ ] = absg;
+
+            if ( numbatch == numconcurrentsubjects 
+              || absg     == gogofpersubject.NumGroups () - 1 )
+
+                ComputeBatchCentroids ();
+            }
+        else
+                                        // no more needed
+            batchmaps[ numbatch ].DeallocateMemory ();
+
+                                        // saving actual regularizations
+        if ( (bool) risgogof ) {
+
+            for ( int fi = 0; fi < risgogof[ 0 ].NumFiles (); fi++ ) {
+
+                usedregularizations.ResizeDelta ( 1 );
+
+                usedregularizations[ (int) usedregularizations - 1 ]    = usedregularization;
+                }
+            }
+
+                                        // files exist only if explicitly asked for
+        if ( savingindividualfiles )
+
+            gogofallsubjectspreproc.Add ( risgogof, MaxPathShort );
+
+        } // inmemory
+
     else { // ! IsEpochs
                                         // regular case of centroids
         if ( computegroupscentroids ) {
@@ -1183,7 +1352,42 @@ gofmean.Reset ();
 //  gofsd  .Reset ();
 
 
-if ( computegroupsaverages ) {
+if ( computegroupsaverages && inmemory ) {
+                                        // sums were cumulated while processing the subjects, no need to read back any files
+    for ( int absg = 0; absg < groupsums.NumGroups (); absg++ ) {
+
+        Gauge.Next ( gaugeriscompavg );
+
+        TFileName           newmeanfile;
+
+
+        groupsums[ absg ]  /= NonNull ( numgroupsums );
+
+                                        // Need to reapply these processing after averaging
+        if ( dataranking || datathresholding )
+
+            ProcessResults  (   groupsums[ absg ],  datatypefinal,     ReferenceNone,
+                                dataranking, 
+                                datathresholding,   datathreshold, 
+                                false /*normalize*/
+                            );
+
+
+        StringCopy          ( newmeanfile,  BaseFileName, InfixGroup " ", IntegerToString ( gofi1 + absg + 1 ), "." InfixMean );
+        AddExtension        ( newmeanfile,  FILEEXT_RIS );
+
+        if ( IsNoOverwrite ( execflags ) )
+            CheckNoOverwrite    ( newmeanfile );
+
+        groupsums[ absg ].WriteFile ( newmeanfile, IsVector ( datatypefinal ), groupsums[ absg ].GetSamplingFrequency (), rois ? rois->GetRoiNames () : 0 );
+
+        gofmean.Add         ( newmeanfile  );
+        }
+
+    groupsums.DeallocateMemory ();
+    } // if computegroupsaverages && inmemory
+
+else if ( computegroupsaverages ) {
 
     for ( int absg = 0; absg < gogofpercondition.NumGroups (); absg++ ) {
 
@@ -1208,7 +1412,7 @@ if ( computegroupsaverages ) {
                                         // RIS Vectorial will be straightforwardly averaged as Norm
             else                                    BatchAveragingScalar    (   gogofpercondition[ absg ],
                                                                                 meanfile,       0,              0,
-                                                                                0,              0,
+                                                                                0,              0,              0,
                                                                                 execflags
                                                                             );
             }
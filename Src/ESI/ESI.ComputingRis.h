@@ -64,6 +64,9 @@ constexpr FilterTypes   RisRoiMethod        = FilterTypeMean;
 
 constexpr FilterTypes   RisEnvelopeMethod   = FilterTypeEnvelopePeak;           // results close to analytic, but can work with positive-only data
 
+                                        // Share of the available physical memory that can be used to keep subjects' results in memory, when no explicit ceiling is given
+constexpr double        RisMemoryRatio      = 0.50;
+
 
 bool    ComputingRis    (   ComputingRisPresetsEnum esicase,
                             const TGoGoF&       subjects,                  
@@ -81,6 +84,7 @@ bool    ComputingRis    (   ComputingRisPresetsEnum esicase,
 
                             bool                savingindividualfiles,  bool                savingepochfiles,   bool            savingzscorefactors,
                             bool                computegroupsaverages,  bool                computegroupscentroids,
+                            int                 maxsubjects,            double              maxmemorymb,        // subjects per centroids batch and memory ceiling in [MB], 0 for defaults
                             const char*         outputdir,              // optional
                             const char*         prefix,
                             ExecFlags         verbose
@@ -39,6 +39,276 @@ namespace crtl {
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 
+void    TRisToVolumeOperator::Reset ()
+{
+RowVoxel.clear ();
+RowStart.clear ();
+Column  .clear ();
+Weight  .clear ();
+}
+
+
+//----------------------------------------------------------------------------
+bool    TRisToVolumeOperator::Set   (   TSolutionPointsDoc*             spdoc,      
+                                        RisToVolumeInterpolationType    interpol,
+                                        const TVolumeDoc*               mrigrey
+                                    )
+{
+Reset ();
+
+if ( spdoc == 0 || mrigrey == 0 )
+    return  false;
+
+
+const Volume&       grey            = *mrigrey->GetData ();
+int                 mrithreshold    = mrigrey->GetCsfCut ();
+int                 lineardim       = grey.GetLinearDim ();
+
+                                        // Some volume interpolation needs the SP interpolation
+SPInterpolationType         spinterpol  = interpol == VolumeInterpolation1NN        ?   SPInterpolation1NN
+                                        : interpol == VolumeInterpolation4NN        ?   SPInterpolation4NN
+                                        :                                               SPInterpolationNone;    // all other cases
+
+                                        // Initialize the requested SP interpolation
+if ( ! spdoc->BuildInterpolation ( spinterpol, mrigrey ) )
+    return  false;
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Voxel scan is simpler and for 1NN and 4NN interpolation cases
+                                        // Rows are directly produced in voxels order
+if ( IsVoxelScan ( interpol ) ) {
+
+    const TArray3<ushort>*              toip1nn         = spinterpol == SPInterpolation1NN ? spdoc->GetInterpol1NN () : 0;
+    const TArray3<TWeightedPoints4>*    toip4nn         = spinterpol == SPInterpolation4NN ? spdoc->GetInterpol4NN () : 0;
+    TPointFloat                         pvol;
+
+
+    for ( int li = 0; li < lineardim; li++ ) {
+                                    // clip to grey, even if there are some interpolation available (used for inverse display mostly)
+        if ( grey[ li ] <= mrithreshold )
+            continue;
+
+
+        grey.LinearIndexToXYZ   ( li, pvol );
+
+        mrigrey ->ToAbs            ( pvol );
+
+        spdoc   ->AbsoluteToVolume ( pvol );
+
+        pvol.Round ();
+
+
+        if      ( interpol == VolumeInterpolation1NN ) {
+
+            if ( ! toip1nn->WithinBoundary ( pvol ) )                               continue;
+
+            if (   toip1nn->GetValue       ( pvol ) == UndefinedInterpolation1NN )  continue;
+
+            RowVoxel.push_back ( li );
+            RowStart.push_back ( (int) Column.size () );
+
+            Column  .push_back ( toip1nn->GetValue ( pvol ) );
+            Weight  .push_back ( 1 );
+            } // VolumeInterpolation1NN
+
+        else if ( interpol == VolumeInterpolation4NN ) {
+
+            if ( ! toip4nn->WithinBoundary ( pvol ) )       continue;
+
+            const TWeightedPoints4* toi4    = &toip4nn->GetValue ( pvol );
+
+            if ( toi4->IsNotAllocated () )                  continue;
+
+            RowVoxel.push_back ( li );
+            RowStart.push_back ( (int) Column.size () );
+
+            Column  .push_back ( toi4->i1 );    Weight.push_back ( (float) ( (double) toi4->w1 / TWeightedPoints4SumWeights ) );
+            Column  .push_back ( toi4->i2 );    Weight.push_back ( (float) ( (double) toi4->w2 / TWeightedPoints4SumWeights ) );
+            Column  .push_back ( toi4->i3 );    Weight.push_back ( (float) ( (double) toi4->w3 / TWeightedPoints4SumWeights ) );
+            Column  .push_back ( toi4->i4 );    Weight.push_back ( (float) ( (double) toi4->w4 / TWeightedPoints4SumWeights ) );
+            } // VolumeInterpolation4NN
+
+        } // for voxel
+
+    RowStart.push_back ( (int) Column.size () );
+
+    return  true;
+    } // IsVoxelScan
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Solution points scan is longer and for linear and kernel interpolation cases
+if ( ! IsSolutionPointsScan ( interpol ) )
+    return  false;
+
+
+TPoints             points          = spdoc->GetPoints ( DisplaySpace3D );
+int                 numsp           = points.GetNumPoints ();
+double              radiusf         = spdoc->GetMedianDistance ();  // radius between SPs
+double              kernelradiusf   = 0;                            // real Kernel radius
+
+if      ( interpol == VolumeInterpolationLinearRect                     )   kernelradiusf   =                      radiusf;     // square    kernel
+//else if ( interpol == VolumeInterpolationLinearSpherical              )   kernelradiusf   =         sqrt ( 3 ) * radiusf;     // spherical kernel - boosting the Kernel size so as to reach the diagonal vertices
+//else if ( interpol == VolumeInterpolationQuadraticFastSplineSpherical )   kernelradiusf   = /*1.5*/ sqrt ( 3 ) * radiusf;     // spherical kernel - boosting just a little bit to reach the diagonal vertices
+else if ( interpol == VolumeInterpolationCubicFastSplineSpherical       )   kernelradiusf   = 2.0                * radiusf;     // spherical kernel - no need to boost, kernel is big enough already
+
+                                        // corresponding voxel (int) size of Kernel & radius
+int                 kerneldiameteri = DiameterToKernelSize ( 2 * kernelradiusf, OddSize );
+int                 kernelradiusi   = kerneldiameteri / 2;
+
+                                        // 1) each solution point footprint, computed in parallel - this is the only costly geometrical part
+std::vector<std::vector<int>>   spvoxels  ( numsp );
+std::vector<std::vector<float>> spweights ( numsp );
+
+
+OmpParallelFor
+
+for ( int spi = 0; spi < numsp; spi++ ) {
+
+    TPointFloat         sp          = points    [ spi ];
+
+    mrigrey->ToRel ( sp );
+
+    sp     += 0.5;
+
+                                        // voxel is kernel shifted + truncated to voxel
+    int                 xki, yki, zki;
+    TPointInt           vox;
+
+    for ( xki = 0, vox.X = sp.X - kernelradiusi; xki < kerneldiameteri; xki++, vox.X++ )
+    for ( yki = 0, vox.Y = sp.Y - kernelradiusi; yki < kerneldiameteri; yki++, vox.Y++ )
+    for ( zki = 0, vox.Z = sp.Z - kernelradiusi; zki < kerneldiameteri; zki++, vox.Z++ ) {
+
+
+        if ( grey.GetValueChecked ( vox ) <= mrithreshold ) continue;   // for exact grey mask
+
+                                        // floating point, exact position used for the weight
+        TPointFloat         sp0         = vox - sp + 0.5;
+
+        double              w           = 0;
+
+        if      ( interpol == VolumeInterpolationLinearRect )
+                                        // squared kernel, linear weight
+            w       = CubicRoot (   ( 1 - Clip ( abs ( sp0.X ) / kernelradiusf, 0.0, 1.0 ) )
+                                  * ( 1 - Clip ( abs ( sp0.Y ) / kernelradiusf, 0.0, 1.0 ) )
+                                  * ( 1 - Clip ( abs ( sp0.Z ) / kernelradiusf, 0.0, 1.0 ) ) );
+
+//      else if ( interpol == VolumeInterpolationLinearSpherical )
+//                                  // radial kernel, linear weight, with exact position
+//          w       = 1 - NoMore ( 1.0, sp0.Norm () / kernelradiusf );
+//
+//      else if ( interpol == VolumeInterpolationQuadraticFastSplineSpherical ) {
+//                                                                   // kernel spans on 3 intervals / 4 points -> center & span = 1.5
+//          double  dk  = NoMore ( 1.0, sp0.Norm () / kernelradiusf ) * 1.5 + 1.5;
+//                                  // piecewise definition
+//          if ( dk < 2.0 )     w   = -2 * Square ( dk ) + 6 * dk -3;
+//          else                w   = Square ( 3 - dk );
+//          }
+
+        else if ( interpol == VolumeInterpolationCubicFastSplineSpherical ) {
+                                                                        // kernel spans on 4 intervals / 5 points -> center & span = 2
+            double      dk      = NoMore ( 1.0, sp0.Norm () / kernelradiusf ) * 2.0 + 2.0;
+                            // piecewise definition
+            if ( dk < 2.0 )  {  dk -= 2;    w   = 3 * Cube ( dk ) - 6 * Square ( dk ) + 6 * dk + 4; }
+            else                            w   = Cube ( 4 - dk );
+            }
+
+
+        spvoxels [ spi ].push_back ( grey.IndexesToLinearIndex ( vox ) );
+        spweights[ spi ].push_back ( (float) w );
+        } // for kernel xki, yki, zki
+
+    } // for solution point
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // 2) transposing to voxel rows: count the contributions to each voxel
+std::vector<int>    voxelcursor ( lineardim, 0 );
+
+for ( int spi = 0; spi < numsp; spi++ )
+for ( int vi  = 0; vi  < (int) spvoxels[ spi ].size (); vi++ )
+
+    voxelcursor[ spvoxels[ spi ][ vi ] ]++;
+
+                                        // rows in voxels order; counts are then turned into writing positions
+int                 numweights      = 0;
+
+for ( int li = 0; li < lineardim; li++ ) {
+
+    if ( voxelcursor[ li ] == 0 )
+        continue;
+
+    RowVoxel.push_back ( li );
+    RowStart.push_back ( numweights );
+
+    numweights         += voxelcursor[ li ];
+    voxelcursor[ li ]   = RowStart.back ();
+    }
+
+RowStart.push_back ( numweights );
+
+                                        // 3) filling in solution points order, so that each row is sorted, and the summation order is always the same
+Column.resize ( numweights );
+Weight.resize ( numweights );
+
+for ( int spi = 0; spi < numsp; spi++ ) {
+
+    for ( int vi  = 0; vi  < (int) spvoxels[ spi ].size (); vi++ ) {
+
+        int         wi      = voxelcursor[ spvoxels[ spi ][ vi ] ]++;
+
+        Column[ wi ]    = spi;
+        Weight[ wi ]    = spweights[ spi ][ vi ];
+        }
+                                        // release memory as we go
+    std::vector<int>  ().swap ( spvoxels [ spi ] );
+    std::vector<float>().swap ( spweights[ spi ] );
+    }
+
+                                        // 4) normalization by the cumulated weights of each voxel
+OmpParallelFor
+
+for ( int r = 0; r < GetNumVoxels (); r++ ) {
+
+    double              sumw            = 0;
+
+    for ( int wi = RowStart[ r ]; wi < RowStart[ r + 1 ]; wi++ )
+        sumw   += Weight[ wi ];
+
+    sumw    = NonNull ( sumw );
+
+    for ( int wi = RowStart[ r ]; wi < RowStart[ r + 1 ]; wi++ )
+        Weight[ wi ]    = (float) ( Weight[ wi ] / sumw );
+    }
+
+
+return  true;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Sparse matrix-vector product: each voxel gathers its own solution points, so it is parallel without any atomic
+void    TRisToVolumeOperator::Apply ( const TMap& map, TVolume<double>& vol )   const
+{
+vol.ResetMemory ();
+
+
+OmpParallelFor
+
+for ( int r = 0; r < GetNumVoxels (); r++ ) {
+
+    double              v               = 0;
+
+    for ( int wi = RowStart[ r ]; wi < RowStart[ r + 1 ]; wi++ )
+        v      += Weight[ wi ] * map[ Column[ wi ] ];
+
+    vol[ RowVoxel[ r ] ]    = v;
+    }
+}
+
+
+//----------------------------------------------------------------------------
 void    RisToVolume (
                     const char*             risfile,
                     TSolutionPointsDoc*     spdoc,          RisToVolumeInterpolationType    interpol,
@@ -111,62 +381,14 @@ if ( IsInteractive ( execflags ) ) {
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Initialization for interpolation
-
+                                        // Initialization for interpolation: all the geometry is done once here, whatever the number of volumes written
 const Volume&       grey            = *mrigrey->GetData ();
 TVolume<double>     vol ( grey.GetDim1 (), grey.GetDim2 (), grey.GetDim3 () );
-int                 mrithreshold    = mrigrey->GetCsfCut ();
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Variables for Voxels scan - Nearest Neighbors cases
-
-const TArray3<ushort>*            toip1nn         = 0;
-const TArray3<TWeightedPoints4>*  toip4nn         = 0;
+TRisToVolumeOperator    ristovolume;
 
-                                        // Some volume interpolation needs the SP interpolation
-SPInterpolationType         spinterpol  = interpol == VolumeInterpolation1NN        ?   SPInterpolation1NN
-                                        : interpol == VolumeInterpolation4NN        ?   SPInterpolation4NN
-                                        :                                               SPInterpolationNone;    // all other cases
 
-                                        // Initialize the requested SP interpolation
-if ( ! spdoc->BuildInterpolation ( spinterpol, mrigrey ) )
+if ( ! ristovolume.Set ( spdoc, interpol, mrigrey ) )
     return;
-    
-
-if      ( spinterpol == SPInterpolation1NN  )   toip1nn = spdoc->GetInterpol1NN ();
-else if ( spinterpol == SPInterpolation4NN  )   toip4nn = spdoc->GetInterpol4NN ();
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Variables for Solution Points scan
-
-TPoints             points;
-TVolume<double>     weights;
-double              radiusf         = 0;    // radius between SPs
-double              kernelradiusf   = 0;    // real Kernel radius
-int                 kerneldiameteri = 0;    // corresponding voxel (int) size of Kernel & radius
-int                 kernelradiusi   = 0;
-
-
-if ( IsSolutionPointsScan ( interpol ) ) {
-
-    weights.Resize ( grey.GetDim1 (), grey.GetDim2 (), grey.GetDim3 () );
-
-    points  = spdoc->GetPoints ( DisplaySpace3D );
-
-
-    radiusf     = spdoc->GetMedianDistance ();
-
-    if      ( interpol == VolumeInterpolationLinearRect                     )   kernelradiusf   =                      radiusf;     // square    kernel
-//  else if ( interpol == VolumeInterpolationLinearSpherical                )   kernelradiusf   =         sqrt ( 3 ) * radiusf;     // spherical kernel - boosting the Kernel size so as to reach the diagonal vertices
-//  else if ( interpol == VolumeInterpolationQuadraticFastSplineSpherical   )   kernelradiusf   = /*1.5*/ sqrt ( 3 ) * radiusf;     // spherical kernel - boosting just a little bit to reach the diagonal vertices
-    else if ( interpol == VolumeInterpolationCubicFastSplineSpherical       )   kernelradiusf   = 2.0                * radiusf;     // spherical kernel - no need to boost, kernel is big enough already
-
-
-    kerneldiameteri = DiameterToKernelSize ( 2 * kernelradiusf, OddSize );
-    kernelradiusi   = kerneldiameteri / 2;
-    }
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -390,143 +612,8 @@ for ( int blocki = 0; blocki < numsavedblocks; blocki++ ) {
 
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // compute output volume according to the type of interpolation
-    vol.ResetMemory ();
-
-                                        // Solution points scan is longer and for linear and kernel interpolation cases
-    if      ( IsSolutionPointsScan ( interpol ) ) {
-
-        OmpParallelFor
-
-        for ( int spi = 0; spi < points.GetNumPoints (); spi++ ) {
-
-            TPointFloat         sp          = points    [ spi ];
-            double              spv         = meanrismap[ spi ];
-
-            mrigrey->ToRel ( sp );
-
-            sp     += 0.5;
-
-                                        // voxel is kernel shifted + truncated to voxel
-            int                 xki, yki, zki;
-            TPointInt           vox;
-
-            for ( xki = 0, vox.X = sp.X - kernelradiusi; xki < kerneldiameteri; xki++, vox.X++ )
-            for ( yki = 0, vox.Y = sp.Y - kernelradiusi; yki < kerneldiameteri; yki++, vox.Y++ )
-            for ( zki = 0, vox.Z = sp.Z - kernelradiusi; zki < kerneldiameteri; zki++, vox.Z++ ) {
-
-                   
-                if ( grey.GetValueChecked ( vox ) <= mrithreshold ) continue;   // for exact grey mask
-//              if ( ! grey.WithinBoundary ( vox ) )                continue;   // for debugging
-
-                                        // floating point, exact position used for the weight
-                TPointFloat         sp0         = vox - sp + 0.5;
-
-                double              w           = 0;
-
-                if      ( interpol == VolumeInterpolationLinearRect )
-                                        // squared kernel, linear weight
-                    w       = CubicRoot (   ( 1 - Clip ( abs ( sp0.X ) / kernelradiusf, 0.0, 1.0 ) )
-                                          * ( 1 - Clip ( abs ( sp0.Y ) / kernelradiusf, 0.0, 1.0 ) )
-                                          * ( 1 - Clip ( abs ( sp0.Z ) / kernelradiusf, 0.0, 1.0 ) ) );
-
-//              else if ( interpol == VolumeInterpolationLinearSpherical )
-//                                  // radial kernel, linear weight, with exact position
-//                  w       = 1 - NoMore ( 1.0, sp0.Norm () / kernelradiusf );
-//
-//              else if ( interpol == VolumeInterpolationQuadraticFastSplineSpherical ) {
-//                                                                           // kernel spans on 3 intervals / 4 points -> center & span = 1.5
-//                  double  dk  = NoMore ( 1.0, sp0.Norm () / kernelradiusf ) * 1.5 + 1.5;
-//                                  // piecewise definition
-//                  if ( dk < 2.0 )     w   = -2 * Square ( dk ) + 6 * dk -3;
-//                  else                w   = Square ( 3 - dk );
-//                  }
-
-                else if ( interpol == VolumeInterpolationCubicFastSplineSpherical ) {
-                                                                                // kernel spans on 4 intervals / 5 points -> center & span = 2
-                    double      dk      = NoMore ( 1.0, sp0.Norm () / kernelradiusf ) * 2.0 + 2.0;
-                                    // piecewise definition
-                    if ( dk < 2.0 )  {  dk -= 2;    w   = 3 * Cube ( dk ) - 6 * Square ( dk ) + 6 * dk + 4; }
-                    else                            w   = Cube ( 4 - dk );
-                    }
-
-
-                //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // atomic because different solution points could write simultaneously on vol
-                OmpAtomic
-                vol     ( vox )     += w * spv; // spread current solution point value to neighbors
-
-                if ( firstblock ) {             // storing weights is needed only once
-                    OmpAtomic
-                    weights ( vox ) += w;       // keep count of all weights used at each voxel
-                    }
-
-                } // for kernel xki, yki, zki
-
-            } // for solution point
-
-
-        vol    /= weights;              // rescale by each cumulated weights at each voxel
-
-        } // IsSolutionPointsScan
-
-
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Voxel scan is simpler and for 1NN and 4NN interpolation cases
-    else if ( IsVoxelScan ( interpol ) ) {
-
-                                        // do current volume
-        OmpParallelFor
-
-        for ( int li = 0; li < vol.GetLinearDim (); li++ ) {
-                                    // clip to grey, even if there are some interpolation available (used for inverse display mostly)
-            if ( grey[ li ] <= mrithreshold )
-                continue;
-
-
-            TPointFloat     pvol;
-
-            vol.LinearIndexToXYZ   ( li, pvol );
-
-            mrigrey ->ToAbs            ( pvol );
-
-            spdoc   ->AbsoluteToVolume ( pvol );
-
-            pvol.Round ();
-
-
-            double          v       = 0;
-
-            if      ( interpol == VolumeInterpolation1NN ) {
-
-                if ( ! toip1nn->WithinBoundary ( pvol ) )                               continue;
-
-                if (   toip1nn->GetValue       ( pvol ) == UndefinedInterpolation1NN )  continue;
-
-                v   = meanrismap ( toip1nn->GetValue ( pvol ) );
-
-                } // VolumeInterpolation1NN
-
-            else if ( interpol == VolumeInterpolation4NN ) {
-
-                if ( ! toip4nn->WithinBoundary ( pvol ) )       continue;
-
-                const TWeightedPoints4* toi4    = &toip4nn->GetValue ( pvol );
-
-                if ( toi4->IsNotAllocated () )                  continue;
-
-                v   = (   toi4->w1 * meanrismap ( toi4->i1 )
-                        + toi4->w2 * meanrismap ( toi4->i2 )
-                        + toi4->w3 * meanrismap ( toi4->i3 )
-                        + toi4->w4 * meanrismap ( toi4->i4 ) ) / TWeightedPoints4SumWeights;
-
-                } // VolumeInterpolation4NN
-
-
-            vol[ li ]   = v;
-            } // for z, y, x
-
-        } // IsVoxelScan
+                                        // compute output volume with the precomputed interpolation
+    ristovolume.Apply ( meanrismap, vol );
 
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
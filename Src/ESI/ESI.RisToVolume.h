@@ -16,6 +16,10 @@ limitations under the License.
 
 #pragma once
 
+#include    <vector>
+
+#include    "CartoolTypes.h"            // TMap
+
 namespace crtl {
 
 //----------------------------------------------------------------------------
@@ -31,6 +35,38 @@ class       TVolumeDoc;
 class       TGoF;
 class       TSuperGauge;
 
+
+//----------------------------------------------------------------------------
+                                        // Solution points to voxels interpolation, computed once as a sparse matrix, for any interpolation type
+                                        // Stored by voxel rows (CSR), with weights already normalized, so that each volume
+                                        // is simply a sparse matrix-vector product: each voxel gathers from its solution points, no atomics needed
+class   TRisToVolumeOperator
+{
+public:
+                    TRisToVolumeOperator ()     {}
+
+
+    bool            IsEmpty         ()  const   { return RowVoxel.empty (); }
+    int             GetNumVoxels    ()  const   { return (int) RowVoxel.size (); }
+    size_t          GetNumWeights   ()  const   { return Weight.size (); }
+
+    void            Reset           ();
+    bool            Set             ( TSolutionPointsDoc* spdoc, RisToVolumeInterpolationType interpol, const TVolumeDoc* mrigrey );
+
+    void            Apply           ( const TMap& map, TVolume<double>& vol )   const;  // vol has to be allocated to the grey mask size
+
+
+protected:
+
+    std::vector<int>    RowVoxel;       // linear index of the voxel of each row
+    std::vector<int>    RowStart;       // first weight of each row, + 1 ending index
+    std::vector<int>    Column;         // solution point index
+    std::vector<float>  Weight;         // normalized weight
+
+};
+
+
+//----------------------------------------------------------------------------
                                         // "Renders" a RIS files, which are basically tracks, as volume(s)
 void    RisToVolume (
                     const char*             risfile,
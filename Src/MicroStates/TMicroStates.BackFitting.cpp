@@ -714,7 +714,6 @@ PreprocessMaps          (   templatemaps,
                                         // Markov Chains parameters
 TArray4<double>     JSP;                // Joint State Probability (or Joint Probability Mass Function)
 TTracks<double>     ProbSeg;            // Probability of each segment
-TArray1<int>        state    ( markovtransmax + 1 );
 TExportTracks*      expmarkovfreq   = 0;
 
 
@@ -1122,7 +1121,6 @@ TArray4<float>      alldurationssmooth;
 double              alldurationsraw_IndexRatio;
 double              alldurationssmooth_IndexMin;
 double              alldurationssmooth_IndexRatio;
-TGoEasyStats        durstat ( writestatdurationsfiles ? reqmaxclusters : 0, writestatdurationsfiles ? 100 : 0 );
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1257,6 +1255,10 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
 
     SubjGEV.Resize ( maxfilespergroup, noncompetitive ? nclusters : 1 );
 
+                                        // Correlations of each labeled time point to the template(s), for all files of current subject
+                                        // competitive: 1 row for the time point's own label; non-competitive: 1 row per template
+    TArray2<double>     fitcorr;
+
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -1457,8 +1459,6 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                                         // use biggest interval
         long                fromtf      = allepochsfromtf;
         long                totf        = allepochstotf;
-        long                tfmin;
-        long                tfmax;
 
 
         //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1479,6 +1479,9 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
 
             for ( int relg = 0; relg < NumFiles; relg++ ) {
 
+                long                tfmin;
+                long                tfmax;
+
                 TimeRangeToDataRange ( relg, EpochsFrom ( epochi ), EpochsTo ( epochi ), tfmin, tfmax );
 
                                         // cumulate current subject epochs for all conditions, with ACTUAL limits
@@ -1533,6 +1536,30 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                 gevdenom   += Square ( Norm[ tf ] );
 
 
+        //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Projecting the data onto the templates is the costliest part of the variables extraction below,
+                                        // and each correlation was needed more than once. Computing them all first, concurrently across all files and time points,
+                                        // then the cumulations below remain sequential, in the same order, hence giving the exact same results
+                                        // Non-competitive correlation files also output the unlabeled time points, which are then computed too
+        fitcorr.Resize ( competitive ? 1 : nclusters, NumTimeFrames );
+
+        OmpParallelFor
+
+        for ( long tf = 0; tf < NumTimeFrames; tf++ ) {
+
+            if ( labels.IsUndefined ( tf ) && ! ( noncompetitive && writecorrelationfiles ) )
+                continue;
+
+            if ( competitive )
+                                        // although we know the polarity for Centroid, we still have to evaluate for Cloud
+                fitcorr ( 0, tf )   = Project ( templatemaps[ labels[ tf ] ], Data[ tf ], polarity /*labels.GetPolarity ( tf )*/ );
+            else
+                for ( TIteratorSelectedForward si ( mapsel ); (bool) si; ++si )
+                                        // pick the right polarity for each map
+                    fitcorr ( si(), tf )    = Project ( templatemaps[ si() ], Data[ tf ], polarity );
+            }
+
+
         //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // For array access reasons, we need to temporarily convert label values so to be all >= 0.
                                         // Label values:        defined label values in [0 .. nclusters) / UndefinedLabel         = -1
@@ -1553,8 +1580,16 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
         var                 = missingvalue;
 
                                         // now, extract all variables from global labeling
+                                        // Each file only reads the shared labeling / data, and writes to its own slots of var, ProbSeg, JSP and alldurations,
+                                        // so files can be processed concurrently while the results remain the same as the sequential ones
                                         // !TODO replace all f by relg!
-        for ( int relg = 0, f = relg, absg = gofi1 + relg; relg < NumFiles; relg++, f++, absg++ ) {
+        OmpParallelFor
+
+        for ( int relg = 0; relg < NumFiles; relg++ ) {
+
+            int                 f               = relg;
+            long                tfmin;
+            long                tfmax;
 
             Gauge.Next ( gaugefitextractvariables, SuperGaugeUpdateTitle );
 
@@ -1582,7 +1617,7 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                                         // segments index starts from 0, n is for the UndefinedLabel
                     seglist.AppendMarker ( TMarker ( begintf, tf, 
                                                      (MarkerCode) SegToIndex ( labels[ begintf ] ), 
-                                                     labels.IsUndefined ( begintf ) ? "Unlabeled" : IntegerToString ( buff, labels[ begintf ] + 1 ),
+                                                     labels.IsUndefined ( begintf ) ? "Unlabeled" : IntegerToString ( labels[ begintf ] + 1 ),
                                                      MarkerTypeTemp ) );
 
                                         // next segment will begin after current TF
@@ -1661,7 +1696,7 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                         if ( labels.IsUndefined ( tf ) )
                             continue;
 
-                        double      corr    = Project ( templatemaps[ si() ], Data[ tf ], polarity );  // pick the right polarity for each map
+                        double      corr    = fitcorr ( si(), tf );
 
                         if ( corr > var ( f, fitbcorr, si() ) ) {
                             var ( f, fitbcorr,      si() ) = corr;
@@ -1680,8 +1715,7 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                         continue;
 
                     LabelType   l       = labels[ tf ];
-                                        // although we know the polarity for Centroid, we still have to evaluate for Cloud
-                    double      corr    = Project ( templatemaps[ l ], Data[ tf ], polarity /*labels.GetPolarity ( tf )*/ );
+                    double      corr    = fitcorr ( 0, tf );
 
                     if ( corr > var ( f, fitbcorr, l ) ) {
                         var ( f, fitbcorr,      l ) = corr;
@@ -1711,7 +1745,7 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                         if ( labels.IsUndefined ( tf ) )
                             continue;
 
-                        double      corr    = Project ( templatemaps[ si() ], Data[ tf ], polarity );  // pick the right polarity for each map
+                        double      corr    = fitcorr ( si(), tf );
                         double      gevc    = Square ( Norm[ tf ] * corr );
 
                         var ( f, fitmeancorr, si() )  += corr;
@@ -1733,7 +1767,7 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
 
                     LabelType   l       = labels[ tf ];
 
-                    double      corr    = Project ( templatemaps[ l ], Data[ tf ], polarity /*labels.GetPolarity ( tf )*/ );
+                    double      corr    = fitcorr ( 0, tf );
                     double      gevc    = Square ( Norm[ tf ] * corr );
 
                     var ( f, fitmeancorr,   l )    += corr;
@@ -1839,6 +1873,8 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                                     };
 
                 TArray2<double>     segments ( reqmaxclusters, numsegmentsvar );
+                TArray1<int>        state    ( markovtransmax + 1 );
+                TGoEasyStats        durstat  ( writestatdurationsfiles ? reqmaxclusters : 0, writestatdurationsfiles ? 100 : 0 );
                 long                duration;
                 int                 mapi;
 
@@ -1846,10 +1882,6 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                 segments.ResetMemory ();
                                         // initialize with invalid labels - index 0 is for current state, 1 for previous one, etc...
                 state       = UndefinedLabelPositive;   // UndefinedLabel;
-                                        // reset only current template maps
-                if ( writestatdurationsfiles )
-                    for ( TIteratorSelectedForward si    ( mapsel );   (bool) si;    ++si    )
-                        durstat[ si() ].Reset ();
 
                                         // browse each segment - labeled and unlabeled altogether
                 for ( int segi = 0; segi < (int) seglist; segi++ ) {
@@ -1955,6 +1987,8 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
 
                                         // big array not allocated? we know the curve sizes here
                                         // this will also reset to 0 only once, so we can cumulate all epochs/maps here
+                        OmpCriticalBegin (alldurationsalloc)
+
                         if ( alldurationsraw.IsNotAllocated () ) {
                             alldurationsraw   .Resize ( numwithinsubjects, maxfilespergroup + 1, reqmaxclusters, (int) curve_raw    );
                             alldurationssmooth.Resize ( numwithinsubjects, maxfilespergroup + 1, reqmaxclusters, (int) curve_smooth );
@@ -1965,6 +1999,8 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                             alldurationssmooth_IndexRatio   = curve_smooth.Index1.IndexRatio;
                             }
 
+                        OmpCriticalEnd
+
                                         // save current subject & cumulate
                         for ( int i = 0; i < (int) curve_raw; i++ ) {
                             alldurationsraw ( relg, subji,            si(), i )    = curve_raw ( i );
@@ -2092,7 +2128,7 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                 bigsegdata[ subji ] ( relg, SegVarPolarity, tf )    = TrueToMinus ( polarity == PolarityEvaluate && templatemaps[ l ].IsOppositeDirection ( Data[ tf2 ] ) );
                 bigsegdata[ subji ] ( relg, SegVarSegment,  tf )    = l + 1;
                 bigsegdata[ subji ] ( relg, SegVarGev,      tf )    = var ( relg, fitgev, l );
-                bigsegdata[ subji ] ( relg, SegVarCorr,     tf )    = Project ( templatemaps[ l ], Data[ tf2 ], polarity /*labels.GetPolarity ( tf2 )*/ );;
+                bigsegdata[ subji ] ( relg, SegVarCorr,     tf )    = fitcorr ( competitive ? 0 : l, tf2 );
                 } // for relg, tf
 
             } // if writesegfiles || writesegfrequencyfiles
@@ -2121,12 +2157,14 @@ for ( int gofi1 = 0, gofi2 = gofi1 + numwithinsubjects - 1; gofi1 < numgroups &&
                 long                numtimesubj         = SubjTimeFrames ( relg, subji, FileDuration );
                 TMaps               corrtime ( nclusters, numtimesubj );
 
+                                        // each template has its own row
+                OmpParallelFor
 
                 for ( int m = 0; m < nclusters; m++ )
                 for ( long tf = 0, tf2 = OffsetTF[ relg ]; tf < numtimesubj; tf++, tf2++ )
 
                                         // !Don't use labels.GetPolarity as it is only valid for the labeled map only!
-                    corrtime ( m, tf )  = mapsel.IsSelected ( m ) ? Project ( templatemaps[ m ], Data[ tf2 ], polarity )
+                    corrtime ( m, tf )  = mapsel.IsSelected ( m ) ? ( competitive ? Project ( templatemaps[ m ], Data[ tf2 ], polarity ) : fitcorr ( m, tf2 ) )
 
                                         // direct use of TVector functions, with proper polarity
                                         // !No Cloud Correlation available!
@@ -335,6 +335,127 @@ for ( int ri = 0; ri < numdata; ri++ )
 }
 
 
+//----------------------------------------------------------------------------
+        TPairsDistribution::TPairsDistribution ()
+{
+Reset ( 2 );
+}
+
+
+void    TPairsDistribution::Reset ( double maxvalue )
+{
+Range           = maxvalue > 0 ? maxvalue : 1;
+NumItems        = 0;
+SumValues       = 0;
+SumSquares      = 0;
+MinValue        = Highest<double> ();
+MaxValue        = Lowest <double> ();
+
+                                        // also clears the content
+BinCount.Resize ( PairsDistributionNumBins );
+BinSum  .Resize ( PairsDistributionNumBins );
+}
+
+
+int     TPairsDistribution::ValueToBin ( double v )   const
+{
+return  Clip ( (int) ( v / Range * PairsDistributionNumBins ), 0, PairsDistributionNumBins - 1 );
+}
+
+
+void    TPairsDistribution::Add ( double v )
+{
+int                 b               = ValueToBin ( v );
+
+BinCount[ b ]  += 1;
+BinSum  [ b ]  += v;
+
+NumItems       += 1;
+SumValues      += v;
+SumSquares     += v * v;
+
+Mined ( MinValue, v );
+Maxed ( MaxValue, v );
+}
+
+
+void    TPairsDistribution::Add ( const TPairsDistribution& pd )
+{
+for ( int b = 0; b < PairsDistributionNumBins; b++ ) {
+    BinCount[ b ]  += pd.BinCount[ b ];
+    BinSum  [ b ]  += pd.BinSum  [ b ];
+    }
+
+NumItems       += pd.NumItems;
+SumValues      += pd.SumValues;
+SumSquares     += pd.SumSquares;
+
+Mined ( MinValue, pd.MinValue );
+Maxed ( MaxValue, pd.MaxValue );
+}
+
+                                        // p is the rank ratio, starting from the lowest values
+double  TPairsDistribution::Quantile ( double p )    const
+{
+if ( NumItems == 0 )
+    return  0;
+
+                                        // rank of the requested item, 0-based, possibly fractional
+double              rank            = ( NumItems - 1 ) * Clip ( p, (double) 0, (double) 1 );
+double              cumul           = 0;
+
+
+for ( int b = 0; b < PairsDistributionNumBins; b++ ) {
+
+    if ( BinCount[ b ] == 0 )
+        continue;
+
+    if ( rank < cumul + BinCount[ b ] ) {
+                                        // items are assumed to be evenly spread within their bin
+        double      v       = BinToValue ( b ) + ( rank - cumul + 0.5 ) / BinCount[ b ] * ( Range / PairsDistributionNumBins );
+
+        return  Clip ( v, MinValue, MaxValue );
+        }
+
+    cumul  += BinCount[ b ];
+    }
+
+
+return  MaxValue;
+}
+
+                                        // Averaging the items which ranks are within [qfrom..qto], starting from the lowest values
+                                        // Partially covered bins contribute with their own mean value
+double  TPairsDistribution::TruncatedMean ( double qfrom, double qto )   const
+{
+if ( NumItems == 0 )
+    return  0;
+
+
+double              fromi           = Round ( ( NumItems - 1 ) * Clip ( qfrom, (double) 0, (double) 1 ) );
+double              toi             = Round ( ( NumItems - 1 ) * Clip ( qto,   (double) 0, (double) 1 ) );
+double              cumul           = 0;
+double              sum             = 0;
+
+
+for ( int b = 0; b < PairsDistributionNumBins && cumul <= toi; b++ ) {
+
+    if ( BinCount[ b ] == 0 )
+        continue;
+                                        // ranks covered by this bin: [cumul..cumul+count-1]
+    double      overlap     = min ( toi, cumul + BinCount[ b ] - 1 ) - max ( fromi, cumul ) + 1;
+
+    if ( overlap > 0 )
+        sum    += overlap * BinSum[ b ] / BinCount[ b ];
+
+    cumul  += BinCount[ b ];
+    }
+
+
+return  sum / ( toi - fromi + 1 );
+}
+
+
 //----------------------------------------------------------------------------
                                         // General function to compute the Within / Across Clusters Distances
                                         // !TEasyStats objects are not reset here, because caller can either want a per-cluster stat, or a total within clusters stat!
@@ -488,6 +609,122 @@ if ( IsFlag ( flags, WPooledDeterminant ) ) {
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Scanning all pairs of maps once, and summarizing them on the fly, without storing the pairs:
+                                        //  - within & between clusters distances distributions, for the Gamma, C-Index, Dunn, McClain and Point-Biserial criteria
+                                        //  - the sum of distances from each map to each cluster, for the Silhouettes
+                                        // Memory is linear with the number of maps, and pairs are processed by blocks to remain in cache
+void    TMicroStates::ComputePooledDistances    (   int                 nummaps,
+                                                    const TLabeling&    labels,
+                                                    PolarityType        polarity
+                                                )
+{
+TDownsampling       downmaps ( NumTimeFrames, CriterionPooledMaxMaps );
+
+                                        // gather the labeled maps only
+int                 numpooled       = 0;
+
+for ( long tf = downmaps.From; tf <= downmaps.To; tf += downmaps.Step )
+    if ( labels.IsDefined ( tf ) )
+        numpooled++;
+
+
+TArray1<int>        pooledtf ( numpooled );
+
+PooledLabel       .Resize ( numpooled );
+PooledClusterSize .Resize ( nummaps );
+PooledSumDistance .Resize ( numpooled, nummaps );
+
+PooledWDistance.Reset ( 2 );
+PooledBDistance.Reset ( 2 );
+
+
+int                 mapi            = 0;
+
+for ( long tf = downmaps.From; tf <= downmaps.To; tf += downmaps.Step ) {
+
+    if ( labels.IsUndefined ( tf ) )
+        continue;
+
+    pooledtf   [ mapi ] = (int) tf;
+    PooledLabel[ mapi ] = labels[ tf ];
+
+    PooledClusterSize[ PooledLabel[ mapi ] ]++;
+
+    mapi++;
+    }
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // list all the blocks of the upper triangular part, so that each thread gets a balanced load
+constexpr int       PooledBlockSize     = 64;
+int                 numblocks       = ( numpooled + PooledBlockSize - 1 ) / PooledBlockSize;
+int                 numblockpairs   = numblocks * ( numblocks + 1 ) / 2;
+TArray2<int>        blockpairs ( numblockpairs, 2 );
+
+for ( int bi = 0, bp = 0; bi < numblocks; bi++ )
+for ( int bj = bi;        bj < numblocks; bj++, bp++ ) {
+    blockpairs ( bp, 0 )    = bi;
+    blockpairs ( bp, 1 )    = bj;
+    }
+
+
+OmpParallelBegin
+
+TPairsDistribution  pooledw;
+TPairsDistribution  pooledb;
+TArray2<double>     sumdistance ( numpooled, nummaps );
+
+OmpFor
+
+for ( int bp = 0; bp < numblockpairs; bp++ ) {
+
+    Cartool.UpdateApplicationThrottled ();
+
+    int                 fromi           =        blockpairs ( bp, 0 ) * PooledBlockSize;
+    int                 toi             = min ( fromi + PooledBlockSize, numpooled );
+    int                 fromj           =        blockpairs ( bp, 1 ) * PooledBlockSize;
+    int                 toj             = min ( fromj + PooledBlockSize, numpooled );
+
+
+    for ( int pi = fromi;                      pi < toi; pi++ )
+    for ( int pj = fromi == fromj ? pi + 1 : fromj; pj < toj; pj++ ) {
+
+        const TMap&     map1    = Data[ pooledtf[ pi ] ];
+        const TMap&     map2    = Data[ pooledtf[ pj ] ];
+
+                                        // same as in ComputeW: get the right sign between the pair, on normalized data
+        double          corr    = Clip ( map1.ScalarProduct ( map2 ), -1.0, 1.0 );
+
+        if ( polarity == PolarityEvaluate )
+            corr    = fabs ( corr );
+
+        double          d       = sqrt ( CorrelationToSquareDifference ( corr ) );
+
+
+        if ( PooledLabel[ pi ] == PooledLabel[ pj ] )   pooledw.Add ( d );
+        else                                            pooledb.Add ( d );
+
+        sumdistance ( pi, PooledLabel[ pj ] )  += d;
+        sumdistance ( pj, PooledLabel[ pi ] )  += d;
+        }
+    }
+
+                                        // merge all threads results
+OmpCriticalBegin (ComputePooledDistances)
+
+PooledWDistance.Add ( pooledw );
+PooledBDistance.Add ( pooledb );
+
+for ( int i = 0; i < (int) PooledSumDistance.GetLinearDim (); i++ )
+    PooledSumDistance ( i )    += sumdistance ( i );
+
+OmpCriticalEnd
+
+OmpParallelEnd
+}
+
+
 //----------------------------------------------------------------------------
                                         // Compute once for all the Within and Across Clusters distances
                                         // !nclusters is the index, while nummaps the actual number of maps!
@@ -524,31 +761,6 @@ for ( int nc = 0; nc < nummaps; nc++ )
 OmpSectionEnd
 
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-OmpSectionBegin
-
-StatWPooledDistance         .Resize ( 1024 );   // !Use copies if Median or any re-ordering is needed, as to keep the data ordered as they were input!
-StatBPooledDistance         .Resize ( 1024 );
-StatAPooledDistance         .Resize ( 1024 );
-StatAPooledDistanceIndex    .Resize ( 1024 );
-
-for ( int nc = 0; nc < nummaps; nc++ )
-    ComputeW    ( nc, maps, labels, polarity, (WFlag) ( WPooled              | WDistance         ), &StatWPooledDistance,            &StatBPooledDistance,           &StatAPooledDistance,   &StatAPooledDistanceIndex   );
-
-OmpSectionEnd
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-OmpSectionBegin
-
-StatWPooledSquareDistance   .Resize ( 1024 ); // Reset ();
-
-for ( int nc = 0; nc < nummaps; nc++ )
-    ComputeW    ( nc, maps, labels, polarity, (WFlag) ( WPooled              | WSquareDistance   ), &StatWPooledSquareDistance,      0,                              0,                      0                           );
-
-OmpSectionEnd
-
-
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 //OmpSectionBegin
 //StatWPooledDetSquareDistance.Resize ( 1024 ); // Reset ();
@@ -564,27 +776,36 @@ OmpSectionEnd
 OmpParallelSectionsEnd
 
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // All pairs at once, summarized without being stored
+                                        // Outside of the sections above, as it is parallelized on its own
+ComputePooledDistances ( nummaps, labels, polarity );
+
+
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // Store all these means for later
 //var ( segWCD,   nclusters ) = StatWCentroidDistance         .Mean ();
 //var ( segWCD2,  nclusters ) = StatWCentroidSquareDistance   .Mean ();
 //var ( segBCD2,  nclusters ) = StatBCentroidSquareDistance   .Mean ();
-//var ( segWPD,   nclusters ) = StatWPooledDistance           .Mean ();
-//var ( segBPD,   nclusters ) = StatBPooledDistance           .Mean ();
-//var ( segAPD,   nclusters ) = StatAPooledDistance           .Mean ();
-//var ( segWPD2,  nclusters ) = StatWPooledSquareDistance     .Mean ();
+//var ( segWPD,   nclusters ) = PooledWDistance               .Mean ();
+//var ( segBPD,   nclusters ) = PooledBDistance               .Mean ();
 //var ( segWPdD2, nclusters ) = StatWPooledDetSquareDistance  .Mean ();
 
+                                        // all pairs distribution
+TPairsDistribution  pooledadistance ( PooledWDistance );
+
+pooledadistance.Add ( PooledBDistance );
+
                                         // Robust versions
 OmpParallelSectionsBegin
 
 OmpSectionBegin     var ( segWCD,   nclusters ) =              StatWCentroidDistance         .Median ();    OmpSectionEnd
 OmpSectionBegin     var ( segWCD2,  nclusters ) =              StatWCentroidSquareDistance   .Median ();    OmpSectionEnd
 OmpSectionBegin     var ( segBCD2,  nclusters ) =              StatBCentroidSquareDistance   .Median ();    OmpSectionEnd
-OmpSectionBegin     var ( segWPD,   nclusters ) = TEasyStats ( StatWPooledDistance          ).Median ();    OmpSectionEnd   // !work with a copy to keep the original ordering!
-OmpSectionBegin     var ( segBPD,   nclusters ) = TEasyStats ( StatBPooledDistance          ).Median ();    OmpSectionEnd   // !work with a copy to keep the original ordering!
-OmpSectionBegin     var ( segAPD,   nclusters ) = TEasyStats ( StatAPooledDistance          ).Median ();    OmpSectionEnd   // !work with a copy to keep the original ordering!
-OmpSectionBegin     var ( segWPD2,  nclusters ) =              StatWPooledSquareDistance     .Median ();    OmpSectionEnd
+OmpSectionBegin     var ( segWPD,   nclusters ) =              PooledWDistance               .Median ();    OmpSectionEnd
+OmpSectionBegin     var ( segBPD,   nclusters ) =              PooledBDistance               .Median ();    OmpSectionEnd
+OmpSectionBegin     var ( segAPD,   nclusters ) =              pooledadistance               .Median ();    OmpSectionEnd
+OmpSectionBegin     var ( segWPD2,  nclusters ) = Square (     PooledWDistance               .Median () );  OmpSectionEnd   // square is monotonic, so the median of the squares is the square of the median
 OmpSectionBegin     var ( segWPdD2, nclusters ) = 0;         /*StatWPooledDetSquareDistance  .Median ();*/  OmpSectionEnd
 
 OmpParallelSectionsEnd
@@ -811,8 +1032,8 @@ return  CHi;
 double  TMicroStates::ComputeDunn   (   int               /*nclusters*/ )
 {
                                         // Official Dunn index
-double              dmin            = TEasyStats ( StatBPooledDistance ).Min ();    // between clusters
-double              dmax            = TEasyStats ( StatWPooledDistance ).Max ();    // within clusters
+double              dmin            = PooledBDistance.Min ();    // between clusters
+double              dmax            = PooledWDistance.Max ();    // within clusters
 
                                         // Official formula: Highest between cluster and lowest within cluster
 //double            Dunn            = dmin / NonNull ( dmax );
@@ -827,12 +1048,12 @@ return  Dunn;
 double  TMicroStates::ComputeDunnRobust (   int             /*nclusters*/ )
 {
                                         // More robust - but not the same curve
-//double            dmin            = TEasyStats ( StatBPooledDistance ).Quantile ( 0.10 ); // between clusters
-//double            dmax            = TEasyStats ( StatWPooledDistance ).Quantile ( 0.90 ); // within clusters
-//double            dmin            = TEasyStats ( StatBPooledDistance ).TruncatedMean ( 0.00, 0.25 );  // between clusters
-//double            dmax            = TEasyStats ( StatWPooledDistance ).TruncatedMean ( 0.75, 1.00 );  // within clusters
-double              dmin            = TEasyStats ( StatBPooledDistance ).TruncatedMean ( 0.00, 0.05 );  // between clusters
-double              dmax            = TEasyStats ( StatWPooledDistance ).TruncatedMean ( 0.95, 1.00 );  // within clusters
+//double            dmin            = PooledBDistance.Quantile ( 0.10 ); // between clusters
+//double            dmax            = PooledWDistance.Quantile ( 0.90 ); // within clusters
+//double            dmin            = PooledBDistance.TruncatedMean ( 0.00, 0.25 );  // between clusters
+//double            dmax            = PooledWDistance.TruncatedMean ( 0.75, 1.00 );  // within clusters
+double              dmin            = PooledBDistance.TruncatedMean ( 0.00, 0.05 );  // between clusters
+double              dmax            = PooledWDistance.TruncatedMean ( 0.95, 1.00 );  // within clusters
 
                                         // Official formula
 //double              DunnRobust      = dmin / NonNull ( dmax );
@@ -847,10 +1068,10 @@ return  DunnRobust;
                                         // McClain index
 double  TMicroStates::ComputeMcClain    (   int               /*nclusters*/ )
 {
-//double            bmean           = StatWPooledDistance.Mean ();     // between clusters
-//double            wmean           = StatBPooledDistance.Mean ();     // within clusters
-double              bmean           = TEasyStats ( StatWPooledDistance ).Median ();     // between clusters
-double              wmean           = TEasyStats ( StatBPooledDistance ).Median ();     // within clusters
+//double            bmean           = PooledWDistance.Mean ();     // between clusters
+//double            wmean           = PooledBDistance.Mean ();     // within clusters
+double              bmean           = PooledWDistance.Median ();    // between clusters
+double              wmean           = PooledBDistance.Median ();    // within clusters
 
                                         // Official formula: looking for a max
 //double            McClain         = wmean / NonNull ( bmean );
@@ -864,13 +1085,14 @@ return  McClain;
 //----------------------------------------------------------------------------
                                         // C-Index from Hubert & Levin
                                         // [Sum of within clusters pair distances] normalized by [Sum of all pair distances]
-                                        // !Can be costly for large dataset!
+                                        // Extreme pairs are retrieved from the pairs distribution, so memory does not grow with the number of pairs
                                         // Lower is best, so invert results
 double  TMicroStates::ComputeCIndex     (   int               /*nclusters*/ )
 {
-                                        // !Use a copy to preserve the orignal's ordering!
-TEasyStats          statwpooleddistance ( StatWPooledDistance );
-TEasyStats          statapooleddistance ( StatAPooledDistance );
+const TPairsDistribution&   statwpooleddistance     = PooledWDistance;
+TPairsDistribution          statapooleddistance ( PooledWDistance );
+
+statapooleddistance.Add ( PooledBDistance );
 
 
 int                 numpairs        = statwpooleddistance.GetNumItems ();
@@ -1196,172 +1418,81 @@ return  PB;
 
                                         // Do a correlation of the ditance matrix with the binarized version of it, with 1 if points are not in the same clusters
                                         // Here the computation is done on the lower triangular + diagonal parts only, nearly the same as the full squared matrix of distances
-double  TMicroStates::ComputePointBiserial  (   int    nclusters,   TLabeling&      labels )
+                                        // Pearson correlation only needs a few sums, which are all directly available from the pairs distributions
+double  TMicroStates::ComputePointBiserial  (   int    /*nclusters*/,   TLabeling&      /*labels*/ )
 {
-                                        // !Don't sort nor Median StatAPooledDistance to keep it coherent with StatAPooledDistanceIndex!
-
                                         // total number of valid data, which is also the size of the diagonal distance matrix
-//int               nummaps         = NumTimeFrames;                                                        // all data, without downsampling nor Correlation Threshold
-//int               nummaps         = RoundAbove ( NumTimeFrames / (double) CriterionDownSampling );        // downsampled number of points / indexes - !rounding above!
-//int               nummaps         = GetSizeOfClusters ( 0, nclusters - 1, labels, CriterionDownSampling );// count of attributed maps - could be less in case of Correlation Thresholding f.ex.
-int                 nummaps         = StatAPooledDistance.PairsToNumItems ();                               // same value / behavior as above
-
-//DBGV5 ( nclusters, NumTimeFrames, RoundAbove ( NumTimeFrames / (double) CriterionDownSampling ), labels.GetSizeOfClusters ( 0, nclusters - 1, CriterionDownSampling ), StatAPooledDistance.PairsToNumItems (), "ComputePointBiserial:  nclusters, NumTimeFrames, RoundAbove ( NumTimeFrames / CriterionDownSampling )  GetSizeOfClusters, StatAPooledDistance.PairsToNumItems" );
-
-
-int                 numlowtriang    = StatAPooledDistance.GetNumItems ();               // triangular matrix size without the diagonal (and without the undefined labels) - quite the same as the squared matrix
-
-int                 vectorsize      = numlowtriang + nummaps;                           // triangular matrix size with diagonal
-
-                                        // create 2 big vectors
-TMap                W  ( vectorsize );  // real distances
-TMap                Wb ( vectorsize );  // binarized version of the classification: 1 for between cluster (further distance), 0 for within cluster (close distance)
-
-                                        // same labels -> false
-auto                AreDifferentLabels  = [] ( const auto& L1, const auto& L2 )     { return  L1 == L2 ? 0 : 1; };
+int                 nummaps         = PooledLabel.GetDim ();
+                                        // triangular matrix size without the diagonal, plus the diagonal itself, which has null distances and identical labels
+double              numpairsw       = PooledWDistance.GetNumItems ();
+double              numpairsb       = PooledBDistance.GetNumItems ();
+double              vectorsize      = numpairsw + numpairsb + nummaps;
 
+if ( vectorsize == 0 )
+    return  0;
 
-                                        // transfer lower diagonal part, where pairs are always of non-identical maps
-for ( int vi = 0, ii = 0; vi < numlowtriang; vi++, ii += 2 ) {
-                                        // !Note: insert this twice to have the real squared matrix W (the upper triangular part)!
-    W [ vi ]    =                              StatAPooledDistance     [ vi     ];      // distance between pair
-    Wb[ vi ]    = AreDifferentLabels ( labels[ StatAPooledDistanceIndex[ ii     ] ],
-                                       labels[ StatAPooledDistanceIndex[ ii + 1 ] ] );  // TF indexes are stored sequentially
-    }
-
-                                        // transfer diagonal part, where pairs are always of identical maps
-for ( int vi = numlowtriang, mapi = 0; vi < vectorsize; vi++, mapi++ ) {
-    W [ vi ]    = 0;                                    // distance is always 0
-    Wb[ vi ]    = AreDifferentLabels ( mapi, mapi );    // indexes are always the same
-    }
+                                        // real distances
+double              sumd            = PooledWDistance.Sum  () + PooledBDistance.Sum  ();
+double              sumd2           = PooledWDistance.Sum2 () + PooledBDistance.Sum2 ();
+                                        // binarized version of the classification: 1 for between cluster (further distance), 0 for within cluster (close distance)
+double              sumb            = numpairsb;    // also the sum of squares
+                                        // cross-products are non-null only for between clusters pairs
+double              sumdb           = PooledBDistance.Sum ();
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // do a Pearson correlation among the 2 types of data
-double              PointBiserial   = W.Correlation ( Wb, true );
+double              sum             = sumdb - sumd * sumb / vectorsize;
+double              norm1           = sumd2 - sumd * sumd / vectorsize;
+double              norm2           = sumb  - sumb * sumb / vectorsize;
+
+double              PointBiserial   = sum == 0 || norm1 <= 0 || norm2 <= 0 ? 0 : Clip ( sum / sqrt ( norm1 * norm2 ), -1.0, 1.0 );
 
 return  PointBiserial;
 }
 
 
 //----------------------------------------------------------------------------
-double  TMicroStates::ComputeSilhouettes    (   int     nclusters,  TLabeling&  labels )
+                                        // Silhouettes directly from the sums of distances of each map to each cluster
+double  TMicroStates::ComputeSilhouettes    (   int     /*nclusters*/,  TLabeling&  /*labels*/ )
 {
-                                        // !Don't sort nor Median StatAPooledDistance to keep it coherent with StatAPooledDistanceIndex!
-
-                                        // Get total number of valid data
-//int               nummaps         = NumTimeFrames;                                                        // all data, without downsampling nor Correlation Threshold
-int                 nummaps         = RoundAbove ( NumTimeFrames / (double) CriterionDownSampling );        // downsampled number of points / indexes - !rounding above!
-//int               nummaps         = GetSizeOfClusters ( 0, nclusters - 1, labels, CriterionDownSampling ); // count of attributed maps - could be less in case of Correlation Thresholding f.ex.
-//int               nummaps         = StatAPooledDistance.PairsToNumItems ();                               // same value / behavior as above
-
-//DBGV5 ( nclusters, NumTimeFrames, RoundAbove ( NumTimeFrames / (double) CriterionDownSampling ), GetSizeOfClusters ( 0, nclusters - 1, labels, CriterionDownSampling ), StatAPooledDistance.PairsToNumItems (), "ComputeSilhouettes:  nclusters, NumTimeFrames, RoundAbove ( NumTimeFrames / CriterionDownSampling )  GetSizeOfClusters, StatAPooledDistance.PairsToNumItems" );
-
-
-int                 numlowtriang    = StatAPooledDistance.GetNumItems ();                             // triangular matrix size without the diagonal (and without the undefined labels) - quite the same as the squared matrix
-
-                                        // within and between clusters distances
-TArray2<double>     Dw ( nummaps,                2 );   // !nummaps can be greater than the actual number of maps!
-TArray3<double>     Db ( nummaps, nclusters + 1, 2 );   // 1 more for min distance
-int                 mapi1;
-int                 mapi2;
-LabelType           label1;
-LabelType           label2;
-double              d;
-
-                                        // transfer lower diagonal part, where pairs are always of non-identical maps
-for ( int vi = 0, ii = 0; vi < numlowtriang; vi++, ii += 2 ) {
-
-    mapi1       = StatAPooledDistanceIndex[ ii     ];
-    mapi2       = StatAPooledDistanceIndex[ ii + 1 ];
-    label1      = labels                  [ mapi1  ];
-    label2      = labels                  [ mapi2  ];
-    d           = StatAPooledDistance     [ vi     ];   // distance between pair
+int                 nummaps         = PooledLabel.GetDim ();
+int                 nclusters       = PooledClusterSize.GetDim ();
+TEasyStats          stats;              // silhouettes stats
+double              a;
+double              b;
+double              S;
+//TGoEasyStats      statsk ( nclusters + 1 );
 
-                                        // convert to downsampled indexes
-    mapi1      /= CriterionDownSampling;
-    mapi2      /= CriterionDownSampling;
 
-//    if ( mapi1 >= nummaps || mapi2 >= nummaps ) { DBGV4 ( nclusters, nummaps, mapi1, mapi2, "Sil Error:  nclusters, nummaps, mapi1, mapi2" ); continue; }
+for ( int mapi = 0; mapi < nummaps; mapi++ ) {
 
+    int             label       = PooledLabel[ mapi ];
+                                        // average distance within cluster for each map, not counting itself
+    a           = PooledSumDistance ( mapi, label ) / NonNull ( PooledClusterSize[ label ] - 1 );
 
-    if ( label1 == label2 ) {
-        Dw ( mapi1,            0 ) += d;    // pairs of maps from the same cluster
-        Dw ( mapi1,            1 ) ++;
-        Dw ( mapi2,            0 ) += d;
-        Dw ( mapi2,            1 ) ++;
-        }
-    else {
-        Db ( mapi1, label2,    0 ) += d;    // pairs of maps from different clusters, update map1 toward cluster2
-        Db ( mapi1, label2,    1 ) ++;
-        Db ( mapi1, nclusters, 1 ) ++;      // + global count
-        Db ( mapi2, label1,    0 ) += d;    // pairs of maps from different clusters, update map2 toward cluster1
-        Db ( mapi2, label1,    1 ) ++;
-        Db ( mapi2, nclusters, 1 ) ++;      // + global count
-        }
-    }
+                                        // min of the average distances to the other clusters
+    b           = Highest<double> ();
 
+    for ( int nc = 0; nc < nclusters; nc++ )
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Average all distances
+        if ( nc != label && PooledClusterSize[ nc ] > 0 )
 
-for ( int mapi = 0, mapio = 0; mapi < nummaps; mapi++, mapio += CriterionDownSampling ) {
-                                        // actually all TFs
-    if ( labels.IsUndefined ( mapio ) )
-        continue;
+            Mined ( b, PooledSumDistance ( mapi, nc ) / PooledClusterSize[ nc ] );
 
-                                        // empty slot
-    if ( Dw ( mapi, 1 ) == 0 && Db ( mapi, nclusters, 1 ) == 0 )
+                                        // empty slot, no other cluster and no other map from the same cluster
+    if ( b == Highest<double> () && PooledClusterSize[ label ] <= 1 )
         continue;
-
-                                        // average distance within cluster for each map
-    Dw ( mapi, 0 )     /= NonNull ( Dw ( mapi, 1 ) );
-
-                                        // initialize min average distances
-    Db ( mapi, nclusters, 0 )   = Highest<double> ();
-
-                                        // average distance between clusters for each map
-    for ( int nc = 0; nc < nclusters; nc++ ) {
-
-        Db ( mapi, nc, 0 ) /= NonNull ( Db ( mapi, nc, 1 ) );
-                                        // get min across clusters (!null distance for within cluster!)
-        if ( Db ( mapi, nc, 0 ) != 0 )
-            Mined ( Db ( mapi, nclusters, 0 ), Db ( mapi, nc, 0 ) );
-        }
-
                                         // by safety
-    if ( Db ( mapi, nclusters, 0 ) == Highest<double> () )
-        Db ( mapi, nclusters, 0 )   = 1e300;
-
-    }
+    if ( b == Highest<double> () )
+        b       = 1e300;
 
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Compute silhouette for each map
-TArray1<double>     S ( nummaps );
-double              a;
-double              b;
-TEasyStats          stats;              // silhouettes stats
-//TGoEasyStats      statsk ( nclusters + 1 );
-
-
-for ( int mapi = 0, mapio = 0; mapi < nummaps; mapi++, mapio += CriterionDownSampling ) {
-                                        // actually all TFs
-    if ( labels.IsUndefined ( mapio ) )
-        continue;
-
-                                        // empty slot
-    if ( Dw ( mapi, 1 ) == 0 && Db ( mapi, nclusters, 1 ) == 0 )
-        continue;
-
-
-    a           = Dw ( mapi,            0 );
-    b           = Db ( mapi, nclusters, 0 );
-    S ( mapi )  = ( b - a ) / NonNull ( max ( a, b ) );
+    S           = ( b - a ) / NonNull ( max ( a, b ) );
                                         // add to global stats
-    stats                     .Add ( S ( mapi ), ThreadSafetyIgnore );
+    stats                     .Add ( S, ThreadSafetyIgnore );
                                         // add to per cluster stats
-//  statsk ( labels[ mapio ] ).Add ( S ( mapi ), ThreadSafetyIgnore );
+//  statsk ( label )          .Add ( S, ThreadSafetyIgnore );
     }
 
 //stats.Show ( "silhouettes" );
@@ -1414,52 +1545,33 @@ double  TMicroStates::ComputeGamma  (   int                 /*nclusters*/,
                                     )
 {
                                         // Count set of pairs according to distances
-int                 numpairsw       = StatWPooledDistance.GetNumItems ();
-int                 numpairsb       = StatBPooledDistance.GetNumItems ();
-int                 numpairsa       = numpairsw + numpairsb;
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Use histograms to count the number of pairs below or above a given value                                        
-double                  minwb               = 0;    // min distance between 2 normalized maps: 0
-double                  maxwb               = 2.0;  // max distance between 2 normalized maps: 2 with polarities, sqrt(2) for ignore polarity
-double                  histosize           = 200;  // 0 to get an optimal array size, but it could get really big sometimes, so override to something realistic and fast
-
-                                        // histograms, not normalized
-THistogram              histow  (   StatWPooledDistance, 
-                                    0, minwb, maxwb, 
-                                    0, 5, 
-                                    (HistogramOptions) ( HistogramPDF | HistogramRaw | HistogramCount | HistogramLinear ), 
-                                    &histosize
-                                );
-THistogram              histob  (   StatBPooledDistance, 
-                                    0, minwb, maxwb, 
-                                    0, 5, 
-                                    (HistogramOptions) ( HistogramPDF | HistogramRaw | HistogramCount | HistogramLinear ), 
-                                    &histosize
-                                );
-
-
-THistogram              cdfb   ( histob );
-                                        // cdf, not normalized
-cdfb.ToCDF ( HistogramCount );
+double              numpairsw       = PooledWDistance.GetNumItems ();
+double              numpairsb       = PooledBDistance.GetNumItems ();
+double              numpairsa       = numpairsw + numpairsb;
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Use the pairs distributions to count the number of pairs below or above a given value
+                                        // Both distributions share the same bins, which are much finer than the 200 bins previously used
+int                 histosize       = PooledBDistance.GetNumBins ();
+double              cdfb            = 0;    // cdf, not normalized
 
 double              splus           = 0;    // count within clusters pairs closer  than between clusters pairs
 double              sminus          = 0;    // count within clusters pairs further than between clusters pairs
 
 
 for ( int wbi = 0; wbi < histosize; wbi++ ) {
+
+    cdfb       += PooledBDistance.GetBinCount ( wbi );
+
                                         // S+ (number of Within pairs and Between pairs, with Within pairs at lower distances than Between pairs)
                                         // for each pair value w, the number of pairs in B higher than w is exactly the ( 1 - CDFB[w] ) * #B
                                         // "repeating" the sum for each w is simply done by multiplying by HistogramW[w]
-    splus      += histow ( wbi ) * ( cdfb ( histosize - 1 ) - cdfb ( wbi ) );
+    splus      += PooledWDistance.GetBinCount ( wbi ) * ( numpairsb - cdfb );
 
                                         // S- (number of Within pairs and Between pairs, with Within pairs at greater distances than Between pairs)
                                         // same idea, the number of B pairs lower than w is CDFB[w] * #B
-    sminus     += histow ( wbi ) *                            cdfb ( wbi );
+    sminus     += PooledWDistance.GetBinCount ( wbi ) *               cdfb;
     }
 
 
@@ -1185,13 +1185,17 @@ for ( nclusters = minclusters; nclusters <= maxclusters; nclusters++ ) {
 //  Gauge.Next ( gaugesegcluster, GroupGauge.IsNotAlive () ? SuperGaugeUpdateTitle : SuperGaugeNoTitle );
     Gauge.CurrentPart   = gaugesegcluster;
 
-                                        // offer to quit while processing(?)
-//  if ( VkEscape () ) {
-//      if ( GetAnswerFromUser ( "Aborting segmentation now?", SegmentationTitle ) ) {
-//          DeallocateVariables ();
-//          return  false;
-//          }
-//      }
+                                        // offer to quit while processing - Escape key is polled by the gauge at refresh time, including during the parallel clustering
+    if ( Gauge.IsCanceled () ) {
+
+        if ( GetAnswerFromUser ( "Aborting segmentation now?", SegmentationTitle ) ) {
+            Gauge.Finished ();
+            DeallocateVariables ();
+            return  false;
+            }
+
+        Gauge.ResetCanceled ();
+        }
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1572,16 +1576,6 @@ for ( nclusters = minclusters; nclusters <= maxclusters; nclusters++ ) {
         _stats.Sort ();
         StringCopy      ( _file,                 BaseFileNameCluster, ".BCentroidDistances2", ".sef" );
         _stats.WriteFileData ( _file );
-
-        _stats  = StatWPooledDistance;
-        _stats.Sort ();
-        StringCopy      ( _file,                 BaseFileNameCluster, ".WPooledDistances", ".sef" );
-        _stats.WriteFileData ( _file );
-
-        _stats  = StatBPooledDistance;
-        _stats.Sort ();
-        StringCopy      ( _file,                 BaseFileNameCluster, ".BPooledDistances", ".sef" );
-        _stats.WriteFileData ( _file );
 */
         } // nummaps > 0
 
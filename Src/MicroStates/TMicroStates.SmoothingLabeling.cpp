@@ -94,6 +94,41 @@ double              gevbefore;
 LabelType           undefi              = nclusters;// index of the undefined labels
 
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // The data part of the cost does not depend on the labeling, so it is computed once for all iterations
+long                numtf               = tfmax - tfmin + 1;
+TArray2<double>     datacorr    ( numtf, nclusters );
+TArray2<double>     datadiff    ( numtf, nclusters );
+TArray2<bool>       datainvert  ( numtf, nclusters );
+
+
+OmpParallelFor
+
+for ( long tf = tfmin; tf <= tfmax; tf++ ) {
+
+    long                tfi             = tf - tfmin;
+
+    for ( int nc = 0; nc < nclusters; nc++ ) {
+
+        if ( mapsel && ! (*mapsel)[ nc ] )
+            continue;
+
+                                        // test and store polarity
+        PolarityType    pol     = polarity == PolarityEvaluate && maps[ nc ].IsOppositeDirection ( Data[ tf ] ) ? PolarityInvert : PolarityDirect;
+
+                                        // compute correlation with previous polarity
+        double          corr    = Project ( maps[ nc ], Data[ tf ], pol );
+
+        datainvert ( tfi, nc )  = pol == PolarityInvert;
+        datacorr   ( tfi, nc )  = corr;
+                                        // upper part of the error ratio SigmaMu/Sigma2: lower the error for most probable maps
+//      datadiff   ( tfi, nc )  = ( Square ( Norm[ tf ] ) * ( 1 - Square ( corr ) ) )       // from original article
+        datadiff   ( tfi, nc )  = ( Square ( Norm[ tf ] ) * ( 1 - SignedSquare ( corr ) ) ) // !accounting for ERP case where correlation -0.9 should be worse than +0.5, and not better! Still a highly negative correlation is very unlikely to occur anyway
+                                / ( 2 * origsigma2 * ( NumElectrodes - 1 ) );
+        }
+    }
+
+
                                         // limit the number of repetitions by safety - only a few iterations are needed in practice
 for ( int smoothi = 0; smoothi < SmoothingMaxIter; smoothi++ ) {
 
@@ -106,20 +141,35 @@ for ( int smoothi = 0; smoothi < SmoothingMaxIter; smoothi++ ) {
     OmpParallelBegin
 
     TArray1<int>        histo ( nclusters + 1 );        // 1 more for UndefinedLabel case
+    long                histotf         = tfmin - 2;    // last tf which window has been counted in histo, none for the moment
+
+                                        // label of a given tf, undefined being counted in its own dummy cluster - !it has NO associated maps!
+    auto                HistoIndex      = [ &labels, &undefi ] ( long tf )  { return  labels.IsUndefined ( tf ) ? undefi : labels[ tf ]; };
 
     OmpFor
                                         // maps -> labels
     for ( long tf = tfmin; tf <= tfmax; tf++ ) {
 
-                                        // compute histogram of neighbors' clusters
-        histo   = 0;
+        long                tfi             = tf - tfmin;
 
-        for ( long tf2 = AtLeast ( tfmin, tf - winsize ); tf2 <= NoMore ( tfmax, tf + winsize ); tf2++ )
+                                        // histogram of the whole window, including current tf
+                                        // each thread is working on consecutive tf's, so the window can be slided by 1 most of the time
+        if ( tf == histotf + 1 ) {
 
-            if ( tf2 != tf )
+            if ( tf - winsize - 1 >= tfmin )    histo[ HistoIndex ( tf - winsize - 1 ) ]--;
+            if ( tf + winsize     <= tfmax )    histo[ HistoIndex ( tf + winsize     ) ]++;
+            }
+        else {
+            histo   = 0;
 
-                if ( labels.IsUndefined ( tf2 ) )   histo[ undefi        ]++;   // dummy cluster, just for UndefinedLabel - !t has NO associated maps!
-                else                                histo[ labels[ tf2 ] ]++;
+            for ( long tf2 = AtLeast ( tfmin, tf - winsize ); tf2 <= NoMore ( tfmax, tf + winsize ); tf2++ )
+                histo[ HistoIndex ( tf2 ) ]++;
+            }
+
+        histotf     = tf;
+
+                                        // histogram of neighbors' clusters only - will be restored below
+        histo[ HistoIndex ( tf ) ]--;
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -127,6 +177,8 @@ for ( int smoothi = 0; smoothi < SmoothingMaxIter; smoothi++ ) {
                                         // If there is a majority of undefined data points AND current data point is undefined THEN keep it undefined
                                         // !current data point HAS to be undefined as to avoid flipping labeled to unlabeled and unlabeled to labeled alternatively!
                                         // !not applied to a currently labeled data point, which could make it undefined therefor moving the edge!
+        bool                keepundefined   = false;
+
         if ( labels.IsUndefined ( tf ) ) {
                                         // if we need a real count
 //          int                 countundef      = 0;
@@ -136,9 +188,7 @@ for ( int smoothi = 0; smoothi < SmoothingMaxIter; smoothi++ ) {
 //              countundef     +=  histo[ nc ] <= histo[ undefi ];
 //
 //
-//          if ( countundef == nclusters )
-//                                      // if undefined is the most probable..
-//              continue;               // ..then stay UndefinedLabel
+//          keepundefined   = countundef == nclusters;  // if undefined is the most probable, then stay UndefinedLabel
 
                                         // simplified code to stop at first cluster with more than undefined count
             int                 nc              = 0;
@@ -149,52 +199,41 @@ for ( int smoothi = 0; smoothi < SmoothingMaxIter; smoothi++ ) {
 
                     break;
 
-
-            if ( nc == nclusters )      // no cluster count went above undefined count?
-
-                continue;               // keep current undefined state
+                                        // no cluster count went above undefined count? keep current undefined state
+            keepundefined   = nc == nclusters;
             }
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // From here we ignore any UndefinedLabel labels from histogram
                                         // We can have either: 1) a valid labels or 2) a somehow isolated (minority) undefined labels, which could then be flipped to labeled depending on limitcorr value
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // compute new error by using the histogram to alter the scalar product results
-        PolarityType        pol;
-        double              corr;
+                                        // compute new error by using the histogram to alter the precomputed data error
         double              diff;
         double              diffmin     = Highest ( diffmin );
         
 
-        for ( int nc = 0; nc < nclusters; nc++ ) {
+        for ( int nc = 0; nc < nclusters && ! keepundefined; nc++ ) {
 
             if ( mapsel && ! (*mapsel)[ nc ] )
                 continue;
 
-                                        // test and store polarity
-            pol         = polarity == PolarityEvaluate && maps[ nc ].IsOppositeDirection ( Data[ tf ] ) ? PolarityInvert : PolarityDirect;
-
-                                        // compute correlation with previous polarity
-            corr        = Project ( maps[ nc ], Data[ tf ], pol );
-                
-                                        // upper part of the error ratio SigmaMu/Sigma2: lower the error for most probable maps
-//          diff        = ( Square ( Norm[ tf ] ) * ( 1 - Square ( corr ) ) )       // from original article
-            diff        = ( Square ( Norm[ tf ] ) * ( 1 - SignedSquare ( corr ) ) ) // !accounting for ERP case where correlation -0.9 should be worse than +0.5, and not better! Still a highly negative correlation is very unlikely to occur anyway
-                        / ( 2 * origsigma2 * ( NumElectrodes - 1 ) ) 
-                        - lambda * histo[ nc ];
+            diff        = datadiff ( tfi, nc ) - lambda * histo[ nc ];
 
                                         // updating the labeling, so we have to test for the correlation limit
                                         // !if limitcorr == IgnoreCorrelationThreshold, this will force any unlabeled data point into labeled!
                                         // !if limitcorr != IgnoreCorrelationThreshold, unlabeled data point due to low correlation will remain unlabeled!
-            if ( corr >= limitcorr && diff < diffmin ) {
+            if ( datacorr ( tfi, nc ) >= limitcorr && diff < diffmin ) {
 
                 diffmin     = diff;
 
-                templabels.SetLabel ( tf, nc, pol );
+                templabels.SetLabel ( tf, nc, datainvert ( tfi, nc ) ? PolarityInvert : PolarityDirect );
                 }
 
             } // for nc
 
+                                        // restoring the whole window count
+        histo[ HistoIndex ( tf ) ]++;
+
         } // for tf
 
     OmpParallelEnd
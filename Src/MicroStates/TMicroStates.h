@@ -307,6 +307,58 @@ enum        WFlag
             };
 
 
+//----------------------------------------------------------------------------
+                                        // Bounded-memory summary of pairwise distances, used in place of storing each and every pair
+                                        // Distances between normalized maps are within [0..2], so a fine fixed-size histogram is enough
+                                        // for the quantiles & truncated means, while count, sum, sum of squares, min and max remain exact
+constexpr int       PairsDistributionNumBins    = 4096;
+                                        // Pairs are not stored anymore, so we can afford more maps than with ComputeW
+constexpr int       CriterionPooledMaxMaps      = 6000;
+
+
+class   TPairsDistribution
+{
+public:
+                    TPairsDistribution ();
+
+
+    void            Reset           ( double maxvalue );
+    void            Add             ( double v );
+    void            Add             ( const TPairsDistribution& pd );   // merging another distribution, with the same range
+
+
+    double          GetNumItems     ()                          const   { return    NumItems; }
+    int             GetNumBins      ()                          const   { return    PairsDistributionNumBins; }
+    double          GetBinCount     ( int b )                   const   { return    BinCount[ b ]; }
+    double          Sum             ()                          const   { return    SumValues; }
+    double          Sum2            ()                          const   { return    SumSquares; }
+    double          Mean            ()                          const   { return    NumItems ? SumValues / NumItems : 0; }
+    double          Min             ()                          const   { return    NumItems ? MinValue : 0; }
+    double          Max             ()                          const   { return    NumItems ? MaxValue : 0; }
+
+    double          Quantile        ( double p )                const;  // values are interpolated within each bin
+    double          Median          ()                          const   { return    Quantile ( 0.50 ); }
+    double          TruncatedMean   ( double qfrom, double qto )const;  // same ranks as TEasyStats::TruncatedMean
+
+
+protected:
+
+    double          Range;
+    double          NumItems;
+    double          SumValues;
+    double          SumSquares;
+    double          MinValue;
+    double          MaxValue;
+
+    TArray1<double> BinCount;
+    TArray1<double> BinSum;             // sum of values per bin, which gives a better estimate than the bin center
+
+
+    int             ValueToBin      ( double v )                const;
+    double          BinToValue      ( int b )                   const   { return    b * Range / PairsDistributionNumBins; }
+};
+
+
                                         // Some utility functions used for clustering criteria
 
 //constexpr int     KLFilterSize                = 1;
@@ -564,6 +616,7 @@ protected:
                                         // Clustering criteria
     void            ComputeAllWBA           ( int nclusters, int nummaps, const TMaps& maps, const TLabeling& labels, PolarityType polarity, TArray2<double>& var );
     void            ComputeW                ( int nc, const TMaps& maps, const TLabeling& labels, PolarityType polarity, WFlag flags, TEasyStats* statcluster, TEasyStats* statnoncluster, TEasyStats* statall, TEasyStats* indexall );
+    void            ComputePooledDistances  ( int nummaps, const TLabeling& labels, PolarityType polarity );
     void            ComputeClustersDispersion   ( int nummaps, TMaps& maps, TLabeling& labels, PolarityType polarity, TArray1<double>& dispersion, bool precise );
 
     double          ComputeCrossValidation  ( int nclusters, int numelectrodes, TMaps& maps, TLabeling& labels, PolarityType polarity, long tfmin, long tfmax );
@@ -610,12 +663,13 @@ private:
     TEasyStats      StatWCentroidSquareDistance;
     TEasyStats      StatBCentroidSquareDistance;
 
-    TEasyStats      StatWPooledDistance;
-    TEasyStats      StatBPooledDistance;
-    TEasyStats      StatAPooledDistance;
-    TEasyStats      StatAPooledDistanceIndex;
+                                        // All pairs of maps, summarized without storing the pairs themselves - see ComputePooledDistances
+    TPairsDistribution  PooledWDistance;    // within clusters pairs
+    TPairsDistribution  PooledBDistance;    // between clusters pairs
 
-    TEasyStats      StatWPooledSquareDistance;
+    TArray1<int>    PooledLabel;        // label of each pooled map
+    TArray1<int>    PooledClusterSize;  // number of pooled maps per cluster
+    TArray2<double> PooledSumDistance;  // sum of distances of each pooled map to all maps of each cluster, used by the Silhouettes
 
 //  TEasyStats      StatWPooledDetSquareDistance;   // !not used for the moment!
 
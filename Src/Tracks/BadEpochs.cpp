@@ -19,6 +19,7 @@ limitations under the License.
 #include    "Files.Utils.h"
 #include    "Files.ReadFromHeader.h"
 #include    "Files.BatchAveragingFiles.h"
+#include    "Files.TOpenDoc.h"
 #include    "TArray1.h"
 #include    "TArray2.h"
 #include    "TFilters.h"
@@ -32,6 +33,8 @@ limitations under the License.
 #include    "GlobalOptimize.Tracks.h" 
 
 #include    "TMarkers.h"
+#include    "TMaps.h"
+#include    "TTracksDoc.h"
 #include    "BadEpochs.h"
 
 #include    "TCartoolMdiClient.h"
@@ -149,76 +152,205 @@ TFileName           _basefile;
 
 
 //----------------------------------------------------------------------------
-                                        // Maps to criteria
-void    ComputeBadEpochsCriteria    (   const TMaps*        mapsin,
-                                        const char*         filename,                   int                 session,
-                                        double              targetsamplingfrequency,
-                                        FilterTypes         filtertype,                 const double*       freqcut,
-                                        double              badduration,
-                                        TVector<float>*     criteria,
-                                        double&             samplingfrequency,
-                                        TSuperGauge*        Gauge,
-                                        TVector<float>*     rawcriteria
-                                    )
+                                        // Downsampling factor and resulting dimensions of an opened file
+bool    GetBadEpochsDimensions  (   TTracksDoc*         EEGDoc,
+                                    const TSelection*   ignoretracks,
+                                    double              targetsamplingfrequency,
+                                    int&                downsampling,
+                                    double&             samplingfrequency,
+                                    int&                nummaps,
+                                    int&                dimension
+                                )
 {
-if ( ( mapsin == 0 && StringIsEmpty ( filename ) )
-   || criteria == 0 )
-    return;
+double              samplingfrequencyin = EEGDoc->GetSamplingFrequency ();
 
+if ( samplingfrequencyin <= 0 )
+    return  false;
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // either use the provided maps, or load from file
-if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
+                                        // we can heavily downsample, targetting 125[Hz] but not lower
+                    downsampling        = AtLeast ( 1, Truncate ( samplingfrequencyin / targetsamplingfrequency ) );
 
+                    samplingfrequency   = samplingfrequencyin / downsampling;
 
-const TMaps*        tomapsin        = mapsin    ? mapsin
-                                                : new TMaps ( filename, session, AtomTypeScalar, ReferenceNone );
 
-double              samplingfrequencyin= tomapsin->GetSamplingFrequency ();
+int                 numel               = EEGDoc->GetNumElectrodes  ();
 
-if ( samplingfrequencyin <= 0 )
+                    nummaps             = EEGDoc->GetNumTimeFrames  () / downsampling;
+                    dimension           = numel - ( ignoretracks ? ignoretracks->NumSet ( 0, numel - 1 ) : 0 );
 
-    return;
 
-                                        // we can heavily downsample, targetting 125[Hz] but not lower
-int                 downsampling        = AtLeast ( 1, Truncate ( samplingfrequencyin / targetsamplingfrequency ) );
+return  nummaps > 0 && dimension > 0;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Reads the downsampled maps [mi1..mi2] of an opened file, storing them from index tomap
+                                        // Reading is done by blocks of complete groups of input time frames, as much as eegbuff can hold
+void    ReadBadEpochsMaps   (   TTracksDoc*         EEGDoc,
+                                int                 downsampling,
+                                AtomType            datatype,
+                                const TSelection*   ignoretracks,
+                                int                 mi1,                        int                 mi2,
+                                TTracks<float>&     eegbuff,
+                                TMaps&              maps,                       int                 tomap
+                            )
+{
+int                 numel               = EEGDoc->GetNumElectrodes  ();
+int                 blocknummaps        = AtLeast ( 1, eegbuff.GetDim2 () / downsampling );
+
+
+for ( int bmi1 = mi1; bmi1 <= mi2; bmi1 += blocknummaps ) {
+
+    int                 bmi2            = min ( bmi1 + blocknummaps - 1, mi2 );
+    int                 tf1             =   bmi1       * downsampling;
+    int                 tf2             = ( bmi2 + 1 ) * downsampling - 1;
 
-                    samplingfrequency   = samplingfrequencyin / downsampling;
 
-//DBGV4 ( samplingfrequencyin, BadEpochsTargetSampling, downsampling, samplingfrequency, "samplingfrequencyin, BadEpochsTargetSampling, downsampling, samplingfrequency" );
+    EEGDoc->GetTracks   (   tf1,        tf2, 
+                            eegbuff,    0,
+                            datatype,   
+                            NoPseudoTracks, 
+                            ReferenceNone
+                        );
+
+                                        // cumulating time frames in the same order as the in-memory downsampling, for the exact same results
+    OmpParallelFor
+
+    for ( int mi = bmi1; mi <= bmi2; mi++ ) {
+
+        TMap&               map             = maps[ tomap + mi - mi1 ];
+
+        map.ResetMemory ();
+
+        for ( int tf = mi * downsampling; tf < ( mi + 1 ) * downsampling; tf++ )
+        for ( int el0 = 0, el = 0; el < numel; el++ )
+
+            if ( ! ( ignoretracks && ignoretracks->IsSelected ( el ) ) )
+
+                map[ el0++ ]   += eegbuff ( el, tf - tf1 );
+
+                                        // average
+        map    /= downsampling;
+        }
+    }
+}
 
 
-TMaps               maps ( *tomapsin, downsampling );
+//----------------------------------------------------------------------------
+                                        // Downsampled maps are averages of consecutive groups of time frames, which can be done on any block of complete groups
+                                        // Results are identical to  TMaps ( TMaps ( filename ), downsampling, ignoretracks ), but without the 2 full resolution copies of the data
+bool    GetBadEpochsMaps    (   const TMaps*        mapsin,
+                                const char*         filename,                   int                 session,
+                                AtomType            datatype,
+                                const TSelection*   ignoretracks,
+                                double              targetsamplingfrequency,
+                                TMaps&              maps,
+                                double&             samplingfrequency
+                            )
+{
+maps.DeallocateMemory ();
 
+samplingfrequency   = 0;
 
-if ( mapsin == 0 )
-                                        // locally allocated - we can delete them now
-    delete  tomapsin;
+if ( mapsin == 0 && StringIsEmpty ( filename ) )
+    return  false;
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-int                 timemin             = 0;
-int                 timemax             = maps.GetNumMaps () - 1;
-int                 numtf               = timemax - timemin + 1;
-int                 numel               = maps.GetDimension ();
+if ( mapsin ) {
 
+    double              samplingfrequencyin = mapsin->GetSamplingFrequency ();
 
-int                 requiredtf          = MillisecondsToTimeFrame ( badduration, samplingfrequency ) + 3;
+    if ( samplingfrequencyin <= 0 )
+        return  false;
+
+                                        // we can heavily downsample, targetting 125[Hz] but not lower
+    int                 downsampling        = AtLeast ( 1, Truncate ( samplingfrequencyin / targetsamplingfrequency ) );
+
+                        samplingfrequency   = samplingfrequencyin / downsampling;
 
-if ( numtf < requiredtf )
-    return;
+
+    maps    = TMaps ( *mapsin, downsampling, ignoretracks );
+
+    return  maps.IsAllocated ();
+    }
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Time filtering
-if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
+                                        // streaming from file
+TOpenDoc<TTracksDoc>    EEGDoc ( filename, OpenDocHidden );
 
+if ( EEGDoc.IsNotOpen () )
+    return  false;
 
-FctParams           params;
+                                        // go to session, if relevant
+if ( IsInsideLimits ( session, 1, EEGDoc->GetNumSessions () ) )
+    EEGDoc->GoToSession ( session );
+
+
+int                 downsampling;
+int                 nummaps;
+int                 dimension;
+
+if ( ! GetBadEpochsDimensions ( EEGDoc, ignoretracks, targetsamplingfrequency, downsampling, samplingfrequency, nummaps, dimension ) )
+    return  false;
 
-                                        // Remove any DC, by safety, before any high-pass filtering
-maps.TimeCentering ();
+
+maps.Resize                 ( nummaps, dimension );
+maps.SetSamplingFrequency   ( samplingfrequency );
+
+
+TTracks<float>      EegBuff ( EEGDoc->GetNumElectrodes (), BadEpochsReadBlockSize * downsampling );
+
+ReadBadEpochsMaps   (   EEGDoc,     downsampling,   datatype,   ignoretracks,
+                        0,          nummaps - 1,
+                        EegBuff,
+                        maps,       0
+                    );
+
+
+return  true;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Whether the downsampled maps of a file are small enough to be processed all at once
+bool    IsBadEpochsInMemory (   const char*         filename,                   int                 session,
+                                const TSelection*   ignoretracks,
+                                double              targetsamplingfrequency
+                            )
+{
+TOpenDoc<TTracksDoc>    EEGDoc ( filename, OpenDocHidden );
+                                        // any error will be handled by the regular processing
+if ( EEGDoc.IsNotOpen () )
+    return  true;
+
+
+if ( IsInsideLimits ( session, 1, EEGDoc->GetNumSessions () ) )
+    EEGDoc->GoToSession ( session );
+
+
+int                 downsampling;
+double              samplingfrequency;
+int                 nummaps;
+int                 dimension;
+
+if ( ! GetBadEpochsDimensions ( EEGDoc, ignoretracks, targetsamplingfrequency, downsampling, samplingfrequency, nummaps, dimension ) )
+    return  true;
+
+
+return  (double) nummaps * dimension * sizeof ( TMapAtomType ) <= BadEpochsMaxMapsMemory;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Time filtering of the maps, which should have been centered beforehand
+void    FilterBadEpochsMaps (   TMaps&              maps,
+                                FilterTypes         filtertype,                 const double*       freqcut
+                            )
+{
+FctParams           params;
 
 
 if      ( filtertype == FilterTypeLowPass ) {
@@ -295,43 +427,22 @@ else {
     }
 
                                         // Here, we are sure to have a High-Pass above 1[Hz] (if any filter was required)
+}
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Pre-processing
-if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
-
-                                        // Force Average Reference before Z-Scoring - to avoid big slow waves in the data
-maps.AverageReference   ( AtomTypeScalar );
-
-                                        // Force each track to have the same SD / power
-maps.ZScore             ( ZScoreSigned_CenterScale );
-
-                                        // to be 100% correct - but not a lot of differences
-maps.AverageReference   ( AtomTypeScalar );
-
-
-#if defined(BadEpochsSaveSteps)
-
-bool                savepreproc     = false && StringIsNotEmpty ( filename );
-
-if ( savepreproc ) {
-
-    TFileName           fileproc ( filename, TFilenameNoPreprocessing );
-
-    RemoveExtension ( fileproc );
-    StringAppend    ( fileproc, ".PreProc1" );
-    AddExtension    ( fileproc, FILEEXT_EEGSEF );
-
-    maps.WriteFile   ( fileproc );
-    }
-#endif
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Allocate all tracks for all remaining processing
-for ( int beci = 0; beci < NumBadEpochsCriteria; beci++ )
 
-    criteria [ beci ].Resize ( numtf );
+//----------------------------------------------------------------------------
+                                        // Criteria of the time frames [fromtf..totf], for a file of numtf time frames
+                                        // maps can be only a block of the file, its first map being time frame offset,
+                                        // in which case it should have enough margin on each side for the auto-correlation windows
+void    ComputeBadEpochsMapsCriteria    (   const TMaps&        maps,                       int                 offset,
+                                            int                 fromtf,                     int                 totf,
+                                            int                 numtf,
+                                            double              samplingfrequency,
+                                            TVector<float>*     criteria,
+                                            TSuperGauge*        Gauge
+                                        )
+{
+int                 numel               = maps.GetDimension ();
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -346,12 +457,12 @@ double              madleft;
 double              madright;
 
 
-for ( int tfi = 0; tfi < numtf; tfi++ ) {
+for ( int tfi = fromtf; tfi <= totf; tfi++ ) {
 
     if ( Gauge )    Gauge->Actualize ();
 
                                         // stats on temporal standardized tracks
-    mapstat.Set ( maps[ tfi ], true );
+    mapstat.Set ( maps[ tfi - offset ], true );
 
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -390,7 +501,7 @@ for ( int tfi = 0; tfi < numtf; tfi++ ) {
 
     criteria[ BadEpochsVariance3 ] ( tfi )  = fabs ( mapstat.Max () ) - fabs ( mapstat.Min () );
 
-    criteria[ BadEpochsVariance4 ] ( tfi )  = mapstat.Sn ( 500 );
+    criteria[ BadEpochsVariance4 ] ( tfi )  = mapstat.Sn ();
 
     criteria[ BadEpochsVariance5 ] ( tfi )  = madleft - madright;
 
@@ -432,15 +543,15 @@ double              convl;
 //DBGV6 ( autocorrwind1, autocorrwind2, autocorrwind3, autocorrwind4, autocorrwind5, autocorrstep, "autocorrwind 1 to 5, autocorrstep" );
 
 
-for ( int tfi = 0; tfi < numtf; tfi++ ) {
+for ( int tfi = fromtf; tfi <= totf; tfi++ ) {
 
     if ( Gauge )    Gauge->Actualize ();
 
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // Min Correlation on a narrow interval: a highly decorrelated close neighbor (+-1 TF) is fishy
-    corr1   = maps ( tfi ).Correlation ( maps ( LeftMirroring  ( tfi, autocorrwindshort, numtf - 1 ) ) );
-    corr2   = maps ( tfi ).Correlation ( maps ( RightMirroring ( tfi, autocorrwindshort, numtf - 1 ) ) );
+    corr1   = maps ( tfi - offset ).Correlation ( maps ( LeftMirroring  ( tfi, autocorrwindshort, numtf - 1 ) - offset ) );
+    corr2   = maps ( tfi - offset ).Correlation ( maps ( RightMirroring ( tfi, autocorrwindshort, numtf - 1 ) - offset ) );
 
                                         // if ranking, we can skip the correction
     criteria[ BadEpochsAutoStepCorrelComp  ] ( tfi )  = PearsonToFisher ( max ( fabs ( corr1 ), fabs ( corr2 ) ) );
@@ -451,8 +562,8 @@ for ( int tfi = 0; tfi < numtf; tfi++ ) {
                                         // sum up all correlations within varying window sizes
     for ( int aci = 1; aci <= autocorrwind; aci += autocorrstep ) {
 
-        corr1   = maps ( tfi ).Correlation ( maps ( LeftMirroring  ( tfi, aci, numtf - 1 ) ) );
-        corr2   = maps ( tfi ).Correlation ( maps ( RightMirroring ( tfi, aci, numtf - 1 ) ) );
+        corr1   = maps ( tfi - offset ).Correlation ( maps ( LeftMirroring  ( tfi, aci, numtf - 1 ) - offset ) );
+        corr2   = maps ( tfi - offset ).Correlation ( maps ( RightMirroring ( tfi, aci, numtf - 1 ) - offset ) );
 
                                         // deskew data
         corrl   = PearsonToFisher ( fabs ( corr1 ) ) 
@@ -460,8 +571,8 @@ for ( int tfi = 0; tfi < numtf; tfi++ ) {
 
                                         // Note: in term of time scales, BadEpochsAutoConvol1 ~= BadEpochsAutoCorrel2, Convolution is 2 times "broader"
                                         // Use both a different summation and a different Correlation formula
-        convl   = PearsonToFisher ( fabs (                       maps ( LeftMirroring  ( tfi, aci, numtf - 1 ) ).
-                                           CorrelationSpearman ( maps ( RightMirroring ( tfi, aci, numtf - 1 ) ), true ) ) );
+        convl   = PearsonToFisher ( fabs (                       maps ( LeftMirroring  ( tfi, aci, numtf - 1 ) - offset ).
+                                           CorrelationSpearman ( maps ( RightMirroring ( tfi, aci, numtf - 1 ) - offset ), true ) ) );
 
 
                                         // this sequence of tests allows to skip the other tests (shorter windows)
@@ -479,23 +590,340 @@ for ( int tfi = 0; tfi < numtf; tfi++ ) {
         criteria[ BadEpochsAutoConvol1 ] ( tfi )  += convl;
         }
 
+                                        // averaging more makes more smoothing, dividing by sqrt(interval) instead of interval looks more comparable in absolute
+    criteria[ BadEpochsAutoCorrel1 ] ( tfi )   /= sqrt ( (double) autocorrwind1 );
+    criteria[ BadEpochsAutoCorrel2 ] ( tfi )   /= sqrt ( (double) autocorrwind2 );
+    criteria[ BadEpochsAutoCorrel3 ] ( tfi )   /= sqrt ( (double) autocorrwind3 );
+    criteria[ BadEpochsAutoConvol1 ] ( tfi )   /= sqrt ( (double) autocorrwind1 );
+    criteria[ BadEpochsAutoConvol2 ] ( tfi )   /= sqrt ( (double) autocorrwind2 );
+    criteria[ BadEpochsAutoConvol3 ] ( tfi )   /= sqrt ( (double) autocorrwind3 );
+
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
     } // for tf
 
-                                        // averaging more makes more smoothing, dividing by sqrt(interval) instead of interval looks more comparable in absolute
-criteria[ BadEpochsAutoCorrel1 ]   /= sqrt ( (double) autocorrwind1 );
-criteria[ BadEpochsAutoCorrel2 ]   /= sqrt ( (double) autocorrwind2 );
-criteria[ BadEpochsAutoCorrel3 ]   /= sqrt ( (double) autocorrwind3 );
-criteria[ BadEpochsAutoConvol1 ]   /= sqrt ( (double) autocorrwind1 );
-criteria[ BadEpochsAutoConvol2 ]   /= sqrt ( (double) autocorrwind2 );
-criteria[ BadEpochsAutoConvol3 ]   /= sqrt ( (double) autocorrwind3 );
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Criteria computed on the whole downsampled maps at once
+bool    ComputeBadEpochsCriteriaInMemory(   const TMaps*        mapsin,
+                                            const char*         filename,                   int                 session,
+                                            AtomType            datatype,
+                                            const TSelection*   ignoretracks,
+                                            double              targetsamplingfrequency,
+                                            FilterTypes         filtertype,                 const double*       freqcut,
+                                            double              badduration,
+                                            TVector<float>*     criteria,
+                                            double&             samplingfrequency,
+                                            TSuperGauge*        Gauge
+                                        )
+{
+                                        // either use the provided maps, or load from file
+if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
+
+
+TMaps               maps;
+
+if ( ! GetBadEpochsMaps (   mapsin,
+                            filename,                   session,
+                            datatype,
+                            ignoretracks,
+                            targetsamplingfrequency,
+                            maps,
+                            samplingfrequency
+                        ) )
+    return  false;
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-maps.DeallocateMemory ();
+int                 timemin             = 0;
+int                 timemax             = maps.GetNumMaps () - 1;
+int                 numtf               = timemax - timemin + 1;
+
+
+int                 requiredtf          = MillisecondsToTimeFrame ( badduration, samplingfrequency ) + 3;
+
+if ( numtf < requiredtf )
+    return  false;
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Time filtering
+if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
+
+                                        // Remove any DC, by safety, before any high-pass filtering
+maps.TimeCentering ();
+
+
+FilterBadEpochsMaps ( maps, filtertype, freqcut );
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Pre-processing
+if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
+
+                                        // Force Average Reference before Z-Scoring - to avoid big slow waves in the data
+maps.AverageReference   ( AtomTypeScalar );
+
+                                        // Force each track to have the same SD / power
+maps.ZScore             ( ZScoreSigned_CenterScale );
+
+                                        // to be 100% correct - but not a lot of differences
+maps.AverageReference   ( AtomTypeScalar );
+
+
+#if defined(BadEpochsSaveSteps)
+
+bool                savepreproc     = false && StringIsNotEmpty ( filename );
+
+if ( savepreproc ) {
+
+    TFileName           fileproc ( filename, TFilenameNoPreprocessing );
+
+    RemoveExtension ( fileproc );
+    StringAppend    ( fileproc, ".PreProc1" );
+    AddExtension    ( fileproc, FILEEXT_EEGSEF );
+
+    maps.WriteFile   ( fileproc );
+    }
+#endif
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Allocate all tracks for all remaining processing
+for ( int beci = 0; beci < NumBadEpochsCriteria; beci++ )
+
+    criteria [ beci ].Resize ( numtf );
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ComputeBadEpochsMapsCriteria    (   maps,                       0,
+                                    0,                          numtf - 1,
+                                    numtf,
+                                    samplingfrequency,
+                                    criteria,
+                                    Gauge
+                                );
+
+
+return  true;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Criteria computed by overlapping blocks, for files too big to be processed at once
+                                        // Each block is read with some margin on each side, so that the filters have warmed-up and the auto-correlation windows are complete
+                                        // Tracks centering is computed on the whole file, while the Z-Score factors are estimated on maps regularly picked across the whole file
+                                        // Results are therefore very close, but not identical, to the in-memory processing
+bool    ComputeBadEpochsCriteriaBlocks  (   const char*         filename,                   int                 session,
+                                            AtomType            datatype,
+                                            const TSelection*   ignoretracks,
+                                            double              targetsamplingfrequency,
+                                            FilterTypes         filtertype,                 const double*       freqcut,
+                                            double              badduration,
+                                            TVector<float>*     criteria,
+                                            double&             samplingfrequency,
+                                            TSuperGauge*        Gauge
+                                        )
+{
+if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
+
+
+TOpenDoc<TTracksDoc>    EEGDoc ( filename, OpenDocHidden );
+
+if ( EEGDoc.IsNotOpen () )
+    return  false;
+
+                                        // go to session, if relevant
+if ( IsInsideLimits ( session, 1, EEGDoc->GetNumSessions () ) )
+    EEGDoc->GoToSession ( session );
+
+
+int                 downsampling;
+int                 numtf;
+int                 numel;
+
+if ( ! GetBadEpochsDimensions ( EEGDoc, ignoretracks, targetsamplingfrequency, downsampling, samplingfrequency, numtf, numel ) )
+    return  false;
+
+
+int                 requiredtf          = MillisecondsToTimeFrame ( badduration, samplingfrequency ) + 3;
+
+if ( numtf < requiredtf )
+    return  false;
+
+
+int                 blocksize           = BadEpochsStreamBlockSize;
+                                        // margin has to be at least the biggest auto-correlation window
+int                 margin              = max ( Round ( MillisecondsToTimeFrame ( AutoCorrWindowSize3,  samplingfrequency ) ),
+                                                Round ( MillisecondsToTimeFrame ( BadEpochsBlockMargin, samplingfrequency ) ) );
+TTracks<float>      EegBuff ( EEGDoc->GetNumElectrodes (), BadEpochsReadBlockSize * downsampling );
+TMaps               blockmaps;
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Tracks means on the whole file, to remove any DC, by safety, before any high-pass filtering
+TVector<double>     means ( numel );
+
+
+for ( int btf1 = 0; btf1 < numtf; btf1 += blocksize ) {
+
+    if ( Gauge )    Gauge->Actualize ();
+
+    int                 btf2            = min ( btf1 + blocksize, numtf ) - 1;
+
+    if ( blockmaps.GetNumMaps () != btf2 - btf1 + 1 )
+        blockmaps.Resize ( btf2 - btf1 + 1, numel );
+
+
+    ReadBadEpochsMaps   (   EEGDoc,     downsampling,   datatype,   ignoretracks,
+                            btf1,       btf2,
+                            EegBuff,
+                            blockmaps,  0
+                        );
+
+
+    for ( int tf = 0; tf < blockmaps.GetNumMaps (); tf++ )
+    for ( int e  = 0; e  < numel;                   e++  )
+
+        means[ e ] += blockmaps ( tf, e );
+    }
+
+
+means  /= numtf;
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // First pass estimates the Z-Score factors, second pass computes the criteria
+int                 numsamples          = min ( numtf, BadEpochsZScoreNumSamples );
+TMaps               zsamples ( numsamples, numel );
+TArray2<float>      zscorevalues;
+
+
+for ( int pass = 0; pass < 2; pass++ ) {
+
+    if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
+
+
+    for ( int btf1 = 0, si = 0; btf1 < numtf; btf1 += blocksize ) {
+
+        if ( Gauge )    Gauge->Actualize ();
+
+                                        // kept part of the block
+        int                 btf2            = min ( btf1 + blocksize, numtf ) - 1;
+                                        // read part of the block, with margins
+        int                 tf1             = max ( btf1 - margin, 0         );
+        int                 tf2             = min ( btf2 + margin, numtf - 1 );
+
+        if ( blockmaps.GetNumMaps () != tf2 - tf1 + 1 )
+            blockmaps.Resize ( tf2 - tf1 + 1, numel );
+
+        blockmaps.SetSamplingFrequency ( samplingfrequency );
+
+
+        ReadBadEpochsMaps   (   EEGDoc,     downsampling,   datatype,   ignoretracks,
+                                tf1,        tf2,
+                                EegBuff,
+                                blockmaps,  0
+                            );
+
+                                        // same processing as in memory
+        OmpParallelFor
+
+        for ( int tf = 0; tf < blockmaps.GetNumMaps (); tf++ )
+        for ( int e  = 0; e  < numel;                   e++  )
+
+            blockmaps ( tf, e )    -= means[ e ];
+
+
+        FilterBadEpochsMaps ( blockmaps, filtertype, freqcut );
+
+                                        // Force Average Reference before Z-Scoring - to avoid big slow waves in the data
+        blockmaps.AverageReference   ( AtomTypeScalar );
+
+
+        if ( pass == 0 ) {
+                                        // picking the samples which belong to the kept part
+            for ( ; si < numsamples; si++ ) {
+
+                int         tf          = Truncate ( (double) si / numsamples * numtf );
+
+                if ( tf > btf2 )
+                    break;
+
+                zsamples[ si ]  = blockmaps[ tf - tf1 ];
+                }
+
+            continue;
+            }
+
+                                        // Force each track to have the same SD / power
+        blockmaps.ApplyZScore        ( ZScoreSigned_CenterScale, zscorevalues );
+                                        // to be 100% correct - but not a lot of differences
+        blockmaps.AverageReference   ( AtomTypeScalar );
+
+
+        ComputeBadEpochsMapsCriteria    (   blockmaps,                  tf1,
+                                            btf1,                       btf2,
+                                            numtf,
+                                            samplingfrequency,
+                                            criteria,
+                                            Gauge
+                                        );
+        } // for block
+
+
+    if ( pass == 0 ) {
+
+        zsamples.ComputeZScore ( ZScoreSigned_CenterScale, zscorevalues );
+
+        zsamples.DeallocateMemory ();
+
+                                        // Allocate all tracks for all remaining processing
+        for ( int beci = 0; beci < NumBadEpochsCriteria; beci++ )
+
+            criteria [ beci ].Resize ( numtf );
+        }
+    } // for pass
+
+
+return  true;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Maps to criteria
+void    ComputeBadEpochsCriteria    (   const TMaps*        mapsin,
+                                        const char*         filename,                   int                 session,
+                                        AtomType            datatype,
+                                        const TSelection*   ignoretracks,
+                                        double              targetsamplingfrequency,
+                                        FilterTypes         filtertype,                 const double*       freqcut,
+                                        double              badduration,
+                                        TVector<float>*     criteria,
+                                        double&             samplingfrequency,
+                                        TSuperGauge*        Gauge,
+                                        TVector<float>*     rawcriteria
+                                    )
+{
+if ( ( mapsin == 0 && StringIsEmpty ( filename ) )
+   || criteria == 0 )
+    return;
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Files too big to be downsampled at once are processed by overlapping blocks
+bool                streaming           = mapsin == 0 && ! IsBadEpochsInMemory ( filename, session, ignoretracks, targetsamplingfrequency );
+
+bool                criteriaok          = streaming ? ComputeBadEpochsCriteriaBlocks    (           filename,   session,    datatype,   ignoretracks,   targetsamplingfrequency,    filtertype, freqcut,    badduration,    criteria,   samplingfrequency,  Gauge )
+                                                    : ComputeBadEpochsCriteriaInMemory  (   mapsin, filename,   session,    datatype,   ignoretracks,   targetsamplingfrequency,    filtertype, freqcut,    badduration,    criteria,   samplingfrequency,  Gauge );
+
+if ( ! criteriaok )
+    return;
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -684,33 +1112,24 @@ if ( Gauge )    Gauge->Next ( -1, SuperGaugeUpdateTitle );
 bool                isesi               = IsExtensionAmong ( filename, AllRisFilesExt );
 
 AtomType            datatype            = isesi ? AtomTypePositive : AtomTypeScalar;
-                                                                                       // no ref for ESI
-ReferenceType       dataref             = ReferenceNone; // GetProcessingRef ( isesi ? ProcessingReferenceESI : ProcessingReferenceNone );
-
-const TMaps*        tomapsin            = mapsin    ? mapsin
-                                                    : new TMaps ( filename, session, datatype, dataref );
-
-double              samplingfrequencyin= tomapsin->GetSamplingFrequency ();
-
-if ( samplingfrequencyin <= 0 )
-
+                                        // data are read with no reference, including for ESI - GetProcessingRef ( isesi ? ProcessingReferenceESI : ProcessingReferenceNone )
+
+                                        // Files too big to be downsampled at once are streamed by blocks for each band, otherwise downsampling is done once for all
+bool                streaming           = mapsin == 0 && ! IsBadEpochsInMemory ( filename, session, ignoretracks, targetsamplingfrequency );
+
+TMaps               maps;
+
+if ( ! streaming
+  && ! GetBadEpochsMaps (   mapsin,
+                            filename,                   session,
+                            datatype,
+                            ignoretracks,
+                            targetsamplingfrequency,
+                            maps,
+                            samplingfrequency
+                        ) )
     return;
 
-                                        // we can heavily downsample, targetting 125[Hz] but not lower
-int                 downsampling        = AtLeast ( 1, Truncate ( samplingfrequencyin / targetsamplingfrequency ) );
-
-                    samplingfrequency   = samplingfrequencyin / downsampling;
-
-//DBGV4 ( samplingfrequencyin, BadEpochsTargetSampling, downsampling, samplingfrequency, "samplingfrequencyin, BadEpochsTargetSampling, downsampling, samplingfrequency" );
-
-
-TMaps               maps ( *tomapsin, downsampling, ignoretracks );
-
-
-if ( mapsin == 0 )
-                                        // locally allocated - we can delete them now
-    delete  tomapsin;
-
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // currently 2 bands
@@ -728,9 +1147,11 @@ TVector<float>      criteriab [ NumBadEpochsCriteria ];
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // First frequency band
-ComputeBadEpochsCriteria    (   &maps,
-                                0,                          0,
-                                targetsamplingfrequency,                    // downsampling done once for all
+ComputeBadEpochsCriteria    (   streaming ? 0        : &maps,
+                                streaming ? filename : 0,   session,
+                                datatype,
+                                streaming ? ignoretracks : 0,               // maps have these tracks already removed
+                                targetsamplingfrequency,
                                 filtertype1,                &filtercut1,    // first filter
                                 badduration,
                                 criteriab,
@@ -746,9 +1167,11 @@ for ( int beci = MinCriteriaTracks; beci <= MaxCriteriaTracks; beci++ )
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // Second frequency band
-ComputeBadEpochsCriteria    (   &maps,
-                                0,                          0,
-                                targetsamplingfrequency,                    // downsampling done once for all
+ComputeBadEpochsCriteria    (   streaming ? 0        : &maps,
+                                streaming ? filename : 0,   session,
+                                datatype,
+                                streaming ? ignoretracks : 0,               // maps have these tracks already removed
+                                targetsamplingfrequency,
                                 filtertype2,                &filtercut2,    // second filter
                                 badduration,
                                 criteriab,
@@ -40,6 +40,15 @@ constexpr double    BadEpochsToleranceDefault       = BadEpochsToleranceStrict;
 
                                         // We don't need much smapling frequency than that - plus it speeds up things a lot...
 constexpr double    BadEpochsTargetSampling         = 125.0;
+                                        // Files are read and downsampled by blocks of that many downsampled time frames, so that the full resolution data are never loaded at once
+constexpr int       BadEpochsReadBlockSize          = 4096;
+                                        // Files with downsampled maps bigger than that are processed by overlapping blocks of downsampled time frames, instead of all at once
+constexpr double    BadEpochsMaxMapsMemory          = 1.0 * GigaByte;
+constexpr int       BadEpochsStreamBlockSize        = 16384;
+                                        // margin on each side of these blocks, for the filters to warm-up [ms]
+constexpr double    BadEpochsBlockMargin            = 10000.0;
+                                        // number of maps regularly picked across the whole file to estimate the Z-Score factors of these blocks
+constexpr int       BadEpochsZScoreNumSamples       = 20000;
 
                                         // filtering duration / scaling for specific processing - between 500..1000
 constexpr double    BadEpochsBadDuration            = 600.0;
@@ -72,6 +81,17 @@ constexpr FilterTypes FilterTypeAuto                = (FilterTypes) -1;
 constexpr int           ComputeCriteriaGaugeCount   = 5;
 
 
+                                        // Either downsampling the given maps, or streaming a file by blocks while downsampling
+bool    GetBadEpochsMaps                (   const TMaps*        mapsin,
+                                            const char*         filename,                   int                 session,
+                                            AtomType            datatype,
+                                            const TSelection*   ignoretracks,
+                                            double              targetsamplingfrequency,
+                                            TMaps&              maps,
+                                            double&             samplingfrequency
+                                        );
+
+
 enum        BadEpochsCriteriaEnum
             {
                                         // Levels / Variances criteria
@@ -135,6 +155,8 @@ enum        BadEpochsCriteriaEnum
 
 void    ComputeBadEpochsCriteria        (   const TMaps*        mapsin,
                                             const char*         filename,                   int                 session,
+                                            AtomType            datatype,
+                                            const TSelection*   ignoretracks,
                                             double              targetsamplingfrequency,
                                             FilterTypes         filtertype,                 const double*       freqcut,
                                             double              badduration,
@@ -192,6 +192,65 @@ if ( Gauge.IsAlive () )     Gauge.HappyEnd ();
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Same processing as ComputeCentroidFiles, each TMaps playing the role of a file
+void    ComputeCentroidMaps     (   const TGoMaps&      gomaps,             ComputeCentroidEnum     layout,
+                                    CentroidType        centroidflag,
+                                    AtomType            datatype,
+                                    PolarityType        polarity,
+                                    ReferenceType       processingref,
+                                    bool                ranking,
+                                    bool                thresholding,       double                  threshold,
+                                    bool                normalize,
+                                    TMaps&              mapscentroid
+                                )
+{
+mapscentroid.DeallocateMemory ();
+
+if ( gomaps.IsNotAllocated () )
+    return;
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+TMaps               mapsin;
+
+
+for ( int i = 0; i < gomaps.NumGroups (); i++ ) {
+                                        // working on a copy, as the processing below is destructive
+    if ( layout == AllFilesOneCentroid )        mapsin.Set  ( &gomaps );        // concatenating all maps at once
+    else /*OneFileOneCentroid*/                 mapsin      = gomaps[ i ];
+
+
+    ProcessResults  (   mapsin,         datatype,   processingref,
+                        ranking, 
+                        thresholding,   threshold, 
+                        normalize 
+                    );
+
+                                        // compute 1 centroid, add to current structure - note that centroid has not been normalized
+    mapscentroid.Add ( mapsin.ComputeCentroid ( centroidflag, datatype, polarity ) );
+
+                                        // done all maps at once
+    if ( layout == AllFilesOneCentroid )    break;
+    } // for i
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Postprocess templates similarly to the intermediate options
+ProcessResults  (   mapscentroid,   datatype,   processingref,
+                    ranking, 
+                    thresholding,   threshold, 
+                    normalize 
+                );
+
+                                        // For the aesthetic, reorder the polarities
+if ( polarity != PolarityDirect )
+
+    mapscentroid.AlignSuccessivePolarities ();
+}
+
+
 //----------------------------------------------------------------------------
                                         // Computing + auto saving to file
 void    ComputeCentroidFiles    (   const TGoF&         gof,                ComputeCentroidEnum     layout,
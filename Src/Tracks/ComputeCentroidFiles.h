@@ -30,6 +30,7 @@ enum        CentroidType;
 enum        PolarityType;
 enum        SpatialFilterType;
 class       TMaps;
+class       TGoMaps;
 class       TGoF;
 
 
@@ -81,6 +82,18 @@ void    ComputeCentroidFiles    (   const TGoF&         gof,                Comp
                                     bool                showprogress    = false
                                 );
 
+                                        // Same as above, but from data already in memory - no files nor progress bar involved, so it can be called from any thread
+void    ComputeCentroidMaps     (   const TGoMaps&      gomaps,             ComputeCentroidEnum     layout,
+                                    CentroidType        centroidflag,
+                                    AtomType            datatype,
+                                    PolarityType        polarity,
+                                    ReferenceType       processingref,
+                                    bool                ranking,
+                                    bool                thresholding,       double                  threshold,
+                                    bool                normalize,
+                                    TMaps&              mapscentroid
+                                );
+
 
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include    "CorrelateFiles.h"
 
+#include    "System.h"
 #include    "Files.TGoF.h"
 #include    "Files.ReadFromHeader.h"
 
@@ -24,6 +25,8 @@ limitations under the License.
 #pragma     hdrstop
 //-=-=-=-=-=-=-=-=-
 
+using namespace std;
+
 namespace crtl {
 
 //----------------------------------------------------------------------------
@@ -212,6 +215,42 @@ int                 numfreq1;
 bool                doingrand       = numrand > 0 && correlate == CorrelateTypePhaseIntCoupling;
 
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Each file of the second group is read & preprocessed the same way for all the files of the first group,
+                                        // so keep them in memory after their first reading, up to a given amount of memory
+                                        // Phase-intensity coupling reads single tracks with their names, and is not cached
+int                 numfiles2       = (int) filenames2;
+int                 numsub2         = correlate == CorrelateTypeTimeCorrelation && allfreq2 ? AtLeast ( 1, fc2.NumFreqs ) : 1;
+bool                cachingj        = (int) filenames1 > 1
+                                   && (    correlate == CorrelateTypeSpatialCorrelation
+                                        || correlate == CorrelateTypeTimeCorrelation    );
+double              cachemaxmemory  = cachingj ? GetAvailableMemory () * CorrelateFilesMemoryRatio : 0;
+double              cachememory     = 0;
+vector<TMaps>       cachej          ( cachingj ? numfiles2 * numsub2 : 0 );
+vector<bool>        cachedj         ( cachingj ? numfiles2 * numsub2 : 0, false );
+TMaps*              tomapsj;
+
+auto                IsCachedj       = [ & ] ( int cachei )
+{
+return  cachingj && cachei < (int) cachedj.size () && cachedj[ cachei ];
+};
+                                        // keep a copy of the freshly read mapsj, if there is still room for it
+auto                CacheMapsj      = [ & ] ( int cachei )
+{
+if ( ! cachingj || cachei >= (int) cachedj.size () )
+    return;
+
+double              mapsmemory      = (double) mapsj.GetNumMaps () * mapsj.GetDimension () * sizeof ( TMapAtomType );
+
+if ( cachememory + mapsmemory > cachemaxmemory )
+    return;
+
+cachej [ cachei ]   = mapsj;
+cachedj[ cachei ]   = true;
+cachememory        += mapsmemory;
+};
+
+
                                         // repeat the whole thing twice, one with and one without randomization
                                         // saving the correlation on the first pass, the probabilities on the second one
 for ( int somerand = 0; somerand < ( doingrand ? 2 : 1 ); somerand++ )
@@ -274,23 +313,34 @@ for ( int i = 0; i < (int) filenames1; i++ ) {
                 Cartool.CartoolApplication->SetMainTitle ( corrtitle, filenames2[ j ], *gauge );
                 }
 
+
+            if ( IsCachedj ( j ) )
+
+                tomapsj     = &cachej[ j ];
+
+            else {
                                         // Read & preprocess data
-            mapsj.ReadFile ( filenames2[ j ], 0, datatype2, ReferenceNone,
-                             0, 0,
-                             dim1goes2, dim2goes2, dim3goes2 );
+                mapsj.ReadFile ( filenames2[ j ], 0, datatype2, ReferenceNone,
+                                 0, 0,
+                                 dim1goes2, dim2goes2, dim3goes2 );
 
 
-            processingref2  = GetProcessingRef ( allris2 ? ProcessingReferenceESI : ProcessingReferenceEEG );
+                processingref2  = GetProcessingRef ( allris2 ? ProcessingReferenceESI : ProcessingReferenceEEG );
 
                                         // !works only on non-transposed data - we can add a parameter if needed!
-            if ( spatialfilter2 )   mapsj.FilterSpatial ( SpatialFilterDefault, xyzfile );
+                if ( spatialfilter2 )   mapsj.FilterSpatial ( SpatialFilterDefault, xyzfile );
+
 
+                mapsj.SetReference ( processingref2, AtomTypeScalar );
 
-            mapsj.SetReference ( processingref2, AtomTypeScalar );
 
+                CacheMapsj ( j );
+
+                tomapsj     = &mapsj;
+                }
 
 
-            mapsr.Correlate (   mapsi, mapsj, /*CorrelateTypeAuto*/ CorrelateTypeLinearLinear, 
+            mapsr.Correlate (   mapsi, *tomapsj, /*CorrelateTypeAuto*/ CorrelateTypeLinearLinear, 
                                 polarity, ReferenceNone /*processingref*/, 
                                 0, 0, 
                                 corrinfix 
@@ -347,14 +397,28 @@ for ( int i = 0; i < (int) filenames1; i++ ) {
                     Cartool.CartoolApplication->SetMainTitle ( corrtitle, filenames2[ j ], *gauge );
                     }
 
+
+                int                 cachei          = freqi < numsub2 ? j * numsub2 + freqi : INT_MAX;
+
+                if ( IsCachedj ( cachei ) )
+
+                    tomapsj     = &cachej[ cachei ];
+
+                else {
                                         // Read & preprocess data
-                mapsj.ReadFile ( filenames2[ j ], 0, datatype2, ReferenceNone,
-                                 0, 0,
-                                 dim1goes2, dim2goes2, dim3goes2,
-                                 cliptf );
+                    mapsj.ReadFile ( filenames2[ j ], 0, datatype2, ReferenceNone,
+                                     0, 0,
+                                     dim1goes2, dim2goes2, dim3goes2,
+                                     cliptf );
+
+
+                    CacheMapsj ( cachei );
+
+                    tomapsj     = &mapsj;
+                    }
 
 
-                mapsr.Correlate (   mapsi, mapsj, CorrelateTypeAuto, 
+                mapsr.Correlate (   mapsi, *tomapsj, CorrelateTypeAuto, 
                                     polarity, processingref, 
                                     0, 0, 
                                     corrinfix 
@@ -29,6 +29,10 @@ enum        CorrelateFilesGaugeEnum
             };
 
 
+                                        // Max fraction of the available memory used to keep the second group of files in memory
+constexpr double    CorrelateFilesMemoryRatio   = 0.50;
+
+
 enum        CorrelateType;
 class       TGoF;
 class       TSuperGauge;
@@ -37,13 +37,14 @@ namespace crtl {
 //----------------------------------------------------------------------------
                                         // !Doesn't test for files consistencies, this should be done by the caller!
 void    BatchAveragingScalar    (   const TGoF& gof,
-                                    char*       meanfile,       char*       sdfile,         char*       snrfile,
-                                    char*       medianfile,     char*       madfile,
+                                    char*       meanfile,       char*       sdfile,         char*       sefile,
+                                    char*       snrfile,        char*       medianfile,     char*       madfile,
                                     ExecFlags   execflags
                                 )
 {
 ClearString ( meanfile   );
 ClearString ( sdfile     );
+ClearString ( sefile     );
 ClearString ( snrfile    );
 ClearString ( medianfile );
 ClearString ( madfile    );
@@ -52,7 +53,7 @@ if ( gof.IsEmpty () )
     return;
 
                                         // !Type(s) of output is controlled by the pointers being null or not!
-if ( ! ( meanfile || sdfile || snrfile || medianfile || madfile ) )
+if ( ! ( meanfile || sdfile || sefile || snrfile || medianfile || madfile ) )
     return;
                                         
                                         // This can be improved to allow computing and saving only SD f.ex.
@@ -80,6 +81,7 @@ if ( StringIsEmpty ( commonstart ) )
 
 TFileName           filemean;
 TFileName           filesd;
+TFileName           filese;
 TFileName           filesnr;
 TFileName           filemedian;
 TFileName           filemad;
@@ -90,6 +92,7 @@ StringCopy          ( fileext,      IsExtensionAmong ( gof[ 0 ], AllRisFilesExt
 
 StringCopy          ( filemean,     commondir, "\\", commonstart, commonend, "." InfixMean   " ", IntegerToString ( (int) gof ), ".", fileext );
 StringCopy          ( filesd,       commondir, "\\", commonstart, commonend, "." InfixSD     " ", IntegerToString ( (int) gof ), ".", fileext );
+StringCopy          ( filese,       commondir, "\\", commonstart, commonend, "." InfixSE     " ", IntegerToString ( (int) gof ), ".", fileext );
 StringCopy          ( filesnr,      commondir, "\\", commonstart, commonend, "." InfixSNR    " ", IntegerToString ( (int) gof ), ".", fileext );
 StringCopy          ( filemedian,   commondir, "\\", commonstart, commonend, "." InfixMedian " ", IntegerToString ( (int) gof ), ".", fileext );
 StringCopy          ( filemad,      commondir, "\\", commonstart, commonend, "." InfixMad    " ", IntegerToString ( (int) gof ), ".", fileext );
@@ -99,6 +102,7 @@ if ( IsOverwrite ( execflags ) ) {
 
     CheckNoOverwrite    ( filemean   );
     CheckNoOverwrite    ( filesd     );
+    CheckNoOverwrite    ( filese     );
     CheckNoOverwrite    ( filesnr    );
     CheckNoOverwrite    ( filemedian );
     CheckNoOverwrite    ( filemad    );
@@ -127,21 +131,23 @@ int                 numtf               = eegdoc->GetNumTimeFrames ();
 int                 lineardim           = numtracks * numtf;
 
                                         
-bool                nonrobust       = meanfile   || sdfile || snrfile;
+bool                nonrobust       = meanfile   || sdfile || sefile || snrfile;
 bool                robust          = medianfile || madfile;
-TTracks<float>      eegbuff;
-TTracks<float>      sum;
-TTracks<float>      sum2;
-TTracks<float>      snr;
+TTracks<float>      eegbuff[ 2 ];       // double reading buffer, one being read while the other is cumulated - first one is then reused for the SNR output
+bool                readok [ 2 ]    = { false, false };
+TTracks<double>     runmean;            // running mean and sum of squared deviations, updated one file at a time (Welford) - then used for the Mean and SD outputs
+TTracks<double>     runm2;
+bool                runsd           = sdfile || sefile || snrfile;
+int                 numread         = 0;
 TGoEasyStats        stat;
 
 
-                    eegbuff .Resize ( numtracks, numtf );
-                                        // there is some potential duplicate allocations, but it is kepts as is for the sake of easier computation
+                    eegbuff[ 0 ].Resize ( numtracks, numtf );
+                    eegbuff[ 1 ].Resize ( numtracks, numtf );
+
 if ( nonrobust ) {
-                    sum     .Resize ( numtracks, numtf );
-    if ( sdfile )   sum2    .Resize ( numtracks, numtf );
-    if ( snrfile )  snr     .Resize ( numtracks, numtf );
+                    runmean .Resize ( numtracks, numtf );
+    if ( runsd  )   runm2   .Resize ( numtracks, numtf );
     }
 
 if ( robust )                           // this will be a lot...
@@ -163,90 +169,107 @@ expfile.SetAtomType ( AtomTypeScalar );
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Reading and cumulating are overlapped: while the main thread opens and reads file eegi,
+                                        // the other threads cumulate file eegi - 1 from the other buffer. Documents can only be opened from the main thread,
+                                        // which joins the cumulation once its reading is done. Files are still cumulated in order, hence the same results.
+                                        // One more loop is done to cumulate the last file.
+for ( int eegi = 0; eegi <= (int) gof; eegi++ ) {
 
-for ( int eegi = 0; eegi < (int) gof; eegi++ ) {
+    int                 readi           =   eegi       % 2;
+    int                 cumuli          = ( eegi + 1 ) % 2;
+    bool                cumulate        = eegi > 0 && readok[ cumuli ];
 
-    if ( Gauge.IsAlive () )
-        Gauge.Next ( 0 );
+    if ( cumulate )
+        numread++;
+                                        // single pass update of mean and squared deviations, which does not suffer
+                                        // from the cancellation of sum2 - sum^2 / n when the mean is large compared to the SD
+    double              invn            = 1.0 / AtLeast ( 1, numread );
 
 
-    if ( ! eegdoc.Open ( gof[ eegi ], OpenDocHidden ) )
-        continue;
+    OmpParallelBegin
 
-        
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // try to recover the sampling frequency on each file
-    if ( expfile.SamplingFrequency == 0 && eegdoc->GetSamplingFrequency () > 0 )
+    if ( IsMainThread () && eegi < (int) gof ) {
 
-        expfile.SamplingFrequency   = eegdoc->GetSamplingFrequency ();
+        readok[ readi ] = false;
 
+        if ( Gauge.IsAlive () )
+            Gauge.Next ( 0 );
+
+
+        if ( eegdoc.Open ( gof[ eegi ], OpenDocHidden ) ) {
+                                        // try to recover the sampling frequency on each file
+            if ( expfile.SamplingFrequency == 0 && eegdoc->GetSamplingFrequency () > 0 )
+
+                expfile.SamplingFrequency   = eegdoc->GetSamplingFrequency ();
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // get whole data set
-    eegdoc->ReadRawTracks ( 0, numtf - 1, eegbuff );
+            eegdoc->ReadRawTracks ( 0, numtf - 1, eegbuff[ readi ] );
 
+            eegdoc.Close ();
 
-    if ( robust ) {
+            readok[ readi ] = true;
+            }
+        }
 
-        OmpParallelFor
+
+    if ( cumulate ) {
+
+        const TTracks<float>&   data    = eegbuff[ cumuli ];
+
+        OmpForDynamic
 
         for ( int e  = 0; e  < numtracks; e++  )
-        for ( int tf = 0; tf < numtf;     tf++ )
+        for ( int tf = 0; tf < numtf;     tf++ ) {
 
-            stat[ e * numtf + tf ].Add ( eegbuff ( e, tf ) );
-        }
+            double          x               = data ( e, tf );
 
+            if ( robust )
 
-    if ( nonrobust ) {
+                stat[ e * numtf + tf ].Add ( x );
 
-        OmpParallelFor
 
-        for ( int i = 0; i < lineardim; i++ ) {
+            if ( nonrobust ) {
 
-            sum.GetValue ( i )     += eegbuff.GetValue ( i );
+                double          delta           = x - runmean ( e, tf );
 
-            if ( sdfile )
-                sum2.GetValue ( i )    += Square ( eegbuff.GetValue ( i ) );
+                runmean ( e, tf )      += delta * invn;
+
+                if ( runsd )
+                    runm2 ( e, tf )    += delta * ( x - runmean ( e, tf ) );
+                }
             }
         }
 
-
-    eegdoc.Close ();
+    OmpParallelEnd
     } // for eegi
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 if ( nonrobust ) {
-
-    int                 numfiles        = (int) gof;
+                                        // files that could not be opened do not count
+    int                 numfiles        = numread;
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // compute SD
-    if ( sdfile ) {
+                                        // compute SD, in place of the squared deviations
+    if ( runsd ) {
 
         OmpParallelFor
 
         for ( int i = 0; i < lineardim; i++ )
 
-            sum2.GetValue ( i )     = sqrt ( fabsl ( ( sum2.GetValue ( i ) - Square ( sum.GetValue ( i ) ) / numfiles ) 
-                                                     / NonNull ( numfiles - 1 )                                         ) );
+            runm2.GetValue ( i )    = sqrt ( runm2.GetValue ( i ) / NonNull ( numfiles - 1 ) );
         }
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // compute Mean
-    sum    /= numfiles;
-
-
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // compute SNR, as Mean / SD (not the variance formula)
+                                        // compute SNR, as Mean / SD (not the variance formula) - reading buffer is not needed anymore
     if ( snrfile ) {
 
         OmpParallelFor
 
         for ( int i = 0; i < lineardim; i++ )
                                    // sqrt to "rescale" to the original data distribution
-            snr .GetValue ( i )     = sqrt ( fabs ( sum.GetValue ( i ) ) / NonNull ( sum2.GetValue ( i ) ) );
+            eegbuff[ 0 ].GetValue ( i ) = sqrt ( fabs ( runmean.GetValue ( i ) ) / NonNull ( runm2.GetValue ( i ) ) );
         }
 
     } // if nonrobust
@@ -261,7 +284,7 @@ if ( meanfile ) {
                                         // !If file exists and user does update the output file, then all the subsequent files will also be updated!
     if ( CanOpenFile ( expfile.Filename, CanOpenFileWriteAndAsk ) ) {
 
-        expfile.Write   ( sum, Transposed );
+        expfile.Write   ( runmean, Transposed );
 
         expfile.End ();
 
@@ -310,7 +333,7 @@ if ( sdfile ) {
 
     if ( CanOpenFile ( expfile.Filename, CanOpenFileWriteAndAsk ) ) {
 
-        expfile.Write   ( sum2, Transposed );
+        expfile.Write   ( runm2, Transposed );
 
         expfile.End ();
 
@@ -323,6 +346,37 @@ if ( sdfile ) {
     }
 
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // save SE, as SD / sqrt ( #files ) - SD has been saved, and SNR already computed, so we can convert it in place
+if ( sefile ) {
+
+    StringCopy      ( expfile.Filename, filese );
+
+
+    if ( CanOpenFile ( expfile.Filename, CanOpenFileWriteAndAsk ) ) {
+
+        double              invsqrtn        = 1 / sqrt ( (double) AtLeast ( 1, numread ) );
+
+        OmpParallelFor
+
+        for ( int i = 0; i < lineardim; i++ )
+
+            runm2.GetValue ( i )   *= invsqrtn;
+
+
+        expfile.Write   ( runm2, Transposed );
+
+        expfile.End ();
+
+
+        StringCopy ( sefile, expfile.Filename );
+                                        // complimentary opening the resulting file(?)
+        if ( IsOpenResults ( execflags ) && ! ( meanfile || sdfile ) )
+              expfile.Filename.Open ();
+        }
+    }
+
+
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // save SNR
 if ( snrfile ) {
@@ -332,7 +386,7 @@ if ( snrfile ) {
 
     if ( CanOpenFile ( expfile.Filename, CanOpenFileWriteAndAsk ) ) {
 
-        expfile.Write   ( snr, Transposed );
+        expfile.Write   ( eegbuff[ 0 ], Transposed );
 
         expfile.End ();
 
@@ -695,15 +749,16 @@ CheckReference ( ref, datatype );
 
 bool                regstats        = vmeanfile   || nmeanfile || snrfile;
 bool                sphstats        = sphmeanfile || sphsdfile || snrfile || sphsnrfile;
-TMaps               risbuff;
+TMaps               risbuff[ 2 ];       // double reading buffer, one being read while the other is cumulated
 TMaps               sum;
 TMaps               sumn;
 
-                    risbuff .Resize ( numtf, numtracks * ( datatype == AtomTypeVector ? 3 : 1 ) );
+                    risbuff[ 0 ].Resize ( numtf, numtracks * ( datatype == AtomTypeVector ? 3 : 1 ) );
+                    risbuff[ 1 ].Resize ( numtf, numtracks * ( datatype == AtomTypeVector ? 3 : 1 ) );
 
-if ( regstats )     sum     .Resize ( risbuff.GetNumMaps (), risbuff.GetDimension () );
+if ( regstats )     sum     .Resize ( risbuff[ 0 ].GetNumMaps (), risbuff[ 0 ].GetDimension () );
                                         // for circular stats
-if ( sphstats )     sumn    .Resize ( risbuff.GetNumMaps (), risbuff.GetDimension () );
+if ( sphstats )     sumn    .Resize ( risbuff[ 0 ].GetNumMaps (), risbuff[ 0 ].GetDimension () );
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -762,56 +817,74 @@ if ( IsInteractive ( execflags ) ) {
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Reading and cumulating are overlapped: while the main thread reads file risi,
+                                        // the other threads cumulate file risi - 1 from the other buffer, then the main thread joins them.
+                                        // One more loop is done to cumulate the last file.
+for ( int risi = 0; risi <= (int) gof; risi++ ) {
 
-for ( int risi = 0; risi < (int) gof; risi++ ) {
+    int                 readi           =   risi       % 2;
+    int                 cumuli          = ( risi + 1 ) % 2;
+                                        // sums are kept as running means, which stay in the data range whatever the number of files
+    double              invn            = 1.0 / AtLeast ( 1, risi );
 
-    if ( Gauge.IsAlive () )
-        Gauge.Next ( 0 );
 
-        
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    OmpParallelBegin
+
+    if ( IsMainThread () && risi < (int) gof ) {
+
+        if ( Gauge.IsAlive () )
+            Gauge.Next ( 0 );
+
                                         // get whole data set
-    risbuff.ReadFile ( gof[ risi ], 0, datatype, ref );
+        risbuff[ readi ].ReadFile ( gof[ risi ], 0, datatype, ref );
 
                                         // try to recover the sampling frequency on each file
-    if ( samplingfrequency == 0 && risbuff.GetSamplingFrequency () > 0 )
+        if ( samplingfrequency == 0 && risbuff[ readi ].GetSamplingFrequency () > 0 )
 
-        samplingfrequency   = risbuff.GetSamplingFrequency ();
+            samplingfrequency   = risbuff[ readi ].GetSamplingFrequency ();
+        }
 
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    if ( risi > 0 ) {
 
-    if ( regstats ) {
+        OmpForDynamic
 
-        OmpParallelFor
+        for ( int nc = 0; nc < risbuff[ cumuli ].GetNumMaps (); nc++ ) {
 
-        for ( int nc = 0; nc < sum.GetNumMaps (); nc++ )
+            TMap&           map             = risbuff[ cumuli ][ nc ];
 
-            sum[ nc ]  += risbuff[ nc ];
-        }
+            if ( regstats )
 
+                for ( int i  = 0; i  < map.GetDim (); i++ )
 
+                    sum[ nc ][ i ]     += ( map[ i ] - sum[ nc ][ i ] ) * invn;
 
-    if ( sphstats ) {
-                                        // we need to normalize each 3D vector
-        risbuff.NormalizeSolutionPoints ( datatype );
 
-                                        // summing up the 3D normalized vectors
-        OmpParallelFor
+            if ( sphstats ) {
+                                        // we need to normalize each 3D vector
+                if ( IsVector ( datatype ) )
 
-        for ( int nc = 0; nc < sum.GetNumMaps (); nc++ )
+                    for ( int e3 = 0; e3 < map.GetDim (); e3 += 3 ) {
 
-            sumn[ nc ] += risbuff[ nc ];
-        } // if sphstats
+                        double          vn          = NormVector3 ( &map[ e3 ] );
 
-    } // for risi
+                        if ( vn ) {
+                            map[ e3     ]  /= vn;
+                            map[ e3 + 1 ]  /= vn;
+                            map[ e3 + 2 ]  /= vn;
+                            }
+                        }
 
+                                        // averaging the 3D normalized vectors
+                for ( int i  = 0; i  < map.GetDim (); i++ )
 
-if ( regstats )
-    sum    /= (int) gof;
+                    sumn[ nc ][ i ]    += ( map[ i ] - sumn[ nc ][ i ] ) * invn;
+                } // if sphstats
+            } // for nc
+        }
 
-if ( sphstats )
-    sumn   /= (int) gof;
+    OmpParallelEnd
+    } // for risi
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1007,12 +1080,13 @@ AtomType            datatype        = AtomTypeVector;
 CheckReference ( ref, datatype );
 
 
-TMaps               risbuff;
+TMaps               risbuff[ 2 ];       // double reading buffer, one being read while the other is cumulated
 TMaps               sum;
 
-risbuff .Resize ( numtf, numtracks * ( datatype == AtomTypeVector ? 3 : 1 ) );
+risbuff[ 0 ].Resize ( numtf, numtracks * ( datatype == AtomTypeVector ? 3 : 1 ) );
+risbuff[ 1 ].Resize ( numtf, numtracks * ( datatype == AtomTypeVector ? 3 : 1 ) );
 
-sum     .Resize ( risbuff.GetNumMaps (), risbuff.GetDimension () );
+sum     .Resize ( risbuff[ 0 ].GetNumMaps (), risbuff[ 0 ].GetDimension () );
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1061,25 +1135,44 @@ for ( int repi = 0; repi < numrepeatavg; repi++ ) {
     sum .Reset ();
 
 
-    for ( int randi = 0; randi < numlocalavg; randi++ ) {
+                                        // reading file randi on the main thread, while the other threads cumulate file randi - 1 - one more loop for the last file
+    for ( int randi = 0; randi <= numlocalavg; randi++ ) {
 
-        if ( Gauge.IsAlive () )
-            Gauge.Next ( 0 );
+        int                 readi           =   randi       % 2;
+        int                 cumuli          = ( randi + 1 ) % 2;
+                                        // running mean over the local average
+        double              invn            = 1.0 / AtLeast ( 1, randi );
+
+
+        OmpParallelBegin
+
+        if ( IsMainThread () && randi < numlocalavg ) {
+
+            if ( Gauge.IsAlive () )
+                Gauge.Next ( 0 );
 
                                         // get whole data set
-        risbuff.ReadFile ( gof[ randindex[ randi ] ], 0, datatype, ref );
+            risbuff[ readi ].ReadFile ( gof[ randindex[ randi ] ], 0, datatype, ref );
 
                                         // try to recover the sampling frequency on each file
-        if ( samplingfrequency == 0 && risbuff.GetSamplingFrequency () > 0 )
+            if ( samplingfrequency == 0 && risbuff[ readi ].GetSamplingFrequency () > 0 )
+
+                samplingfrequency   = risbuff[ readi ].GetSamplingFrequency ();
+            }
 
-            samplingfrequency   = risbuff.GetSamplingFrequency ();
 
+        if ( randi > 0 ) {
 
-        sum    += risbuff;
-        } // for randi
+            OmpForDynamic
 
+            for ( int nc = 0; nc < sum.GetNumMaps (); nc++ )
+            for ( int i  = 0; i  < sum.GetDimension (); i++ )
 
-    sum    /= (int) gof;
+                sum[ nc ][ i ] += ( risbuff[ cumuli ][ nc ][ i ] - sum[ nc ][ i ] ) * invn;
+            }
+
+        OmpParallelEnd
+        } // for randi
 
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
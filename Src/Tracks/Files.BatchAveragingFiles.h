@@ -29,8 +29,8 @@ class       TGoF;
 
                                         // Each  file*  acts as a flag as whether or not computing a given output
 void    BatchAveragingScalar        (   const TGoF& gof,
-                                        char*       meanfile,       char*       sdfile,         char*       snrfile,
-                                        char*       medianfile,     char*       madfile,
+                                        char*       meanfile,       char*       sdfile,         char*       sefile,
+                                        char*       snrfile,        char*       medianfile,     char*       madfile,
                                         ExecFlags   execflags
                                     );
                                         // can also save the results as norms
@@ -115,7 +115,8 @@ void        PreProcessFiles (   const TGoF&             gofin,              Atom
                                 bool                    savemainfiles,      TGoGoF&                 gogofout,       TGoGoF*             dualgogofout,       TGoF&               gofoutdir,      bool&       newfiles,
                                 bool                    savezscore,         TGoF*                   zscoregof,
                                 ExecFlags               execflags,
-                                TSuperGauge*            gauge
+                                TSuperGauge*            gauge,
+                                TGoMaps*                gomapsout
                             )
 
 {
@@ -125,6 +126,8 @@ gogofout.Reset ();
 
 if ( dualgogofout )  dualgogofout->Reset ();
 
+if ( gomapsout )     gomapsout->DeallocateMemory ();
+
 gofoutdir.Reset ();
 
 newfiles    = false;
@@ -215,8 +218,9 @@ if ( badepochs == SkippingBadEpochsList && StringIsEmpty ( listbadepochs ) ) {
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // per file computation - not needed if not saved
-bool                computefiles        =   savemainfiles;
+                                        // per file computation - not needed if not saved nor returned in memory
+bool                computefiles        =   savemainfiles
+                                        ||  gomapsout;
 
                                         // processings that need to scan all data beforehand:
 bool                subsamplesallfiles  =   gfpnormalize        
@@ -283,6 +287,12 @@ if ( ! ispreprocessing ) {
 
     gofoutdir   .Add ( outputdir,   MaxPathShort );
 
+    if ( gomapsout )
+                                        // caller still wants the data in memory, just read them
+        for ( int fi = 0; fi < gofin.NumFiles (); fi++ )
+
+            gomapsout->Add ( new TMaps ( gofin[ fi ], 0, datatypeout, ReferenceAsInFile ) );
+
     return;
     }
 
@@ -692,7 +702,7 @@ for ( int fi = - numextrafiles; fi < numprocfiles; fi++ ) {
                                         // computing factors from subsampled file?
         if      ( backnorm == BackgroundNormalizationComputingZScore   && istempfile )
 
-            ToData->ComputeZScore ( zscoremethod, ZScoreFactors );
+            ToData->ComputeZScore ( zscoremethod, ZScoreFactors, TMapsZScoreSeed );
                                         // reloading the Z-Score factors?
         else if ( backnorm == BackgroundNormalizationLoadingZScoreFile && ZScoreFactors.IsNotAllocated () )
                                         // at this point, this is the responsibility of caller to make sure this file exists and is the proper one!
@@ -1049,6 +1059,22 @@ for ( int fi = - numextrafiles; fi < numprocfiles; fi++ ) {
 
             } // savemainfiles
 
+                                        // Results kept in memory: same epochs as the ones written in files
+        if ( gomapsout ) {
+
+            TMaps*              mapsout         = new TMaps ( writingepochslist.GetMarkersTotalLength (), ToData->GetDimension () );
+            long                tf0             = 0;
+
+            for ( int ki = 0; ki < (int) writingepochslist; ki++ )
+            for ( long tf = writingepochslist[ ki ]->From; tf <= writingepochslist[ ki ]->To; tf++, tf0++ )
+
+                (*mapsout)[ tf0 ]   = (*ToData)[ tf ];
+
+            mapsout->SetSamplingFrequency ( timelinedisrupted ? 0 : samplingfrequency );
+
+            gomapsout->Add ( mapsout );
+            }
+
 
         //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
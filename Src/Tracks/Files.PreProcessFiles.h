@@ -51,6 +51,7 @@ enum        SkippingEpochsType;
 enum        ExecFlags;
 class       TGoF;
 class       TGoGoF;
+class       TGoMaps;
 class       TRois;
 class       TStrings;
 class       TSuperGauge;
@@ -77,7 +78,8 @@ void        PreProcessFiles (   const TGoF&             gofin,              Atom
                                 bool                    savemainfiles,      TGoGoF&                 gogofout,       TGoGoF*             dualgogofout,       TGoF&               gofoutdir,      bool&       newfiles,
                                 bool                    savezscore,         TGoF*                   zscoregof,
                                 ExecFlags               execflags,
-                                TSuperGauge*            gauge = 0 
+                                TSuperGauge*            gauge = 0,
+                                TGoMaps*                gomapsout = 0       // optionally returning the results in memory, one TMaps per output file, in the same order as gogofout
                             );
 
 
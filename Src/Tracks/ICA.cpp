@@ -23,7 +23,6 @@ limitations under the License.
 #include    "TVector.h"
 
 #include    "TMaps.h"
-#include    "TExportTracks.h"
 
 #pragma     hdrstop
 //-=-=-=-=-=-=-=-=-
@@ -58,30 +57,104 @@ return  x * exp ( - Square ( x ) / 2 );
 }
 
 
+//----------------------------------------------------------------------------
+                                        // One FastICA fixed-point step, for all the rows of W at once, with the G1 contrast (a = 1):
+                                        //      W+ = E{ g(W X) X' } - diag ( E{ g'(W X) } ) W      with g = tanh, g' = 1 - tanh^2
+                                        // X is the whitened data, one column per time frame, and only 1 time frame out of step is used
+                                        // Time frames are split into blocks, each block being done with matrix products and a vectorized nonlinearity,
+                                        // then the partial sums are merged in block order, so results do not depend on the number of threads
+void        FastICAStep (   const AMatrix&      X,      int         step,
+                            const AMatrix&      W,      AMatrix&    Wnew    )
+{
+int                 numcomp         = W.n_rows;
+int                 numdim          = X.n_rows;
+int                 numtf           = ( X.n_cols + step - 1 ) / step;
+int                 numblocks       = ( numtf + IcaBlockSize - 1 ) / IcaBlockSize;
+
+vector<AMatrix>     blockgx ( numblocks );
+vector<AVector>     blockgp ( numblocks );
+
+
+OmpParallelFor
+
+for ( int bi = 0; bi < numblocks; bi++ ) {
+
+    int                 tfmin           = bi * IcaBlockSize;
+    int                 tfmax           = min ( tfmin + IcaBlockSize, numtf ) - 1;
+
+                                        // current block of (maybe subsampled) time frames
+    AMatrix             Xb              = step == 1 ? AMatrix ( X.cols ( tfmin, tfmax ) )
+                                                    : AMatrix ( X.cols ( arma::regspace<arma::uvec> ( tfmin * step, step, tfmax * step ) ) );
+
+    AMatrix             G               = arma::tanh ( W * Xb );
+
+    blockgx[ bi ]   = G * Xb.t ();
+    blockgp[ bi ]   = arma::sum ( 1 - arma::square ( G ), 1 );
+    }
+
+
+AMatrix             sumgx   ( numcomp, numdim, arma::fill::zeros );
+AVector             sumgp   ( numcomp,         arma::fill::zeros );
+
+for ( int bi = 0; bi < numblocks; bi++ ) {
+    sumgx  += blockgx[ bi ];
+    sumgp  += blockgp[ bi ];
+    }
+
+
+Wnew    = sumgx / (AReal) numtf - arma::diagmat ( sumgp / (AReal) numtf ) * W;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // W = ( W W' )^-1/2 W, which makes all rows orthonormal without favoring any of them
+void        SymmetricDecorrelation ( AMatrix& W )
+{
+AVector             D;
+AMatrix             V;
+
+AEigenvaluesEigenvectorsArma ( ASymmetricMatrix ( W * W.t () ), D, V );
+
+
+for ( int i = 0; i < (int) D.n_elem; i++ )
+    D ( i )     = D ( i ) > 0 ? 1 / sqrt ( D ( i ) ) : 0;
+
+
+W       = V * arma::diagmat ( D ) * V.t () * W;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Subsampling of the time frames for the first iterations: starting with a step giving
+                                        // about IcaSubsamplingMinTF time frames per component, then halved at each convergence, or after IcaMaxIterations, down to 1
+int         GetIcaInitialStep ( int numtf, int numcomp, bool subsampling )
+{
+return  subsampling ? AtLeast ( 1, numtf / AtLeast ( 1, IcaSubsamplingMinTF * numcomp ) ) : 1;
+}
+
+
 //----------------------------------------------------------------------------
                                         // Do an ICA on the already loaded buffer
-                                        // V and eigenvalues can be less than the input dimension
-bool        ICA (   TMaps&              data,           
+                                        // Data is first whitened with a PCA, then the unmixing matrix is estimated in the whitened space
+                                        // icavectors are the components topographies (mixing matrix columns), icadata their time courses
+bool        ICA (   TMaps&              data,
                     bool                robust,
                     bool                removelasteigen,
                     TMaps&              icavectors,
                     TMaps&              icadata,
-                    TSuperGauge*        gauge )
+                    TSuperGauge*        gauge,
+                    IcaMethodType       method,
+                    bool                subsampling,
+                    bool*               converged
+                )
 {
+if ( converged )
+    *converged  = false;
+
 if ( data.IsNotAllocated () )
     return  false;
 
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // if variablesindim1, then first dimension holds the variables (like an EEG buffer)
-//int                 numdim          = data.GetDimension ();
-//int                 numsamples      = data.GetNumMaps ();
-
-                                        // not enough data?
-//if ( dim2 < dim1 )
-//    return  false;
-
-
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // we need some temp variables to call PCA
 
@@ -90,163 +163,153 @@ TMaps               eigenvectors;
 TVector<float>      eigenvalues;
 AMatrix             topca;              // might not be a squared matrix
 AMatrix             towhite;
-AMatrix             Etopca;              // might not be a squared matrix
-AMatrix             Etowhite;
-AMatrix             fromwhite;
-AMatrix             Efromwhite;
 TMaps               datawhite;
 
 
-PCA (   data, 
+PCA (   data,
         robust,
         removelasteigen,
         pcaresults,
         eigenvectors,   eigenvalues,
-        Etopca,          Etowhite,
+        topca,          towhite,
         datawhite,
         gauge
     );
 
 
-//datawhite.WriteFile ( "E:\\Data\\DataWhite.sef" );
-
-
-fromwhite   = towhite.t ();
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-int                 whitenumel      = datawhite.GetDimension ();
-int                 whitenumtf      = datawhite.GetNumMaps   ();
-
-
-TVector<double>     wt   ( whitenumel );
-TVector<double>     wtold( whitenumel );
-TVector<double>     wtX  ( whitenumtf );
-TVector<double>     gwtX ( whitenumtf );
-
-
-long double         gprimewtX;
-long double         XgwtX;
-TMap*               map;
-
-                                        // initial vector
-//wt.Random    ( 0.0, 1.0 );
-wt.Random    ( -1.0, 1.0 );
-wt.Normalize ();
-//wt.Normalize ( true );
-
-
-int                 iter        = 0;
-
-TFileName           _file;
-char                buff[ 256 ];
-StringCopy      ( _file, "E:\\Data\\convmap.", IntegerToString ( buff, iter ), ".sef" );
-wt.WriteFile    ( _file, "wt" );
+int                 numcomp         = datawhite.GetDimension ();    // as many components as whitened dimensions
+int                 numtf           = datawhite.GetNumMaps   ();
 
+if ( numcomp == 0 || numtf == 0 )
+    return  false;
 
-do {
+                                        // whitened data as a matrix, one column per time frame
+AMatrix             X ( numcomp, numtf );
 
-    wtold   = wt;
+OmpParallelFor
 
+for ( int tf = 0; tf < numtf; tf++ )
+for ( int i  = 0; i  < numcomp; i++  )
+    X ( i, tf )     = datawhite ( tf, i );
 
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    for ( int tf = 0; tf < whitenumtf; tf++ ) {
 
-        map         = &datawhite[ tf ];
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // unmixing matrix in the whitened space, one row per component
+AMatrix             W ( numcomp, numcomp );
+AMatrix             Wnew;
+TRandUniform        randunif;
 
-                                            // wtX: project data on w
-        wtX[ tf ]   = 0;
+for ( int c = 0; c < numcomp; c++ )
+for ( int i = 0; i < numcomp; i++ )
+    W ( c, i )      = randunif ( -1.0, 1.0 );
 
-        for ( int i  = 0; i  < whitenumel; i++  )
+                                        // set by the last, full data, iterations
+bool                allconverged    = true;
 
-            wtX[ tf ]  += wt[ i ] * (*map)[ i ];
-        } // for tf
 
+if      ( method == IcaSymmetric ) {
+                                        // all components are estimated at once
+    SymmetricDecorrelation ( W );
 
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                            // first part of convergence
-    for ( int tf = 0; tf < whitenumtf; tf++ )
+    int                 step            = GetIcaInitialStep ( numtf, numcomp, subsampling );
+    int                 iter            = 0;
 
-        gwtX[ tf ]  = G2 ( wtX[ tf ] );
+    while ( true ) {
 
+        FastICAStep             ( X, step, W, Wnew );
 
-    XgwtX   = 0;
+        SymmetricDecorrelation  ( Wnew );
 
-    for ( int i  = 0; i  < whitenumel; i++  ) {
+                                        // converged when all rows have stopped rotating
+        double              convergence     = arma::max ( arma::abs ( arma::abs ( arma::diagvec ( Wnew * W.t () ) ) - 1 ) );
+        bool                stepconverged   = convergence < IcaConvergence;
 
-        for ( int tf = 0; tf < whitenumtf; tf++ )
+        W       = Wnew;
 
-            XgwtX  += gwtX[ tf ] * datawhite ( tf, i );
+        if ( stepconverged || ++iter >= IcaMaxIterations ) {
+                                        // only the full data can end the estimation
+            if ( step == 1 ) {
+                allconverged    = stepconverged;
+                break;
+                }
+                                        // refine on more time frames, with its own budget of iterations
+            step   /= 2;
+            iter    = 0;
+            }
         }
+    }
 
-    XgwtX  /= whitenumel;
-//    XgwtX  /= whitenumel * whitenumtf; // ??????
+else if ( method == IcaDeflation ) {
+                                        // components are estimated one after the other, each being kept orthogonal to the previous ones
+    for ( int c = 0; c < numcomp; c++ ) {
 
+        AMatrix             w               = W.row ( c );
+        AMatrix             wnew;
 
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                            // second part of convergence
-    gprimewtX   = 0;
+        w      /= arma::norm ( w );
 
-    for ( int tf = 0; tf < whitenumtf; tf++ )
+        int                 step            = GetIcaInitialStep ( numtf, numcomp, subsampling );
+        int                 iter            = 0;
 
-        gprimewtX  += G2Prime ( wtX[ tf ] );
+        while ( true ) {
 
-    gprimewtX  /= whitenumtf;
+            FastICAStep ( X, step, w, wnew );
 
+                                        // Gram-Schmidt against the already estimated components
+            if ( c > 0 )
+                wnew   -= ( wnew * W.head_rows ( c ).t () ) * W.head_rows ( c );
 
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // new wt
+            wnew   /= arma::norm ( wnew );
 
-    for ( int i  = 0; i  < whitenumel; i++  )
 
-        wt[ i ]     = XgwtX - gprimewtX * wt[ i ];
-//        wt[ i ]     = ( XgwtX - gprimewtX ) * wt[ i ];
+            double              convergence     = fabs ( fabs ( arma::dot ( wnew, w ) ) - 1 );
+            bool                stepconverged   = convergence < IcaConvergence;
 
+            w       = wnew;
 
-    wt.Normalize ();
-    //wt.Normalize ( true );
+            if ( stepconverged || ++iter >= IcaMaxIterations ) {
 
+                if ( step == 1 ) {
+                    allconverged    = allconverged && stepconverged;
+                    break;
+                    }
 
-    StringCopy      ( _file, "E:\\Data\\convmap.", IntegerToString ( buff, iter + 1 ), ".sef" );
-    wt.WriteFile    ( _file, "wt" );
+                step   /= 2;
+                iter    = 0;
+                }
+            }
 
-//    if ( VkQuery () ) DBGV3 ( iter, XgwtX, - gprimewtX, "iter, XgwtX, - gprimewtX" );
-//    DBGV ( wt.ScalarProduct ( wtold ) * 1000, "convergence" );
+        W.row ( c ) = w;
+        }
+    }
 
-//    } while ( fabs ( wt.ScalarProduct ( wtold ) ) < 0.9999999 );
-    } while ( ++iter < 10 );
+else
+    return  false;
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // unmixing from original space, then mixing matrix which columns are the components topographies
+AMatrix             unmixing        = W * towhite;
+AMatrix             mixing          = arma::pinv ( unmixing );
+int                 numdim          = mixing.n_rows;
 
-AMatrix             T;
-AMatrix             ET;
-
-                                        // copy single topography
-TMaps               wicavectors;
-
-wicavectors.Resize      ( 1, whitenumel );
-T          .AResizeFast ( 1, whitenumel );
-
+                                        // components have all unit variance, so sort them by the power of their topographies
+arma::uvec          order           = arma::sort_index ( arma::sum ( arma::square ( mixing ), 0 ), "descend" );
 
-for ( int i  = 0; i  < whitenumel; i++  ) {
 
-    wicavectors ( 0, i )    = wt[ i ];
-
-    T ( 0, i )              = wt[ i ];
-    }
+icavectors.Resize ( numcomp, numdim );
 
+for ( int c = 0; c < numcomp; c++ )
+for ( int e = 0; e < numdim;  e++ )
+    icavectors ( c, e )     = mixing ( e, order ( c ) );
 
-                                        // apply to whitened data to have the time-course of wt
-datawhite.Multiply ( ET, icadata );
+AMatrix             Wsorted         = W.rows ( order );
+                                        // apply to whitened data to have the time-courses of the components
+datawhite.Multiply ( Wsorted, icadata );
 
-                                        // transform the white icavectors back to original space
-wicavectors.Multiply ( Efromwhite, icavectors );
-//icavectors = wicavectors;
 
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+if ( converged )
+    *converged  = allconverged;
 
 return  true;
 }
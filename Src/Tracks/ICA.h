@@ -24,13 +24,31 @@ namespace crtl {
 class           TMaps;
 class           TSuperGauge;
 
-                                        // !NOT WORKING CORRECTLY - so not available to user!
-bool            ICA (   TMaps&              data,           
+
+enum            IcaMethodType
+                {
+                IcaDeflation,           // components estimated one at a time, each orthogonalized against the previous ones - kept for comparison
+                IcaSymmetric,           // all components estimated at once, then symmetrically decorrelated
+                };
+
+
+constexpr int       IcaMaxIterations        = 200;
+constexpr double    IcaConvergence          = 1e-4;
+constexpr int       IcaBlockSize            = 1024;     // time frames per block, for the parallel reductions
+constexpr int       IcaSubsamplingMinTF     = 100;      // time frames per component for the first, subsampled iterations
+
+
+                                        // FastICA on the whitened data - not available to user yet
+bool            ICA (   TMaps&              data,
                         bool                robust,
                         bool                removelasteigen,
                         TMaps&              icavectors,
                         TMaps&              icadata,
-                        TSuperGauge*        gauge );
+                        TSuperGauge*        gauge,
+                        IcaMethodType       method          = IcaSymmetric,
+                        bool                subsampling     = false,
+                        bool*               converged       = 0     // false if the full data iterations did not converge
+                    );
 
 
 //----------------------------------------------------------------------------
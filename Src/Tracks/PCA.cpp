@@ -22,6 +22,7 @@ limitations under the License.
 #include    "TArray1.h"
 #include    "TArray2.h"
 #include    "TVector.h"
+#include    "Dialogs.Input.h"
 
 #include    "TExportTracks.h"
 #include    "TMaps.h"
@@ -173,15 +174,24 @@ if       ( processing == PcaProcessing )
             gauge 
         );
 
-else if ( processing == IcaProcessing )
+else if ( processing == IcaProcessing ) {
 
-    ICA (   maps, 
-            covrobust,
-            removelasteigen,
-            eigenvectors,
-            pcamaps,
-            gauge
-        );
+    bool                converged;
+
+    if ( ICA (  maps, 
+                covrobust,
+                removelasteigen,
+                eigenvectors,
+                pcamaps,
+                gauge,
+                IcaSymmetric,
+                false,
+                &converged
+            )
+      && ! converged )
+
+        ShowMessage ( "ICA did not converge within the maximum number of iterations," NewLine "components might not be fully separated.", PcaIcaTypeString[ processing ], ShowMessageWarning );
+    }
 
 
                                         // done with the original data
@@ -692,7 +702,7 @@ if ( removelasteigen ) {
 
                                         // 3 SD is quite conservative actually
     double              lastthreshold   = stat.Median () 
-                                        + 3 * ( stat.Sn ( 5000 ) + stat.Qn ( 5000 ) + stat.InterQuartileRange () + stat.MAD () ) / 4;
+                                        + 3 * ( stat.Sn () + stat.Qn () + stat.InterQuartileRange () + stat.MAD () ) / 4;
 
     //DBGV ( lastthreshold, "lastthreshold" );
 
@@ -116,6 +116,7 @@ CurrentPositionTrack= 0;
 CurrentPositionTime = 0;
 DoneBegin           = false;
 EndOfHeader         = 0;
+TextBuffer.Reset ();
 }
 
 
@@ -456,6 +457,8 @@ void    TExportTracks::CloseStream ()
 if ( of == 0 )
     return;
 
+                                        // any pending text
+TextBuffer.Flush ( *of );
 
 of->close ();
 delete  of;
@@ -875,6 +878,8 @@ void    TExportTracks::WriteHeader ( bool overwrite )
 {
 char            buff[ KiloByte ];
 
+                                        // any pending text has to be written before moving around
+TextBuffer.Flush ( *of );
                                         // go back to beginning, if needed
 of->seekp ( 0, ios::beg );
 
@@ -1483,16 +1488,19 @@ if      ( Type == ExportTracksEp
        || Type == ExportTracksSeg
        || Type == ExportTracksData ) {
 
-
-    *of << StreamFormatFloat32 << value << Tab;
+                                        // formatting into the text buffer, which is written by big blocks
+    TextBuffer.AppendFloat32 ( value );
+    TextBuffer.AppendText    ( Tab );
 
 
     CurrentPositionTrack = ++CurrentPositionTrack % ( NumTracks * NumFiles );
     if ( ! CurrentPositionTrack )
         CurrentPositionTime++;
 
-    if ( ! CurrentPositionTrack )
-        *of << fastendl;
+    if ( ! CurrentPositionTrack ) {
+        TextBuffer.AppendText  ( fastendl );
+        TextBuffer.FlushIfFull ( *of );
+        }
     }
 
 
@@ -1552,6 +1560,41 @@ if ( CurrentPositionTime >= NumTime )   // this should be the end!
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Writing a full row of values, with an optional stride between successive values
+                                        // Text files will format the whole row at once, instead of going through the streams for each value
+template <class TypeD>
+void    TExportTracks::WriteRow ( const TypeD* values, int numvalues, int step )
+{
+if ( ! DoneBegin )
+    Begin ();
+
+
+if ( IsTextFile ()
+  && of
+  && CurrentPositionTrack == 0                      // we have to be at the beginning of a line
+  && numvalues            == NumTracks * NumFiles   // and the row has to be a complete line
+   ) {
+
+    TextBuffer.AppendFloat32Row ( values, numvalues, step, Tab );
+    TextBuffer.AppendText       ( fastendl );
+    TextBuffer.FlushIfFull      ( *of );
+
+    CurrentPositionTime++;
+
+
+    if ( CurrentPositionTime >= NumTime )   // this should be the end!
+        End ();
+    }
+
+else                                    // all other cases
+
+    for ( int i = 0; i < numvalues; i++, values += step )
+
+        Write ( (float) *values );
+}
+
+
 //----------------------------------------------------------------------------
 void    TExportTracks::Write ( long value )
 {
@@ -1565,15 +1608,18 @@ if      ( Type == ExportTracksEp
        || Type == ExportTracksData ) {
 
 
-    *of << StreamFormatInt32 << value << Tab;
+    TextBuffer.AppendInt32 ( value );
+    TextBuffer.AppendText  ( Tab );
 
 
     CurrentPositionTrack = ++CurrentPositionTrack % ( NumTracks * NumFiles );
     if ( ! CurrentPositionTrack )
         CurrentPositionTime++;
 
-    if ( ! CurrentPositionTrack )
-        *of << fastendl;
+    if ( ! CurrentPositionTrack ) {
+        TextBuffer.AppendText  ( fastendl );
+        TextBuffer.FlushIfFull ( *of );
+        }
 
 
     if ( CurrentPositionTime >= NumTime )   // this should be the end!
@@ -1598,15 +1644,18 @@ if      ( Type == ExportTracksEp
        || Type == ExportTracksData ) {
 
 
-    *of << StreamFormatFloat64 << value << Tab;
+    TextBuffer.AppendFloat64 ( value );
+    TextBuffer.AppendText    ( Tab );
 
 
     CurrentPositionTrack = ++CurrentPositionTrack % ( NumTracks * NumFiles );
     if ( ! CurrentPositionTrack )
         CurrentPositionTime++;
 
-    if ( ! CurrentPositionTrack )
-        *of << fastendl;
+    if ( ! CurrentPositionTrack ) {
+        TextBuffer.AppendText  ( fastendl );
+        TextBuffer.FlushIfFull ( *of );
+        }
 
 
     if ( CurrentPositionTime >= NumTime )   // this should be the end!
@@ -1863,14 +1912,17 @@ if      ( Type == ExportTracksSef
 //  of->flush ();
     }
 
-else
+else {
+                                        // going through full rows, so that text files can format them at once
+    long                rowsize         = AtLeast ( 1, NumTracks * NumFiles );
 
-    for ( long tf = 0; tf < values.GetDim1 (); tf++ ) {
+    for ( long i = 0; i < values.GetDim1 (); i += rowsize ) {
 
         Cartool.UpdateApplication ();
 
-        Write ( values ( tf ) );
+        WriteRow ( values.GetArray () + i, (int) NoMore ( rowsize, values.GetDim1 () - i ) );
         }
+    }
 }
 
 
@@ -1943,14 +1995,12 @@ if      ( Type == ExportTracksSef
 //  of->flush ();
     }
 
-else
-
-    for ( int i = 0; i < map.GetDim (); i++ ) {
+else {
 
-        Cartool.UpdateApplication ();
+    Cartool.UpdateApplication ();
 
-        Write ( map ( i ) );
-        }
+    WriteRow ( map.GetArray (), map.GetDim () );
+    }
 }
 
 
@@ -1981,9 +2031,8 @@ for ( int ki = 0; ki < (int) (*keeplist); ki++ ) {
 
 
     for ( long tf = tomarker->From; tf <= tomarker->To; tf++ )
-    for ( int el = 0; el < NumTracks; el++ )
 
-        Write ( values ( el, tf ) );
+        WriteRow ( &values ( 0, tf ), NumTracks, values.GetDim2 () );
 
     } // for keeplist
 
@@ -2010,8 +2059,7 @@ if ( transpose == Transposed ) {        // the "\n" is not handled correctly, ca
         if ( Gauge.IsAlive () )     Gauge.Next ();
         else                        Cartool.UpdateApplication ();
         
-        for ( int el = 0; el < NumTracks * NumFiles; el++ )
-            Write ( values ( el, tf ) );
+        WriteRow ( &values ( 0, tf ), NumTracks * NumFiles, values.GetDim2 () );
         }
     } // Transposed
 
@@ -2042,8 +2090,7 @@ else { // NotTransposed
             if ( Gauge.IsAlive () )     Gauge.Next ();
             else                        Cartool.UpdateApplication ();
 
-            for ( int el = 0; el < NumTracks * NumFiles; el++ )
-                Write ( values ( tf, el ) );
+            WriteRow ( values[ tf ], NumTracks * NumFiles );
             }
         } // not optimized
 
@@ -2400,8 +2447,7 @@ if ( keeplist ) {
 
             Cartool.UpdateApplication ();
 
-            for ( int el = 0; el < NumTracks; el++)
-                Write ( EegBuff[ el ][ tf0 ] );
+            WriteRow ( &EegBuff ( 0, tf0 ), NumTracks, EegBuff.GetDim2 () );
             }
 
         } // for keeplist
@@ -2414,8 +2460,7 @@ else {
 
         Cartool.UpdateApplication ();
 
-        for ( int el = 0; el < NumTracks; el++)
-            Write ( EegBuff[ el ][ tf0 ] );
+        WriteRow ( &EegBuff ( 0, tf0 ), NumTracks, EegBuff.GetDim2 () );
         }
     }
 
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include    "Strings.TStrings.h"
 #include    "Files.Utils.h"
+#include    "Files.Stream.h"
 #include    "Time.TDateTime.h"
 #include    "TMarkers.h"
 
@@ -227,6 +228,7 @@ public:
 protected:
 
     std::ofstream*  of;
+    TStreamTextBuffer TextBuffer;       // text files are formatted into this buffer, then written by big blocks
     int             CurrentPositionTrack;
     long            CurrentPositionTime;
     bool            DoneBegin;
@@ -247,6 +249,9 @@ protected:
     void            CloseStream ();                             // close stream - Called automatically
     void            PreFillFile ();
 
+    template <class TypeD>
+    void            WriteRow    ( const TypeD* values, int numvalues, int step = 1 );  // a full row at once, which text files can format in one go
+
     const char*     GetElectrodeName ( int i, char *name, int maxlen );
     const char*     GetFrequencyName ( int i, char *name, int maxlen );
 
@@ -147,6 +147,7 @@ else if ( typeid ( *filter ) == typeid ( TFilterButterworthHighPass<TypeD>    )
 else if ( typeid ( *filter ) == typeid ( TFilterButterworthLowPass <TypeD>    ) )   return  new TFilterButterworthLowPass <TypeD> ( *dynamic_cast<const TFilterButterworthLowPass <TypeD>*> ( filter ) );
 else if ( typeid ( *filter ) == typeid ( TFilterEnvelope           <TypeD>    ) )   return  new TFilterEnvelope           <TypeD> ( *dynamic_cast<const TFilterEnvelope           <TypeD>*> ( filter ) );
 else if ( typeid ( *filter ) == typeid ( TFilterRanking            <TypeD>    ) )   return  new TFilterRanking            <TypeD> ( *dynamic_cast<const TFilterRanking            <TypeD>*> ( filter ) );
+else if ( typeid ( *filter ) == typeid ( TFilterRecursiveGaussian  <TypeD>    ) )   return  new TFilterRecursiveGaussian  <TypeD> ( *dynamic_cast<const TFilterRecursiveGaussian  <TypeD>*> ( filter ) );
 else if ( typeid ( *filter ) == typeid ( TFilterRectification      <TypeD>    ) )   return  new TFilterRectification      <TypeD> ( *dynamic_cast<const TFilterRectification      <TypeD>*> ( filter ) );
 else if ( typeid ( *filter ) == typeid ( TFilterReference          <TypeD>    ) )   return  new TFilterReference          <TypeD> ( *dynamic_cast<const TFilterReference          <TypeD>*> ( filter ) );
 else if ( typeid ( *filter ) == typeid ( TFilterSpatial            <TypeD>    ) )   return  new TFilterSpatial            <TypeD> ( *dynamic_cast<const TFilterSpatial            <TypeD>*> ( filter ) );
@@ -61,6 +61,11 @@ protected:
     double          SamplingFrequency;
     double          EnvelopeWidth;      // in [ms]
 
+                                        // Analytic FFT plans, kept across calls as their creation is costly - not copied, each copy builds its own
+    mkl::TMklFft    FFT;
+    mkl::TMklFft    FFTI;
+    int             FFTSize;
+
 };
 
 
@@ -116,6 +121,10 @@ void    TFilterEnvelope<TypeD>::Reset ()
 How                 = FilterTypeNone;
 SamplingFrequency   = 0;
 EnvelopeWidth       = 0;
+
+FFT .Reset ();
+FFTI.Reset ();
+FFTSize             = 0;
 }
 
 
@@ -125,6 +134,7 @@ template <class TypeD>
 How                 = op.How;
 SamplingFrequency   = op.SamplingFrequency;
 EnvelopeWidth       = op.EnvelopeWidth;
+FFTSize             = 0;
 }
 
 
@@ -139,6 +149,10 @@ How                 = op2.How;
 SamplingFrequency   = op2.SamplingFrequency;
 EnvelopeWidth       = op2.EnvelopeWidth;
 
+FFT .Reset ();
+FFTI.Reset ();
+FFTSize             = 0;
+
 
 return  *this;
 }
@@ -194,6 +208,7 @@ else if ( How == FilterTypeEnvelopeAnalytic         )   ApplyAnalytic       ( da
                                         // Works well on any type of narrow-band / broad-band filtered / non-filtered data
                                         // Data will be rectified internally
                                         // Uses mirroring at boundaries
+                                        // Sum is a running one, O(1) per sample, and is recomputed from scratch at each full turn of the circular buffer to avoid drifting
 template <class TypeD>
 void    TFilterEnvelope<TypeD>::ApplySlidingWindow ( TypeD* data, int numpts )
 {
@@ -211,7 +226,7 @@ for ( int ii = 0; ii < numpts; ii++ )
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 int                 halfwidth       = EnvelopeWidthTF / 2;  // will generate a shifting error of 0.5 TF to the left, if EnvelopeWidthTF is not odd - which it should usually be
-double              sum;
+double              sum             = 0;
 int                 io              = 0;                    // EnvelopeBuff will act as a circular buffer, io is current insertion point
 int                 i;
 
@@ -225,22 +240,31 @@ for ( i = 0; i < halfwidth; i++, io++ )
                                         // filling with data part:      #2 #1 #0 #1  0
     EnvelopeBuff[ io ]  = data[ i ];
 
+                                        // last slot has not been filled yet, so it doesn't count in the initial sum
+EnvelopeBuff[ io ]  = 0;
+
+for ( int j = 0; j < EnvelopeWidthTF; j++ )
+    sum    += EnvelopeBuff[ j ];
+
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 for ( ; i < numpts; i++ ) {
+                                        // running sum: adding the incoming point, removing the outgoing one
+    sum    += data[ i ] - EnvelopeBuff[ io ];
                                         // adding next data point:      #2 #1 #0 #1 #2, then #1 #0 #1 #2 #3, then #0 #1 #2 #3 #4
     EnvelopeBuff[ io ]  = data[ i ];
 
-
-    sum     = 0;                        // redo the sum each time - better precision
-
-    for ( int j = 0; j < EnvelopeWidthTF; j++ )
-        sum += EnvelopeBuff[ j ];
-
     data[ i - halfwidth ] = sum / EnvelopeWidthTF /* * SqrtTwo */;
 
     io      = ++io % EnvelopeWidthTF;   // circular buffer
+
+    if ( io == 0 ) {                    // buffer has done a full turn: redo the sum for better precision
+        sum     = 0;
+
+        for ( int j = 0; j < EnvelopeWidthTF; j++ )
+            sum += EnvelopeBuff[ j ];
+        }
     }
 
 
@@ -249,16 +273,22 @@ for ( ; i < numpts; i++ ) {
                                         // current buffer state:        #5 #6 #7 #8 #9
 for ( ; i < numpts + halfwidth; i++ ) {
                                         // filling with mirror part:    #6 #7 #8 #9 #8, then #7 #8 #9 #8 #7
-    EnvelopeBuff[ io ] = data[ RightMirroring ( numpts, i - numpts, numpts - 1 ) ];
+    TypeD           v               = data[ RightMirroring ( numpts, i - numpts, numpts - 1 ) ];
 
-    sum     = 0;                        // redo the sum each time - better precision
+    sum    += v - EnvelopeBuff[ io ];
 
-    for ( int j = 0; j < EnvelopeWidthTF; j++ )
-        sum += EnvelopeBuff[ j ];
+    EnvelopeBuff[ io ] = v;
 
     data[ i - halfwidth ] = sum / EnvelopeWidthTF /* * SqrtTwo */;
 
     io      = ++io % EnvelopeWidthTF;   // circular buffer
+
+    if ( io == 0 ) {
+        sum     = 0;
+
+        for ( int j = 0; j < EnvelopeWidthTF; j++ )
+            sum += EnvelopeBuff[ j ];
+        }
     }
 
 
@@ -449,9 +479,19 @@ int                 lastfreqi           = numpts / 2;
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // We need the Hilbert transform, so we go through some Fourier to do that
 
-                                        // ?can we put this as fields?
-mkl::TMklFft        fft  ( mkl::FromReal,      FFTRescalingForward,  numpts );
-mkl::TMklFft        ffti ( mkl::BackToComplex, FFTRescalingBackward, numpts );
+                                        // Plans are only (re)built when the size changes, which never happens within a parallel block, as all tracks have the same length
+                                        // Computing with a committed plan is read-only, so the same object can be used concurrently across electrodes
+OmpCriticalBegin (TFilterEnvelopeAnalytic)
+
+if ( FFTSize != numpts ) {
+
+    FFT .Set ( mkl::FromReal,      FFTRescalingForward,  numpts );
+    FFTI.Set ( mkl::BackToComplex, FFTRescalingBackward, numpts );
+
+    FFTSize     = numpts;
+    }
+
+OmpCriticalEnd
 
 
 TVector<AReal>      X ( numpts );
@@ -464,7 +504,7 @@ for ( int i = 0; i < numpts; i++ )
 
                                         // real FFT only - will not touch anything past freqsize in the F vector, which will remain 0
 //fft ( data, F );  // for float case, we could skip the transfer...
-fft ( X, F );
+FFT ( X, F );
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -480,7 +520,7 @@ for ( int i = firstfreqi + 1; i < lastfreqi; i++ )
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // invert FFT
-ffti ( F, A );
+FFTI ( F, A );
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
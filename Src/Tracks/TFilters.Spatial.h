@@ -163,14 +163,15 @@ public:
 
 //  inline  void    Apply                               ( TypeD*          data, int numpts ) {}             // to shut-up compiler
     inline  bool    Apply                               ( TVector<TypeD>& map );                            // automatic redirection
+    inline  bool    Apply                               ( TVector<TypeD>& map, TVector<TypeD>& temp, TVector<TypeD>& bads, TEasyStats& stat );  // same, with caller's working buffers
     inline  void    Apply                               ( TArray2<TypeD> &data, int numtf, int tfoffset );
     inline  void    Apply                               ( TMaps&          maps, int nummaps = -1 );
 
 //  inline  bool    SpatialFiltering                    ( TArray2<int>& neighindex, TVector<TypeD>& map );
-    inline  bool    SpatialFilteringStat                ( TVector<TypeD>& map );
-    inline  bool    SpatialFilteringInterpolate         ( TVector<TypeD>& map );
-    inline  bool    SpatialFilteringInterpolateSmooth   ( TVector<TypeD>& map );
-    inline  bool    SpatialFilteringInterseptile        ( TVector<TypeD>& map );
+    inline  bool    SpatialFilteringStat                ( TVector<TypeD>& map, TVector<TypeD>& temp, TEasyStats& stat );
+    inline  bool    SpatialFilteringInterpolate         ( TVector<TypeD>& map, TVector<TypeD>& temp, TEasyStats& stat );
+    inline  bool    SpatialFilteringInterpolateSmooth   ( TVector<TypeD>& map, TVector<TypeD>& temp, TVector<TypeD>& bads, TEasyStats& stat );
+    inline  bool    SpatialFilteringInterseptile        ( TVector<TypeD>& map, TVector<TypeD>& temp );
 
 
                         TFilterSpatial      ( const TFilterSpatial& op  );
@@ -185,6 +186,19 @@ protected:
     TArray3<double>     NeighDist;
     TFileName           File;
 
+                                        // Neighborhoods in a compact CSR layout, computed once at Set time:
+                                        // neighbors of point i are in [ NeighStart[ i ], NeighStart[ i + 1 ] ), central point first, sorted by distance
+    TArray1<int>        NeighStart;
+    TArray1<int>        NeighRadius;    // end of the neighbors within MaxDistNeigh, which is a prefix of the whole neighborhood
+    TArray1<int>        NeighIndex;
+    TArray1<double>     NeighWeight;    // distance weights, Gaussian or inverse distance according to How
+
+
+    void                SetNeighborhoods    ();
+    inline  void        AllocateScratch     ( TVector<TypeD>& bads, TEasyStats& stat )             const;
+    inline  bool        IsOutlier           ( const TVector<TypeD>& map, int i, TEasyStats& stat )  const;
+    inline  double      InterseptileMean    ( const TVector<TypeD>& map, int i )                    const;
+
                                                                                    // exact dimension           + 3 pseudo tracks                           lazy test                   exact dimension           + 1 null tracks               + 3 pseudo tracks                           + 1 null tracks + 3 pseudo tracks
     inline  bool       _IsDimensionOK   ( int dim )                 const   { return  dim == GetNumPoints () || dim == GetNumPoints () + NumPseudoTracks; /*dim >= GetNumPoints ();*/ /*dim == GetNumPoints () || dim == GetNumPoints () + 1 || dim == GetNumPoints () + NumPseudoTracks || dim == GetNumPoints () + 1 + NumPseudoTracks;*/ }
 
@@ -218,6 +232,11 @@ MaxNumNeigh         = 0;
 MaxDistNeigh        = 0;
 NeighDist.DeallocateMemory ();
 File.Clear ();
+
+NeighStart .DeallocateMemory ();
+NeighRadius.DeallocateMemory ();
+NeighIndex .DeallocateMemory ();
+NeighWeight.DeallocateMemory ();
 }
 
 
@@ -229,6 +248,10 @@ MaxNumNeigh         = op.MaxNumNeigh;
 MaxDistNeigh        = op.MaxDistNeigh;
 NeighDist           = op.NeighDist;
 File                = op.File;
+NeighStart          = op.NeighStart;
+NeighRadius         = op.NeighRadius;
+NeighIndex          = op.NeighIndex;
+NeighWeight         = op.NeighWeight;
 }
 
 
@@ -244,6 +267,10 @@ MaxNumNeigh         = op2.MaxNumNeigh;
 MaxDistNeigh        = op2.MaxDistNeigh;
 NeighDist           = op2.NeighDist;
 File                = op2.File;
+NeighStart          = op2.NeighStart;
+NeighRadius         = op2.NeighRadius;
+NeighIndex          = op2.NeighIndex;
+NeighWeight         = op2.NeighWeight;
 
 
 return  *this;
@@ -303,13 +330,159 @@ else if ( SPDoc ) {
                                         // If it still doesn't work, revoke the spatial filter
 //if ( NeighDist.IsNotAllocated () )
 //    Reset ();
+
+SetNeighborhoods ();
 }
 
 
 //----------------------------------------------------------------------------
-                                        // Global dispatcher to the right function - although the specialized functions are directly callable, too
+                                        // Neighborhoods and weights do not depend on the data, so they are extracted once from NeighDist
+template <class TypeD>
+void    TFilterSpatial<TypeD>::SetNeighborhoods ()
+{
+if ( NeighDist.IsNotAllocated () )
+    return;
+
+
+int                 numpoints       = GetNumPoints ();
+bool                gaussianweights = How == SpatialFilterInterseptileGaussianMean
+                                   || How == SpatialFilterOutlier
+                                   || How == SpatialFilterOutliersGaussianMean;
+
+NeighStart .Resize ( numpoints + 1 );
+NeighRadius.Resize ( numpoints );
+NeighIndex .Resize ( numpoints * ( MaxNumNeigh + 1 ) );
+NeighWeight.Resize ( numpoints * ( MaxNumNeigh + 1 ) );
+
+
+int                 n               = 0;
+
+for ( int i = 0; i < numpoints; i++ ) {
+
+    NeighStart [ i ]    = n;
+    NeighRadius[ i ]    = -1;
+
+    for ( int j = 0; j <= MaxNumNeigh; j++ ) {
+
+        double          d               = NeighDist ( i, j, NeighborhoodDistance );
+
+                                        // radius ends at the first neighbor further than the max distance
+        if ( d > MaxDistNeigh && NeighRadius[ i ] < 0 )
+            NeighRadius[ i ]    = n;
+
+                                        // !we need to have at least 3 data points to be able to remove 2 outliers, even if they are outside the limit!
+        if ( d > MaxDistNeigh && n - NeighStart[ i ] > SpatialFilterMinNeighbors )
+            break;                      // distances are sorted, we can stop here
+
+
+        NeighIndex [ n ]    = (int) NeighDist ( i, j, NeighborhoodIndex );
+                                        // - in case central value is used, its weight will be 1
+                                        // - note that some distances could be lower than 1, due to the average distance used for normalization, so the weight will be more than 1 on these points
+        NeighWeight[ n ]    = gaussianweights ? Gaussian ( GaussianSigmaToWidth ( d ), 0, 1, 1 )
+                                              : 1 / NonNull ( d );
+        n++;
+        } // for MaxNumNeigh
+
+    if ( NeighRadius[ i ] < 0 )
+        NeighRadius[ i ]    = n;
+    } // for numpoints
+
+
+NeighStart[ numpoints ] = n;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Is central point an outlier compared to its neighbors within radius?
+template <class TypeD>
+bool    TFilterSpatial<TypeD>::IsOutlier ( const TVector<TypeD>& map, int i, TEasyStats& stat )     const
+{
+stat.Reset ();
+                                        // stat of all neighbors below a given radius - central value excluded
+for ( int n = NeighStart[ i ] + 1; n < NeighRadius[ i ]; n++ )
+
+    stat.Add ( map[ NeighIndex[ n ] ], ThreadSafetyIgnore );
+
+
+double              delta           = stat.Range () * SpatialFilterExtraRange;
+double              reasonmin       = stat.Min   () - delta;
+double              reasonmax       = stat.Max   () + delta;
+
+                                        // If any of these 2 tests fail, the central point is an outlier
+return  ! IsInsideLimits ( (double) map[ i ], reasonmin, reasonmax )            // if central point is not within a reasonable margin from its neighbors
+       ||   fabs ( stat.ZScoreRobust ( map[ i ] ) ) > SpatialFilterZScoreMin;   // or Z-Score is not satisfying - Note that the robust version indeed works better
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Excludes the 2 outliers (min and max) of the whole neighborhood, central value included, then does a distance-weighted mean
+                                        // Only needs to locate the min and max, so there is no sorting nor any temp storage
+template <class TypeD>
+double  TFilterSpatial<TypeD>::InterseptileMean ( const TVector<TypeD>& map, int i )  const
+{
+int                 nmin            = NeighStart[ i ];
+int                 nmax            = NeighStart[ i ];
+
+for ( int n = NeighStart[ i ] + 1; n < NeighStart[ i + 1 ]; n++ ) {
+
+    if ( map[ NeighIndex[ n ] ] <  map[ NeighIndex[ nmin ] ] )  nmin    = n;
+    if ( map[ NeighIndex[ n ] ] >= map[ NeighIndex[ nmax ] ] )  nmax    = n;
+    }
+
+
+double              sumv            = 0;
+double              sumw            = 0;
+
+for ( int n = NeighStart[ i ]; n < NeighStart[ i + 1 ]; n++ ) {
+
+    if ( n == nmin || n == nmax )
+        continue;
+
+    sumv   += NeighWeight[ n ] * map[ NeighIndex[ n ] ];
+    sumw   += NeighWeight[ n ];
+    }
+
+
+return  sumv / NonNull ( sumw );
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Working buffers used by the filters, to be allocated once per thread outside any loop
+                                        // temp has no allocation, as it will be resized at its first copy of a map
+template <class TypeD>
+void    TFilterSpatial<TypeD>::AllocateScratch ( TVector<TypeD>& bads, TEasyStats& stat )   const
+{
+bads.Resize ( GetNumPoints () );
+                                        // all neighbors + center
+stat.Resize ( MaxNumNeigh + 1 );
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Single map call, allocating its own working buffers
 template <class TypeD>
 bool    TFilterSpatial<TypeD>::Apply ( TVector<TypeD>& map )
+{
+if ( How == SpatialFilterNone )
+    return  true;
+
+
+TVector<TypeD>      temp;
+TVector<TypeD>      bads;
+TEasyStats          stat;
+
+AllocateScratch ( bads, stat );
+
+
+return  Apply ( map, temp, bads, stat );
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Global dispatcher to the right function - although the specialized functions are directly callable, too
+template <class TypeD>
+bool    TFilterSpatial<TypeD>::Apply ( TVector<TypeD>& map, TVector<TypeD>& temp, TVector<TypeD>& bads, TEasyStats& stat )
 {
                                         // !Subtle difference here compared to the specialized functions: NO filtering will return TRUE, while the WRONG filter type will return FALSE!
 if ( How == SpatialFilterNone )
@@ -321,16 +494,16 @@ if ( ! IsDimensionOK ( map ) )
 
 
 if      ( How == SpatialFilterInterseptileWeightedMean
-       || How == SpatialFilterInterseptileGaussianMean  )   return  SpatialFilteringInterseptile        ( map );
+       || How == SpatialFilterInterseptileGaussianMean  )   return  SpatialFilteringInterseptile        ( map, temp );
 
-else if ( How == SpatialFilterOutlier                   )   return  SpatialFilteringInterpolate         ( map );
+else if ( How == SpatialFilterOutlier                   )   return  SpatialFilteringInterpolate         ( map, temp, stat );
 
-else if ( How == SpatialFilterOutliersGaussianMean      )   return  SpatialFilteringInterpolateSmooth   ( map );
-else if ( How == SpatialFilterOutliersWeightedMean      )   return  SpatialFilteringInterpolateSmooth   ( map );
+else if ( How == SpatialFilterOutliersGaussianMean      )   return  SpatialFilteringInterpolateSmooth   ( map, temp, bads, stat );
+else if ( How == SpatialFilterOutliersWeightedMean      )   return  SpatialFilteringInterpolateSmooth   ( map, temp, bads, stat );
 
 else if ( How == SpatialFilterMedian
        || How == SpatialFilterInterquartileMean
-       || How == SpatialFilterMinMax                    )   return  SpatialFilteringStat                ( map );
+       || How == SpatialFilterMinMax                    )   return  SpatialFilteringStat                ( map, temp, stat );
 
 
 return  true;
@@ -348,21 +521,35 @@ if ( ! IsDimensionOK ( data )
 
 
 int                 numel           = GetNumPoints ();
-TVector<TypeD>      temp ( numel );
 
+                                        // each time frame is independent, neighborhoods being shared and read-only
+OmpParallelBegin
+                                        // Allocate private objects once per thread
+TVector<TypeD>      map ( numel );
+TVector<TypeD>      temp;
+TVector<TypeD>      bads;
+TEasyStats          stat;
+
+AllocateScratch ( bads, stat );
+
+OmpFor
 
-for ( int tf0 = 0, tf = tfoffset; tf0 < numtf; tf0++, tf++ ) {
+for ( int tf0 = 0; tf0 < numtf; tf0++ ) {
+
+    int                 tf              = tfoffset + tf0;
 
     for ( int i = 0; i < numel; i++ )
-        temp[ i ]    = data ( i, tf );
+        map[ i ]    = data ( i, tf );
 
 
-    Apply ( temp );
+    Apply ( map, temp, bads, stat );
 
 
     for ( int i = 0; i < numel; i++ )
-        data ( i, tf )  = temp[ i ];
+        data ( i, tf )  = map[ i ];
     }
+
+OmpParallelEnd
 }
 
 
@@ -378,9 +565,21 @@ if ( maps.CheckNumMaps ( nummaps ) <= 0 )
     return;
 
 
+OmpParallelBegin
+                                        // Allocate private objects once per thread
+TVector<TMapAtomType>   temp;
+TVector<TMapAtomType>   bads;
+TEasyStats              stat;
+
+AllocateScratch ( bads, stat );
+
+OmpFor
+
 for ( int mi = 0; mi < nummaps; mi++ )
 
-    Apply ( maps[ mi ] );
+    Apply ( maps[ mi ], temp, bads, stat );
+
+OmpParallelEnd
 }
 
 
@@ -437,7 +636,7 @@ return  true;
 //----------------------------------------------------------------------------
                                         // Simpler statistical spatial filter
 template <class TypeD>
-bool    TFilterSpatial<TypeD>::SpatialFilteringStat ( TVector<TypeD>& map )
+bool    TFilterSpatial<TypeD>::SpatialFilteringStat ( TVector<TypeD>& map, TVector<TypeD>& temp, TEasyStats& stat )
 {
 if ( ! (    How == SpatialFilterMedian
          || How == SpatialFilterInterquartileMean
@@ -452,10 +651,8 @@ int                 numpoints       = GetNumPoints ();
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // + center
-TEasyStats          stat ( MaxNumNeigh + 1 /*NeighDist.GetDim2 ()*/ );
-
-TVector<TypeD>      temp ( map );
+                                        // stat is sized for all neighbors + center
+temp    = map;
 
 
 for ( int i = 0; i < numpoints; i++ ) {
@@ -463,15 +660,9 @@ for ( int i = 0; i < numpoints; i++ ) {
 
     stat.Reset ();
                                         // stat of all neighbors below a given radius - central value included (older version had center excluded)
-                                        // stops when either radius is further, or number of neghbors is reached
-    for ( int j = 0; j <= MaxNumNeigh; j++ ) {
+    for ( int n = NeighStart[ i ]; n < NeighRadius[ i ]; n++ )
 
-        if ( NeighDist ( i, j, NeighborhoodDistance ) > MaxDistNeigh )
-            break;                      // distances are sorted, we can stop here
-
-
-        stat.Add ( temp[ NeighDist ( i, j, NeighborhoodIndex ) ] );
-        } // for MaxNumNeigh
+        stat.Add ( temp[ NeighIndex[ n ] ], ThreadSafetyIgnore );
 
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -491,7 +682,7 @@ return  true;
 //----------------------------------------------------------------------------
                                         // Interpolation of bad electrodes only
 template <class TypeD>
-bool    TFilterSpatial<TypeD>::SpatialFilteringInterpolate ( TVector<TypeD>& map )
+bool    TFilterSpatial<TypeD>::SpatialFilteringInterpolate ( TVector<TypeD>& map, TVector<TypeD>& temp, TEasyStats& stat )
 {
 if ( How != SpatialFilterOutlier )
     return  false;
@@ -505,100 +696,14 @@ int                 numpoints       = GetNumPoints ();
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-TEasyStats          stat ( MaxNumNeigh /*NeighDist.GetDim2 ()*/ );
-bool                badcenter;
-double              delta;
-double              reasonmin;
-double              reasonmax;
-                                        // for distance and value sort
-TArray2<double>     neigh ( numpoints, /*NumNeighborhoodInfo*/ NumNeighborhoodInfoExt );
-
-
-int                 maxneigh;
-double              w;
-double              sumw;
-double              sumv;
-
-TVector<TypeD>      temp ( map );
-
+temp    = map;
 
-for ( int i = 0; i < numpoints; i++ ) {
-
-
-    stat.Reset ();
-                                        // stat of all neighbors below a given radius - central value excluded
-                                        // stops when either radius is further, or number of neghbors is reached
-    for ( int j = 1; j <= MaxNumNeigh; j++ ) {
-
-        if ( NeighDist ( i, j, NeighborhoodDistance ) > MaxDistNeigh )
-            break;                      // distances are sorted, we can stop here
-
-
-        stat.Add ( temp[ NeighDist ( i, j, NeighborhoodIndex ) ] );
-        } // for MaxNumNeigh
-
-
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Is central point an outlier?
-    delta       = stat.Range () * SpatialFilterExtraRange;
-    reasonmin   = stat.Min   () - delta;
-    reasonmax   = stat.Max   () + delta;
-
-                                        // If any of these 2 tests fail, interpolate the central point
-    badcenter   = ! IsInsideLimits ( (double) temp[ i ], reasonmin, reasonmax )         // if central point is not within a reasonable margin from its neighbors
-               ||   fabs ( stat.ZScoreRobust ( temp[ i ] ) ) > SpatialFilterZScoreMin;  // or Z-Score is not satisfying - Note that the robust version indeed works better
-
-
-    if ( ! badcenter )
-        continue;
-
-
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-    neigh       = Highest<double> ();   // sorting will be ascending
-    maxneigh    = 0;
-
-                                        // stat of all neighbors, including central value, below radius
-                                        // stops when either radius is further, or number of neighbors is reached
-    for ( int j = 0; j <= MaxNumNeigh; j++ ) {
-
-                                        // !we need to have at least 3 data points to be able to remove 2 outliers, even if they are outside the limit!
-        if ( NeighDist ( i, j, NeighborhoodDistance ) > MaxDistNeigh && maxneigh > SpatialFilterMinNeighbors )
-            break;                      // distances are sorted, we can stop here
-
-                                        // store values and distances
-//      neigh ( maxneigh, NeighborhoodIndex     )   =       NeighDist ( i, j, NeighborhoodIndex    );   // not actually needed
-
-        neigh ( maxneigh, NeighborhoodValue     )   = temp[ NeighDist ( i, j, NeighborhoodIndex    ) ];
-
-        neigh ( maxneigh, NeighborhoodDistance  )   =       NeighDist ( i, j, NeighborhoodDistance );
-
-        maxneigh++;
-        } // for MaxNumNeigh
-
-
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // sort by value
-    neigh.SortRows ( NeighborhoodValue, Ascending, maxneigh );
 
+for ( int i = 0; i < numpoints; i++ )
+                                        // interpolate the central point only if it is an outlier
+    if ( IsOutlier ( temp, i, stat ) )
                                         // exclude the 2 outliers (min and max) which is a bit more powerful than just removing the single central value
-                                        // then do a distance-weighted mean
-    sumv    = 0;
-    sumw    = 0;
-
-    for ( int j = 1; j < maxneigh - 1; j++ ) {
-                                        // weighted sum by distance
-                                        // - in case central value is used, its weight will be 1
-                                        // - note that some distances could be lower than 1, due to the average distance used for normalization, so the weight will be more than 1 on these points
-//      w       = 1 / NonNull ( neigh ( j, NeighborhoodDistance ) );
-        w       = Gaussian ( GaussianSigmaToWidth ( neigh ( j, NeighborhoodDistance ) ), 0, 1, 1 );
-        sumv   += w *                               neigh ( j, NeighborhoodValue    );
-        sumw   += w;
-        }
-
-
-    map[ i ]    = sumv / NonNull ( sumw );
-    } // for numpoints
+        map[ i ]    = InterseptileMean ( temp, i );
 
 
 return  true;
@@ -608,7 +713,7 @@ return  true;
 //----------------------------------------------------------------------------
                                         // Interpolation of bad electrodes + smoothing
 template <class TypeD>
-bool    TFilterSpatial<TypeD>::SpatialFilteringInterpolateSmooth ( TVector<TypeD>& map )
+bool    TFilterSpatial<TypeD>::SpatialFilteringInterpolateSmooth ( TVector<TypeD>& map, TVector<TypeD>& temp, TVector<TypeD>& bads, TEasyStats& stat )
 {
 if ( ! (    How == SpatialFilterOutliersGaussianMean
          || How == SpatialFilterOutliersWeightedMean ) )
@@ -622,50 +727,17 @@ int                 numpoints       = GetNumPoints ();
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Identify the bads electrodes first
-TVector<TypeD>      bads ( numpoints );
+                                        // Identify the bads electrodes first - bads is sized to numpoints
+temp    = map;
 
-TEasyStats          stat ( MaxNumNeigh /*NeighDist.GetDim2 ()*/ );
-double              delta;
-double              reasonmin;
-double              reasonmax;
 
-TVector<TypeD>      temp ( map );
+for ( int i = 0; i < numpoints; i++ )
 
-
-for ( int i = 0; i < numpoints; i++ ) {
-
-
-    stat.Reset ();
-                                        // stat of all neighbors below a given radius - central value excluded
-                                        // stops when either radius is further, or number of neghbors is reached
-    for ( int j = 1; j <= MaxNumNeigh; j++ ) {
-
-        if ( NeighDist ( i, j, NeighborhoodDistance ) > MaxDistNeigh )
-            break;                      // distances are sorted, we can stop here
-
-
-        stat.Add ( temp[ NeighDist ( i, j, NeighborhoodIndex ) ] );
-        } // for MaxNumNeigh
-
-
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Is central point an outlier?
-    delta       = stat.Range () * SpatialFilterExtraRange;
-    reasonmin   = stat.Min   () - delta;
-    reasonmax   = stat.Max   () + delta;
-
-                                        // If any of these 2 tests fail, assume this electrode is bad
-    bads[ i ]   = ! IsInsideLimits ( (double) temp[ i ], reasonmin, reasonmax )         // if central point is not within a reasonable margin from its neighbors
-               ||   fabs ( stat.ZScoreRobust ( temp[ i ] ) ) > SpatialFilterZScoreMin;  // or Z-Score is not satisfying - Note that the robust version indeed works better
-
-    } // for numpoints
+    bads[ i ]   = IsOutlier ( temp, i, stat );
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // Smoothing while ignoring the bads
-                                        // for distance and value sort
-double              w;
 double              sumw;
 double              sumv;
 
@@ -673,29 +745,16 @@ for ( int i = 0; i < numpoints; i++ ) {
                                         // use all data, which are supposed to be "not bad"
     sumv    = 0;
     sumw    = 0;
-                                        // stat of all neighbors, including central value, below radius
-                                        // stops when either radius is further, or number of neighbors is reached
-    for ( int j = 0; j <= MaxNumNeigh; j++ ) {
+                                        // all neighbors, including central value, below radius
+    for ( int n = NeighStart[ i ]; n < NeighRadius[ i ]; n++ ) {
 
                                         // skip the baddies - central or neighbor values
-        if ( bads[ NeighDist ( i, j, NeighborhoodIndex ) ] )
+        if ( bads[ NeighIndex[ n ] ] )
             continue;
 
-                                        // stop when too far off
-        if ( NeighDist ( i, j, NeighborhoodDistance ) > MaxDistNeigh )
-            break;                      // distances are sorted, we can stop here
-
                                         // weighted sum by distance
-                                        // - in case central value is used, its weight will be 1
-                                        // - note that some distances could be lower than 1, due to the average distance used for normalization, so the weight will be more than 1 on these points
-        if ( How == SpatialFilterOutliersGaussianMean )
-            w       = Gaussian ( GaussianSigmaToWidth ( NeighDist ( i, j, NeighborhoodDistance ) ), 0, 1, 1 );
-        else
-            w       = 1 / NonNull (      NeighDist ( i, j, NeighborhoodDistance ) );
-
-
-        sumv   += w *              temp[ NeighDist ( i, j, NeighborhoodIndex    ) ];
-        sumw   += w;
+        sumv   += NeighWeight[ n ] * temp[ NeighIndex[ n ] ];
+        sumw   += NeighWeight[ n ];
         }
 
                                         // check there remain (enough?) values in...
@@ -718,7 +777,7 @@ return  true;
                                         // This combines the robustness of the Median, and the smoothing of the Mean.
                                         // Globally, 1 pass is not as effective as the Median. We can chose to apply 2 passes, which has the side effect benefit of stabilizing an extrema that could have switch to a neighbor when in 1 pass.
 template <class TypeD>
-bool    TFilterSpatial<TypeD>::SpatialFilteringInterseptile ( TVector<TypeD>& map )
+bool    TFilterSpatial<TypeD>::SpatialFilteringInterseptile ( TVector<TypeD>& map, TVector<TypeD>& temp )
 {
 if ( ! (    How == SpatialFilterInterseptileWeightedMean
          || How == SpatialFilterInterseptileGaussianMean ) )
@@ -730,74 +789,12 @@ if ( ! (    How == SpatialFilterInterseptileWeightedMean
 
 int                 numpoints       = GetNumPoints ();
 
+temp    = map;
 
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // for distance and value sort
-TArray2<double>     neigh ( numpoints, /*NumNeighborhoodInfo*/ NumNeighborhoodInfoExt );
-
-
-int                 maxneigh;
-double              w;
-double              sumw;
-double              sumv;
-
-TVector<TypeD>      temp ( map );
-
-
-for ( int i = 0; i < numpoints; i++ ) {
-
-
-    neigh       = Highest<double> ();   // sorting will be ascending
-    maxneigh    = 0;
-
-                                        // stat of all neighbors, including central value, below radius
-                                        // stops when either radius is further, or number of neighbors is reached
-    for ( int j = 0; j <= MaxNumNeigh; j++ ) {
-
-                                        // !we need to have at least 3 data points to be able to remove 2 outliers, even if they are outside the limit!
-        if ( NeighDist ( i, j, NeighborhoodDistance ) > MaxDistNeigh && maxneigh > SpatialFilterMinNeighbors )
-            break;                      // distances are sorted, we can stop here
-
-                                        // store values and distances
-//      neigh ( maxneigh, NeighborhoodIndex     )   =       NeighDist ( i, j, NeighborhoodIndex    );   // not actually needed
-
-        neigh ( maxneigh, NeighborhoodValue     )   = temp[ NeighDist ( i, j, NeighborhoodIndex    ) ];
-
-        neigh ( maxneigh, NeighborhoodDistance  )   =       NeighDist ( i, j, NeighborhoodDistance );
 
-        maxneigh++;
-        } // for MaxNumNeigh
-
-
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // sort by value
-    neigh.SortRows ( NeighborhoodValue, Ascending, maxneigh );
-
-
-    sumv    = 0;
-    sumw    = 0;
-
-                                        // exclude the 2 outliers (min and max), then do a distance-weighted mean
-    for ( int j = 1; j < maxneigh - 1; j++ ) {
-
-        if ( How == SpatialFilterInterseptileGaussianMean )
-                                        // does less filtering than inverse distance
-            w   = Gaussian ( GaussianSigmaToWidth ( neigh ( j, NeighborhoodDistance ) ), 0, 1, 1 );
-
-        else // SpatialFilterInterseptileWeightedMean, SpatialFilterOutlier
-                                        // weighted sum by distance
-                                        // - in case central value is used, its weight will be 1
-                                        // - note that some distances could be lower than 1, due to the average distance used for normalization, so the weight will be more than 1 on these points
-            w   = 1 / NonNull ( neigh ( j, NeighborhoodDistance ) );
-
-
-        sumv   += w *           neigh ( j, NeighborhoodValue    );
-        sumw   += w;
-        }
-
-
-    map[ i ]    = sumv / NonNull ( sumw );
-    } // for numpoints
+for ( int i = 0; i < numpoints; i++ )
+                                        // Gaussian weights do less filtering than inverse distance
+    map[ i ]    = InterseptileMean ( temp, i );
 
 
 return  true;
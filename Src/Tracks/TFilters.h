@@ -24,6 +24,7 @@ limitations under the License.
                                         // Non-temporal filters
 #include    "TFilters.Spatial.h"
 #include    "TFilters.Ranking.h"
+#include    "TFilters.RecursiveGaussian.h"
 #include    "TFilters.Reference.h"
 #include    "TFilters.Rectification.h"
 #include    "TFilters.Threshold.h"
@@ -15,6 +15,8 @@ limitations under the License.
 \************************************************************************/
 
 #include    <set>
+#include    <vector>
+#include    <algorithm>
 
 #include    "TMaps.h"
 
@@ -180,7 +182,7 @@ Maxed ( downsampling, 1 );
 
 
 int                 nummaps         = Truncate ( op.NumMaps / downsampling );
-int                 dimension       = op.Dimension - ( ignoretracks ? ignoretracks->NumSet () : 0 );
+int                 dimension       = op.Dimension - ( ignoretracks ? ignoretracks->NumSet ( 0, op.Dimension - 1 ) : 0 );
 
                                         // new size, requesting n complete input samples for 1 output sample
 Resize ( nummaps, dimension );
@@ -205,7 +207,7 @@ else                                // skipping some tracks
     for ( int mi = 0; mi < maxnummapsin; mi++ )
     for ( int el0 = 0, el = 0; el < op.Dimension; el++ )
 
-        if ( ignoretracks->IsSelected ( el ) )
+        if ( ! ignoretracks->IsSelected ( el ) )
 
             Maps[ mi / downsampling ][ el0++ ] += op[ mi ][ el ];
 
@@ -1287,25 +1289,80 @@ if ( how == CorrelateTypeCircularCircular ) {
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+if ( how == CorrelateTypeLinearLinear ) {
+                                        // Pearson correlation of all pairs: centering and norms are done once per map,
+                                        // then each pair is a single scalar product - same operations as TVector::Correlation, so same results
+    bool                centeraverage   = reference == ReferenceAverage;
+    int                 dim             = maps1.GetDimension ();
+    TArray2<double>     centered1 ( maps1.GetNumMaps (), dim );
+    TArray2<double>     centered2 ( maps2.GetNumMaps (), dim );
+    TVector<double>     norm1     ( maps1.GetNumMaps () );
+    TVector<double>     norm2     ( maps2.GetNumMaps () );
+
+    auto                CenterMaps      = [ centeraverage, dim ] ( TMaps& maps, TArray2<double>& centered, TVector<double>& norm )
+    {
+    OmpParallelFor
+
+    for ( int nc = 0; nc < maps.GetNumMaps (); nc++ ) {
+
+        double              avg             = centeraverage ? maps[ nc ].Average () : 0;
+
+        norm[ nc ]  = 0;
+
+        for ( int i = 0; i < dim; i++ ) {
+            centered ( nc, i )  = maps ( nc, i ) - avg;
+            norm[ nc ]         += centered ( nc, i ) * centered ( nc, i );
+            }
+        }
+    };
+
+    CenterMaps ( maps1, centered1, norm1 );
+    CenterMaps ( maps2, centered2, norm2 );
+
+
+    OmpParallelFor
+
+    for ( int nc1 = 0; nc1 < maps1.GetNumMaps (); nc1++ )
+    for ( int nc2 = 0; nc2 < maps2.GetNumMaps (); nc2++ ) {
+
+        const double*       c1              = &centered1 ( nc1, 0 );
+        const double*       c2              = &centered2 ( nc2, 0 );
+        double              sum             = 0;
+
+        for ( int i = 0; i < dim; i++ )
+            sum    += c1[ i ] * c2[ i ];
+
+        double              c               = sum == 0 || norm1[ nc1 ] == 0 || norm2[ nc2 ] == 0 ? 0 : Clip ( sum / sqrt ( norm1[ nc1 ] * norm2[ nc2 ] ), -1.0, 1.0 );
+
+        Maps[ nc1 ][ nc2 ] = polarity == PolarityDirect ? c : fabs ( c );
+        }
+    }
+
+else {
+
+    OmpParallelBegin
                                         // temp variables - allocated once by the called functions, then reused on each call
-TVector<float>      map1;
-TVector<float>      map2;
-double              corr;
+    TVector<float>      map1;
+    TVector<float>      map2;
 
+    OmpFor
 
-for ( int nc1 = 0; nc1 < maps1.GetNumMaps (); nc1++ )
-for ( int nc2 = 0; nc2 < maps2.GetNumMaps (); nc2++ ) {
+    for ( int nc1 = 0; nc1 < maps1.GetNumMaps (); nc1++ )
+    for ( int nc2 = 0; nc2 < maps2.GetNumMaps (); nc2++ ) {
 
-    corr    = how == CorrelateTypeLinearLinear          ? maps1[ nc1 ].Correlation                      ( maps2[ nc2 ], polarity, reference == ReferenceAverage               )
-            : how == CorrelateTypeLinearLinearRobust    ? maps1[ nc1 ].CorrelationSpearman              ( maps2[ nc2 ], polarity, reference == ReferenceAverage               )
-            : how == CorrelateTypeLinearCircular        ? maps1[ nc1 ].CorrelationLinearCircular        ( maps2[ nc2 ],           reference == ReferenceAverage, map1, map2   )
-            : how == CorrelateTypeLinearCircularRobust  ? maps1[ nc1 ].CorrelationLinearCircularRobust  ( maps2[ nc2 ]                                                  )
-            : how == CorrelateTypeCircularLinear        ? maps2[ nc2 ].CorrelationLinearCircular        ( maps1[ nc1 ],           reference == ReferenceAverage, map1, map2   )
-            : how == CorrelateTypeCircularLinearRobust  ? maps2[ nc2 ].CorrelationLinearCircularRobust  ( maps1[ nc1 ]                                                  )
-            : how == CorrelateTypeCircularCircular      ? 0
-                                                        : 0;
+        double  c   = how == CorrelateTypeLinearLinearRobust    ? maps1[ nc1 ].CorrelationSpearman              ( maps2[ nc2 ], polarity, reference == ReferenceAverage               )
+                    : how == CorrelateTypeLinearCircular        ? maps1[ nc1 ].CorrelationLinearCircular        ( maps2[ nc2 ],           reference == ReferenceAverage, map1, map2   )
+                    : how == CorrelateTypeLinearCircularRobust  ? maps1[ nc1 ].CorrelationLinearCircularRobust  ( maps2[ nc2 ]                                                  )
+                    : how == CorrelateTypeCircularLinear        ? maps2[ nc2 ].CorrelationLinearCircular        ( maps1[ nc1 ],           reference == ReferenceAverage, map1, map2   )
+                    : how == CorrelateTypeCircularLinearRobust  ? maps2[ nc2 ].CorrelationLinearCircularRobust  ( maps1[ nc1 ]                                                  )
+                    : how == CorrelateTypeCircularCircular      ? 0
+                                                                : 0;
+
+        Maps[ nc1 ][ nc2 ] = c; // PearsonToFisher ( c )
+        }
 
-    Maps[ nc1 ][ nc2 ] = corr; // PearsonToFisher ( corr )
+    OmpParallelEnd
     }
 
 
@@ -1321,6 +1378,9 @@ pvalues->Resize ( NumMaps, Dimension );
 int                 dim1            = maps1.GetDimension ();
 TMap                shuffle1    ( dim1 );
 TVector<int>        count       ( maps2.GetNumMaps () );
+TVector<float>      map1;
+TVector<float>      map2;
+double              corr;
 TRandUniform        randunif;
 int                 offset;
 double              p;
@@ -1540,7 +1600,7 @@ if ( mapsel == 0 )
                                         // time can be restricted to an epoch (limits are not tested here)
     for ( long tf = tfmin; tf <= tfmax; tf++ ) {
 
-        Cartool.UpdateApplication ();
+        Cartool.UpdateApplicationThrottled ();
 
         double          maxcorr     = Lowest ( maxcorr );
                                         // most of the time (segmentation) we use all maps
@@ -1558,7 +1618,7 @@ else
                                         // time can be restricted to an epoch (limits are not tested here)
     for ( long tf = tfmin; tf <= tfmax; tf++ ) {
 
-        Cartool.UpdateApplication ();
+        Cartool.UpdateApplicationThrottled ();
 
         double          maxcorr     = Lowest ( maxcorr );
                                         // maps can be restricted to a given subset (fitting)
@@ -1699,7 +1759,7 @@ OmpParallelFor
 
 for ( int dimi = 0; dimi < Dimension; dimi += stepdim ) {
 
-    Cartool.UpdateApplication ();
+    Cartool.UpdateApplicationThrottled ();
 
 
     for ( int mi = 0; mi < NumMaps; mi++ ) {
@@ -1931,7 +1991,7 @@ OmpParallelFor
 
 for ( int dimi = 0; dimi < Dimension; dimi += stepdim ) {
 
-    Cartool.UpdateApplication ();
+    Cartool.UpdateApplicationThrottled ();
 
 
     for ( int mi = 0; mi < NumMaps; mi++ ) {
@@ -3293,16 +3353,36 @@ else if ( filtertype == FilterTypeEnvelopePeak          )   filter  = new TFilte
 else if ( filtertype == FilterTypeEnvelopeAnalytic      )   filter  = new TFilterEnvelope<double> ( FilterTypeEnvelopeAnalytic,      SamplingFrequency, params[ FilterParamEnvelopeWidth ] );
 
                                         // data is not ordered for time filters, load every line at a time to perform the filtering...
-for ( int i = 0; i < GetDimension (); i++ ) {
+if ( filter ) {
+                                        // lines are independent, and filters can be shared across threads - only the line buffer is per thread
+    OmpParallelBegin
+
+    TVector<double>     line;
+
+    OmpFor
+
+    for ( int i = 0; i < GetDimension (); i++ ) {
+
+        line.GetRow ( *this, i );
 
-    line.GetRow ( *this, i );
+        filter->Apply ( line.GetArray (), line.GetDim () );
 
-    if ( filter )   filter->Apply ( line.GetArray (), line.GetDim () );
-    else            line.Filter ( filtertype, params, showprogress );
+        line.SetRow ( *this, i );
+        }
 
-    line.SetRow ( *this, i );
+    OmpParallelEnd
     }
 
+else                                    // generic filtering, which can show some progress bar
+    for ( int i = 0; i < GetDimension (); i++ ) {
+
+        line.GetRow ( *this, i );
+
+        line.Filter ( filtertype, params, showprogress );
+
+        line.SetRow ( *this, i );
+        }
+
 
 if ( filter )
     delete  filter;
@@ -3493,18 +3573,22 @@ if ( ! IsZScoreSigned ( how ) )
 
 bool                scanmaxes       = how & ZScoreMaxData;
 int                 dimension       = Dimension;
-TEasyStats          stat ( scanmaxes ? NumMaps / 2 : NumMaps );
-double              center;
-double              sd;
 
 
 zscorevalues.Resize ( NumZValuesCalibration, dimension );
 
                                         // ZScoreSigned_CenterScale is the only case here
+OmpParallelBegin
+
+TEasyStats          stat ( scanmaxes ? NumMaps / 2 : NumMaps );
+double              center;
+double              sd;
+
+OmpFor
 
 for ( int e = 0; e < dimension; e++ ) {
 
-    Cartool.UpdateApplication ();
+    Cartool.UpdateApplicationThrottled ();
 
 
     stat.Reset ();
@@ -3553,6 +3637,7 @@ for ( int e = 0; e < dimension; e++ ) {
         
     } // for dimension
 
+OmpParallelEnd
 }
 
 
@@ -3581,7 +3666,7 @@ OmpParallelFor
 for ( int nc = 0; nc < NumMaps; nc++ )
 for ( int e = 0; e < dimension; e++ ) {
 
-    Cartool.UpdateApplication ();
+    Cartool.UpdateApplicationThrottled ();
 
 
     double          center      = zscorevalues ( NumZValuesCenter , e );
@@ -3595,9 +3680,64 @@ for ( int e = 0; e < dimension; e++ ) {
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Z-Score calibration helpers, shared by the resampled, robust estimations below
+                                        // Optimal sample size for a given number of data
+void    SetZScoreResampling ( TResampling& resampling, int numdata, int numresampling )
+{
+resampling.SetNumData       ( numdata );
+
+resampling.SetNumResampling ( numresampling );
+
+resampling.GetSampleSize    ( TMapsResamplingCoverage, TMapsMinSampleSize, Round ( resampling.NumData * TMapsMaxSampleSizeRatio ) );
+}
+
+                                        // Each point has its own random series, which depends only on the seed and the point index,
+                                        // so results are the same whatever the number of threads or the scheduling
+                                        // A null seed keeps on with the per-thread random generator, as before
+void    ReloadZScoreRandom ( TRandUniform& randunif, UINT seed, int e )
+{
+if ( seed )
+    randunif.Reload ( seed + (UINT) e );
+}
+
+                                        // Same result as TEasyStats::MADLeft, but re-using the caller's buffer, and with a partial selection instead of a full sort
+double  MADLeftSelect ( const TEasyStats& stats, double center, vector<float>& deviations )
+{
+deviations.clear ();
+
+for ( int i = 0; i < stats.GetNumItems (); i++ ) {
+
+    double      d       = stats[ i ] - center;
+
+    if ( d < 0 )    deviations.push_back ( (float) d );
+    }
+
+
+int                 numdev          = (int) deviations.size ();
+
+if ( numdev == 0 )
+    return  0;
+
+                                        // upper median
+int                 halfi           = numdev / 2;
+
+nth_element ( deviations.begin (), deviations.begin () + halfi, deviations.end () );
+
+float               median          = deviations[ halfi ];
+
+                                        // even number of items: average with the lower median, which is the max of the lower half
+if ( IsEven ( numdev ) )
+    median  = ( median + *max_element ( deviations.begin (), deviations.begin () + halfi ) ) / 2;
+
+return  fabs ( median ) * MADToSigma;
+}
+
+
 //----------------------------------------------------------------------------
                                         // Standardizing the norm of 3D vectors (scalar, positive data)
-void    TMaps::ComputeZScorePositive    (   ZScoreType  how,    TArray2<float>&     zscorevalues    )   const
+                                        // Solution points are calibrated in parallel, each thread owning its stats & buffers
+void    TMaps::ComputeZScorePositive    (   ZScoreType  how,    TArray2<float>&     zscorevalues,   UINT    seed    )   const
 {
 if ( IsNotAllocated () )
     return;
@@ -3611,42 +3751,51 @@ if ( ! IsZScorePositive ( how ) )
 
 bool                scanmaxes       = how & ZScoreMaxData;
 int                 dimensionsp     = Dimension;
-TEasyStats          stat    ( scanmaxes ? NumMaps / 2 : NumMaps );
-double              norm;
-TArray1<double>     normal  ( NumMaps );
-double              center;
-double              sd;
-TRandUniform        randunif;
 
-TResampling         resampling;
 #if defined (_DEBUG)
 int                 numresampling       = 1;
 #else
 int                 numresampling       = TMapsNumResampling;
 #endif
-TEasyStats          statcenter ( NumMaxModeRobustEstimates * numresampling );   // using 4 estimators for the center
-TEasyStats          statsd     ( 1 * numresampling );   // using only 1 estimator for the spreading
-TEasyStats          substats;
-TVector<int>        randindex;
                                         // caller can be specific about the dimensions, it could be 6 in case of vectorial ris from complex data
                                         // otherwise assumes dimensions are 3 (though better if specified by the caller)
 double              (*vectornormtonormal) ( double )    = how & ZScoreDimension6 ? Vector6NormToNormal : Vector3NormToNormal;
 
+                                        // when using all data, all points have the same number of items, hence the same resampling
+TResampling         resamplingall;
+
+if ( ! scanmaxes )
+    SetZScoreResampling ( resamplingall, NumMaps, numresampling );
+
 
 zscorevalues.Resize ( NumZValuesCalibration, dimensionsp );
 
+
+OmpParallelBegin
+
+TEasyStats          stat    ( scanmaxes ? NumMaps / 2 : NumMaps );
+TArray1<double>     normal  ( NumMaps );
+double              center;
+double              sd;
+TRandUniform        randunif;
+TResampling         resampling      = resamplingall;
+TEasyStats          statcenter ( NumMaxModeRobustEstimates * numresampling );   // using 4 estimators for the center
+TEasyStats          statsd     ( 1 * numresampling );   // using only 1 estimator for the spreading
+TEasyStats          substats;
+TVector<int>        randindex;
+vector<float>       deviations;
+
                                         // work on the norm of vector
+OmpFor
+
 for ( int e = 0; e < dimensionsp; e++ ) {
 
-    Cartool.UpdateApplication ();
+    Cartool.UpdateApplicationThrottled ();
 
                                         // scan ALL data, we need the norm and normal values on everything
-    for ( int nc = 0; nc < NumMaps; nc++ ) {
-                                        // data is already the norm
-        norm            = Maps[ nc ][ e ];
-                                        // Deskew the data, converting norm to Normal
-        normal ( nc )   = vectornormtonormal ( norm );
-        } // for map
+    for ( int nc = 0; nc < NumMaps; nc++ )
+                                        // data is already the norm - Deskew the data, converting norm to Normal
+        normal ( nc )   = vectornormtonormal ( Maps[ nc ][ e ] );
 
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -3685,19 +3834,15 @@ for ( int e = 0; e < dimensionsp; e++ ) {
         }
     else {
                                         // most of the cases
-                                        
+
 //      center      = stat.Mean ();                 // regular Z-Score
 //      center      = min ( stat.MaxModeHRM (), stat.MaxModeHistogram () );
 
-                                        // getting the optimal resampling size - could be done per electrode
-        if ( e == 0 || scanmaxes ) {
-
-            resampling.SetNumData       ( stat.GetNumItems () );
+                                        // getting the optimal resampling size for this point
+        if ( scanmaxes )
+            SetZScoreResampling ( resampling, stat.GetNumItems (), numresampling );
 
-            resampling.SetNumResampling ( numresampling );
-
-            resampling.GetSampleSize    ( TMapsResamplingCoverage, TMapsMinSampleSize, Round ( resampling.NumData * TMapsMaxSampleSizeRatio ) );
-            }
+        ReloadZScoreRandom ( randunif, seed, e );
 
 
         statcenter.Reset ();
@@ -3722,16 +3867,13 @@ for ( int e = 0; e < dimensionsp; e++ ) {
 
 
         statsd .Reset ();
-        double              madleft;
-//      double              madright;
                                         // resampling & using for different stats at the same time
         for ( int i = 0; i < numresampling; i++ ) {
 
             stat.Resample ( substats, resampling.SampleSize, randindex, &randunif );
 
                                         // optimal on the left part of center - the background activity should be only here
-            substats.MADLeft    ( center, madleft );
-            statsd.Add          ( madleft, ThreadSafetyIgnore );
+            statsd.Add          ( MADLeftSelect ( substats, center, deviations ), ThreadSafetyIgnore );
 
                                         // optimal on both the left and right parts of center - in between value, takes into account both background and high activities
 //          statsd.Add          ( substats.InterQuartileRange () );
@@ -3742,36 +3884,6 @@ for ( int e = 0; e < dimensionsp; e++ ) {
             }
 
         sd          = statsd.Median ( false );
-
-
-        //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-/*                                      // re-compute with a restricted dataset
-        stat.Reset ();
-
-        for ( int nc = 0; nc < NumMaps; nc++ )
-                                        // put only data reasonably close to center - including on the right
-            if ( normal ( nc ) < 2 * center )
-
-                stat.Add ( normal ( nc ) );
-
-
-
-        statsd .Reset ();
-                                        // resampling & using for different stats at the same time
-        for ( int i = 0; i < numresampling; i++ ) {
-
-            stat.Resample ( substats, resampling.SampleSize, randindex, &randunif );
-                                        // symmetrical estimates
-            double      s1      = substats.SD   ();
-            double      s2      = substats.MAD  ( center );
-            double      s3      = substats.Sn   ( 500 );    // costly
-
-            statsd.Add          ( s1 );
-            statsd.Add          ( s2 );
-            statsd.Add          ( s3 );
-            }
-        sd          = statsd .Median ( false );
-*/
         }
 
 
@@ -3780,6 +3892,7 @@ for ( int e = 0; e < dimensionsp; e++ ) {
 
     } // for dimension
 
+OmpParallelEnd
 }
 
 
@@ -3814,7 +3927,7 @@ OmpParallelFor
 for ( int nc = 0; nc < NumMaps; nc++ )
 for ( int e = 0; e < dimensionsp; e++ ) {
 
-    Cartool.UpdateApplication ();
+    Cartool.UpdateApplicationThrottled ();
 
 
     double      center      = zscorevalues ( NumZValuesCenter , e );
@@ -3889,7 +4002,7 @@ for ( int e = 0; e < dimensionsp; e++ ) {
 
 //----------------------------------------------------------------------------
                                         // Standardizing the norm of 3D vectorial data
-void    TMaps::ComputeZScoreVectorial   (   ZScoreType  how,    TArray2<float>&   zscorevalues ) const
+void    TMaps::ComputeZScoreVectorial   (   ZScoreType  how,    TArray2<float>&   zscorevalues,     UINT    seed    ) const
 {
 if ( IsNotAllocated () )
     return;
@@ -3913,26 +4026,21 @@ if      ( how & ZScoreVectorial_CenterScaleByComponent ) {
 
 bool                scanmaxes       = how & ZScoreMaxData;
 int                 dimensionsp     = Dimension / 3;
-TEasyStats          stat    ( scanmaxes ? NumMaps / 2 : NumMaps );
-double              norm;
-TArray1<double>     normal ( NumMaps );
-double              center;
-double              sd;
-TRandUniform        randunif;
 
-TResampling         resampling;
 #if defined (_DEBUG)
 int                 numresampling       = 1;
 #else
 int                 numresampling       = TMapsNumResampling;
 #endif
-TEasyStats          statcenter ( NumMaxModeRobustEstimates * numresampling );
-TEasyStats          statsd     ( 1 * numresampling );
-TEasyStats          substats;
-TVector<int>        randindex;
 
+                                        // when using all data, all points have the same number of items, hence the same resampling
+TResampling         resamplingall;
 
-//if ( how & ( ZScoreVectorial_CenterVectors_CenterScale 
+if ( ! scanmaxes )
+    SetZScoreResampling ( resamplingall, NumMaps, numresampling );
+
+
+//if ( how & ( ZScoreVectorial_CenterVectors_CenterScale
 //           | ZScoreVectorial_CenterVectors_Scale       ) )
                                         // Center to mean vector, first step of Vectorial Z-Score
     //TimeCentering ();                 // !to be done!
@@ -3940,20 +4048,36 @@ TVector<int>        randindex;
 
 zscorevalues.Resize ( NumZValuesCalibration, dimensionsp );
 
+
+OmpParallelBegin
+
+TEasyStats          stat    ( scanmaxes ? NumMaps / 2 : NumMaps );
+TArray1<double>     normal ( NumMaps );
+double              center;
+double              sd;
+TRandUniform        randunif;
+TResampling         resampling      = resamplingall;
+TEasyStats          statcenter ( NumMaxModeRobustEstimates * numresampling );
+TEasyStats          statsd     ( 1 * numresampling );
+TEasyStats          substats;
+TVector<int>        randindex;
+vector<float>       deviations;
+
                                         // work on the norm of vector
-for ( int e1 = 0, e3 = 0; e1 < dimensionsp; e1++, e3 += 3 ) {
+OmpFor
 
-    Cartool.UpdateApplication ();
+for ( int e1 = 0; e1 < dimensionsp; e1++ ) {
+
+    Cartool.UpdateApplicationThrottled ();
+
+    int                 e3              = 3 * e1;
 
                                         // Once centered, we look for the spreading, but norm is skewed, so un-skew first
-    for ( int nc = 0; nc < NumMaps; nc++ ) {
+    for ( int nc = 0; nc < NumMaps; nc++ )
                                         // recover & Deskew the norms of the vectors
-        norm            = sqrt ( Square ( Maps[ nc ][ e3     ] )      
-                               + Square ( Maps[ nc ][ e3 + 1 ] )
-                               + Square ( Maps[ nc ][ e3 + 2 ] ) );
-
-        normal ( nc )   = Vector3NormToNormal ( norm );
-        } // for map
+        normal ( nc )   = Vector3NormToNormal ( sqrt ( Square ( Maps[ nc ][ e3     ] )
+                                                     + Square ( Maps[ nc ][ e3 + 1 ] )
+                                                     + Square ( Maps[ nc ][ e3 + 2 ] ) ) );
 
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -3996,15 +4120,11 @@ for ( int e1 = 0, e3 = 0; e1 < dimensionsp; e1++, e3 += 3 ) {
 //      sd          = stat.SD   ();
 //      sd          = stat.InterQuartileRange ();
 
-                                        // getting the optimal resampling size - could be done per electrode
-        if ( e1 == 0 || scanmaxes ) {
-
-            resampling.SetNumData       ( stat.GetNumItems () );
+                                        // getting the optimal resampling size for this point
+        if ( scanmaxes )
+            SetZScoreResampling ( resampling, stat.GetNumItems (), numresampling );
 
-            resampling.SetNumResampling ( numresampling );
-
-            resampling.GetSampleSize    ( TMapsResamplingCoverage, TMapsMinSampleSize, Round ( resampling.NumData * TMapsMaxSampleSizeRatio ) );
-            }
+        ReloadZScoreRandom ( randunif, seed, e1 );
 
 
         statcenter.Reset ();
@@ -4022,16 +4142,13 @@ for ( int e1 = 0, e3 = 0; e1 < dimensionsp; e1++, e3 += 3 ) {
         //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
         statsd .Reset ();
-        double              madleft;
-//      double              madright;
                                         // resampling & using for different stats at the same time
         for ( int i = 0; i < numresampling; i++ ) {
 
             stat.Resample ( substats, resampling.SampleSize, randindex, &randunif );
 
                                         // optimal on the left part of center - the background activity should be only here
-            substats.MADLeft    ( center, madleft );
-            statsd.Add          ( madleft, ThreadSafetyIgnore );
+            statsd.Add          ( MADLeftSelect ( substats, center, deviations ), ThreadSafetyIgnore );
 
                                         // optimal on both the left and right parts of center - in between value, takes into account both background and high activities
 //          statsd.Add          ( substats.InterQuartileRange () );
@@ -4056,6 +4173,7 @@ for ( int e1 = 0, e3 = 0; e1 < dimensionsp; e1++, e3 += 3 ) {
 
     } // for dimension
 
+OmpParallelEnd
 }
 
 
@@ -4103,7 +4221,7 @@ OmpParallelFor
 for ( int nc = 0; nc < NumMaps; nc++ )
 for ( int e1 = 0, e3 = 0; e1 < dimensionsp; e1++, e3 += 3 ) {
 
-    Cartool.UpdateApplication ();
+    Cartool.UpdateApplicationThrottled ();
 
 
     double      center      = zscorevalues ( NumZValuesCenter , e1 );
@@ -4155,15 +4273,15 @@ for ( int e1 = 0, e3 = 0; e1 < dimensionsp; e1++, e3 += 3 ) {
 
 
 //----------------------------------------------------------------------------
-void    TMaps::ComputeZScore ( ZScoreType how, TArray2<float>& zscorevalues )   const
+void    TMaps::ComputeZScore ( ZScoreType how, TArray2<float>& zscorevalues, UINT seed )   const
 {
 if ( ! IsZScore ( how ) )
     return;
 
 //DBGM ( "Start", "ComputeZScore" );
 
-if      ( IsZScoreVectorial ( how ) )   ComputeZScoreVectorial ( how, zscorevalues );
-else if ( IsZScorePositive  ( how ) )   ComputeZScorePositive  ( how, zscorevalues );
+if      ( IsZScoreVectorial ( how ) )   ComputeZScoreVectorial ( how, zscorevalues, seed );
+else if ( IsZScorePositive  ( how ) )   ComputeZScorePositive  ( how, zscorevalues, seed );
 else if ( IsZScoreSigned    ( how ) )   ComputeZScoreSigned    ( how, zscorevalues );
 
 //DBGM ( "Finished", "ComputeZScore" );
@@ -4220,11 +4338,11 @@ else if ( IsZScoreSigned    ( how ) )   ApplyZScoreSigned    ( how, zscorevalues
 
 //----------------------------------------------------------------------------
                                         // Conveniently wrapping the two processing into 1
-void    TMaps::ZScore ( ZScoreType how, TArray2<float>* tozscorevalues )
+void    TMaps::ZScore ( ZScoreType how, TArray2<float>* tozscorevalues, UINT seed )
 {
 TArray2<float>      zscorevalues;
 
-ComputeZScore      ( how, zscorevalues );
+ComputeZScore      ( how, zscorevalues, seed );
 
 ApplyZScore        ( how, zscorevalues );
 
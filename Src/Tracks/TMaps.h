@@ -123,6 +123,8 @@ constexpr double    TMapsResamplingCoverage     = 0.95;
 constexpr int       TMapsMinSampleSize          = 1000;
 //constexpr double  TMapsMaxSampleSizeRatio     = 0.95;
 constexpr double    TMapsMaxSampleSizeRatio     = 0.50;
+                                        // Fixed seed for the Z-Score calibrations, so that the same data always give the same factors
+constexpr UINT      TMapsZScoreSeed             = 0x5eed;
 
                                         // not given a name here, as we want to be able to either pass on of these flags, or a valid, positive, fixed index
 enum                {
@@ -198,10 +200,11 @@ public:
     void            ComputeGFP                  ( TArray1<double> &gfp,  ReferenceType reference, AtomType datatype ) const;
     double          ComputeGfpNormalization     ( AtomType datatype );
     void            ComputeNorm                 ( TArray1<double> &norm, ReferenceType reference );
-    void            ComputeZScore               ( ZScoreType how, TArray2<float>& zscorevalues )    const;
-    void            ComputeZScoreSigned         ( ZScoreType how, TArray2<float>& zscorevalues )    const;
-    void            ComputeZScorePositive       ( ZScoreType how, TArray2<float>& zscorevalues )    const;
-    void            ComputeZScoreVectorial      ( ZScoreType how, TArray2<float>& zscorevalues )    const;
+                                                // seed != 0 gives reproducible calibrations, independently of the number of threads
+    void            ComputeZScore               ( ZScoreType how, TArray2<float>& zscorevalues, UINT seed = 0 ) const;
+    void            ComputeZScoreSigned         ( ZScoreType how, TArray2<float>& zscorevalues )                const;
+    void            ComputeZScorePositive       ( ZScoreType how, TArray2<float>& zscorevalues, UINT seed = 0 ) const;
+    void            ComputeZScoreVectorial      ( ZScoreType how, TArray2<float>& zscorevalues, UINT seed = 0 ) const;
     void            Correlate                   ( TMaps& maps1, TMaps& maps2, CorrelateType how, PolarityType polarity, ReferenceType reference, int numrand = 0, TMaps* pvalues = 0, char* infix = 0 );
     bool            Covariance3DVectorial       ( AMatrix33& Cov, const TSelection* tfok = 0 )      const;
     bool            FilterSpatial               ( SpatialFilterType filtertype, const char *xyzfile );
@@ -230,7 +233,7 @@ public:
     void            ZPositiveToZSigned          ();
     void            ZPositiveToZSignedAuto      ();
     void            ZPositiveAuto               ();
-    void            ZScore                      ( ZScoreType how, TArray2<float>* tozscorevalues = 0 );
+    void            ZScore                      ( ZScoreType how, TArray2<float>* tozscorevalues = 0, UINT seed = TMapsZScoreSeed );
 
                                         // Functions used during segmentation / fitting
     void            CentroidsToLabeling         ( const TMaps& data, long tfmin, long tfmax, int nclusters, const TSelection *mapsel, TLabeling& labels, PolarityType polarity, double limitcorr )   const;
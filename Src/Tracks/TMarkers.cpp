@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 \************************************************************************/
 
+#include    <algorithm>
+
 #include    "Dialogs.Input.h"
 #include    "Strings.Grep.h"
 #include    "Files.Utils.h"
@@ -294,6 +296,7 @@ TriggerColors.GLize ( hn );
 TracksDoc           = 0;
 MarkersFileName.Clear ();
 MarkersDirty        = false;
+UpdateIndex ();
 }
 
                                         // Sets MarkersDirty; Sorting
@@ -311,6 +314,7 @@ MarkersDirty        = SetMarkers ( markerslist ) != NoMarkersError;     // updat
 {
 MarkersFileName.Clear ();
 MarkersDirty        = false;
+UpdateIndex ();
 }
 
                                         // Sets MarkersDirty; Sorting
@@ -336,6 +340,8 @@ if ( ! IsEmpty () )
 
                                         // delete content & structure
 Markers.Reset ( Deallocate );
+                                        // an empty list is sorted
+UpdateIndex ();
 }
 
 
@@ -565,6 +571,36 @@ if ( IsEmpty () )
     return  false;
 
 
+if ( IsIndexValid () ) {
+                                        // all markers overlapping the range are within these indexes
+    int                 firsti          = IndexFirstMaxToAtLeast ( timemin );
+    int                 lasti           = IndexLastFromAtMost    ( timemax );
+
+                                        // first overlapping marker of the right type
+    for ( int i = firsti; i <= lasti; i++ )
+
+        if ( IsFlag ( Markers[ i ]->Type, type ) && Markers[ i ]->To >= timemin ) {
+            indexmin = i;
+            break;
+            }
+
+    if ( indexmin == -1 )
+        return false;
+
+                                        // last marker of the right type starting before the end of range
+    indexmax = indexmin;
+
+    for ( int i = lasti; i > indexmin; i-- )
+
+        if ( IsFlag ( Markers[ i ]->Type, type ) ) {
+            indexmax = i;
+            break;
+            }
+
+    return  true;
+    }
+
+
                                         // find first trigger to consider
 for ( int i = 0; i < (int) Markers; i++ )
 
@@ -605,8 +641,8 @@ if ( IsEmpty () )
 
 
 if ( forward ) {
-
-    for ( int i = 0; i < (int) Markers; i++ )
+                                        // markers starting before current one can not be candidates
+    for ( int i = IsIndexValid () ? IndexFirstFromAtLeast ( marker.From ) : 0; i < (int) Markers; i++ )
 
         if ( IsFlag ( Markers[ i ]->Type, type ) )
 
@@ -618,8 +654,8 @@ if ( forward ) {
                 }
     }
 else { // backward
-
-    for ( int i = (int) Markers - 1; i >= 0; i-- )
+                                        // markers starting after current one can not be candidates
+    for ( int i = IsIndexValid () ? IndexLastFromAtMost ( marker.To ) : (int) Markers - 1; i >= 0; i-- )
 
         if ( IsFlag ( Markers[ i ]->Type, type ) )
 
@@ -645,8 +681,8 @@ marker.Set ( tfc->GetPosMin (), tfc->GetPosMax () );
 
 
 if ( forward ) {
-
-    for ( int i = 0; i < (int) Markers; i++ )
+                                        // markers starting before current one can not be candidates
+    for ( int i = IsIndexValid () ? IndexFirstFromAtLeast ( marker.From ) : 0; i < (int) Markers; i++ )
 
         if ( IsFlag ( Markers[ i ]->Type, type ) )
 
@@ -659,8 +695,8 @@ if ( forward ) {
                 }
     }
 else {
-
-    for ( int i = (int) Markers - 1; i >= 0; i-- )
+                                        // markers starting after current one can not be candidates
+    for ( int i = IsIndexValid () ? IndexLastFromAtMost ( marker.To ) : (int) Markers - 1; i >= 0; i-- )
 
         if ( IsFlag ( Markers[ i ]->Type, type ) )
 
@@ -727,6 +763,8 @@ if ( removedduplicates ) {
                                         // rebuild indexes
     Markers.UpdateIndexes ( true );
 
+    UpdateIndex ();
+
     return  MarkersRemovedDuplicate;
     }
 else
@@ -740,6 +778,8 @@ void    TMarkers::SortMarkers ()
 _Sort ( 0, GetNumMarkers () - 1 );
 
 Markers.UpdateIndexes ( true );
+
+UpdateIndex ();
 }
 
                                         // Works directly with atoms from the list
@@ -768,6 +808,56 @@ if ( i < r )    _Sort ( i, r );
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Index of the sorted markers, used to answer position queries with binary searches
+                                        // Markers overlapping [from..to] all lie within  [ IndexFirstMaxToAtLeast ( from ) .. IndexLastFromAtMost ( to ) ]
+                                        // Caller has to make sure the list is currently sorted
+void    TMarkers::UpdateIndex ()
+{
+int                 nummarkers      = GetNumMarkers ();
+
+IndexFrom .resize ( nummarkers );
+IndexMaxTo.resize ( nummarkers );
+
+
+for ( int i = 0; i < nummarkers; i++ ) {
+
+    IndexFrom [ i ] = Markers[ i ]->From;
+    IndexMaxTo[ i ] = i == 0 ? Markers[ i ]->To : max ( IndexMaxTo[ i - 1 ], Markers[ i ]->To );
+    }
+
+
+MarkersIndexed  = true;
+}
+
+
+void    TMarkers::ResetIndex ()
+{
+IndexFrom .clear ();
+IndexMaxTo.clear ();
+
+MarkersIndexed  = false;
+}
+
+                                        // First marker starting at or after pos, or GetNumMarkers () if none
+int     TMarkers::IndexFirstFromAtLeast ( long pos )   const
+{
+return  (int) ( lower_bound ( IndexFrom.begin (), IndexFrom.end (), pos ) - IndexFrom.begin () );
+}
+
+                                        // Last marker starting at or before pos, or -1 if none
+int     TMarkers::IndexLastFromAtMost ( long pos )   const
+{
+return  (int) ( upper_bound ( IndexFrom.begin (), IndexFrom.end (), pos ) - IndexFrom.begin () ) - 1;
+}
+
+                                        // First marker from which some marker ends at or after pos, or GetNumMarkers () if none
+int     TMarkers::IndexFirstMaxToAtLeast ( long pos )   const
+{
+return  (int) ( lower_bound ( IndexMaxTo.begin (), IndexMaxTo.end (), pos ) - IndexMaxTo.begin () );
+}
+
+
 //----------------------------------------------------------------------------
 const TMarker*  TMarkers::GetMarker ( const char* markername )  const
 {
@@ -797,6 +887,15 @@ TMarker*            markercopy      = new TMarker ( marker );
 if ( TracksDoc )
     Clipped ( markercopy->From, markercopy->To, (long) 0, TracksDoc->GetNumTimeFrames () - 1 );
 
+                                        // appending in order keeps the index valid, f.ex. when reading files
+if ( IsIndexValid () && ( Markers.IsEmpty () || *markercopy >= *Markers.GetLast () ) ) {
+
+    IndexFrom .push_back ( markercopy->From );
+    IndexMaxTo.push_back ( IndexMaxTo.empty () ? markercopy->To : max ( IndexMaxTo.back (), markercopy->To ) );
+    }
+else
+    ResetIndex ();
+
                                         // just put it at the end
 Markers.Append ( markercopy );
 
@@ -886,9 +985,14 @@ if ( TracksDoc && marker.IsNotOverlappingInterval ( (long) 0, TracksDoc->GetNumT
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-int                 inserti;
+int                 inserti         = indexfrom ? *indexfrom : 0;
+
+                                        // markers starting before the new one will not be beyond it
+if ( IsIndexValid () )
+    Maxed ( inserti, IndexFirstFromAtLeast ( marker.From ) );
+
                                         // we might have an optional index from where to start searching (insertion sort)
-for ( inserti = indexfrom ? *indexfrom : 0; inserti < (int) Markers; inserti++ )
+for ( ; inserti < (int) Markers; inserti++ )
                                         // stop at first element in the list that is beyond marker
     if ( Markers ( inserti ) > marker )
 
@@ -908,6 +1012,21 @@ if ( TracksDoc )
     Clipped ( markercopy->From, markercopy->To, (long) 0, TracksDoc->GetNumTimeFrames () - 1 );
 
 
+                                        // updating the index in place, unless clipping could have changed the order
+if ( IsIndexValid () && markercopy->From == marker.From ) {
+
+    long                maxto           = inserti == 0 ? markercopy->To : max ( IndexMaxTo[ inserti - 1 ], markercopy->To );
+
+    IndexFrom .insert ( IndexFrom .begin () + inserti, markercopy->From );
+    IndexMaxTo.insert ( IndexMaxTo.begin () + inserti, maxto            );
+                                        // next running max can only increase, up to the first one already beyond the new marker
+    for ( int i = inserti + 1; i < (int) IndexMaxTo.size () && IndexMaxTo[ i ] < markercopy->To; i++ )
+        IndexMaxTo[ i ] = markercopy->To;
+    }
+else
+    ResetIndex ();
+
+
 if ( inserti == (int) Markers ) Markers.Append ( markercopy );      // nothing past marker?
 else                            Markers.Insert ( markercopy, Markers[ inserti ] );
 
@@ -1586,6 +1705,14 @@ bool    TMarkers::IsOverlapping (   long        mintf,  long        maxtf   )
 if ( IsEmpty () )
     return  false;
 
+                                        // first marker from which some marker could reach mintf - overlapping if it starts before maxtf
+if ( IsIndexValid () ) {
+
+    int                 firsti          = IndexFirstMaxToAtLeast ( mintf );
+
+    return  firsti < GetNumMarkers () && IndexFrom[ firsti ] <= maxtf;
+    }
+
 
 for ( int i = 0; i < (int) Markers; i++ )
 
@@ -1641,6 +1768,10 @@ for ( int i = 0; i < (int) Markers; i++ ) {
     Markers[ i ]->From   = TruncateTo ( Markers[ i ]->From, downsampling );
     Markers[ i ]->To     = TruncateTo ( Markers[ i ]->To  , downsampling );
     }
+
+                                        // order has not changed, but positions did
+if ( MarkersIndexed )
+    UpdateIndex ();
 }
 
 
@@ -1655,6 +1786,9 @@ for ( int i = 0; i < (int) Markers; i++ ) {
     Markers[ i ]->From  /= downsampling;
     Markers[ i ]->To    /= downsampling;
     }
+
+if ( MarkersIndexed )
+    UpdateIndex ();
 }
 
 
@@ -1671,6 +1805,9 @@ for ( int i = 0; i < (int) Markers; i++ ) {
                                         //   - ending to last upsampled TF
     Markers[ i ]->To     = ( Markers[ i ]->To + 1 ) * upsampling - 1;
     }
+
+if ( MarkersIndexed )
+    UpdateIndex ();
 }
 
                                         // reslice all markers to sequences of 1 TF markers
@@ -1751,6 +1888,10 @@ long   TMarkers::GetMinPosition ( MarkerType type )   const
 {
 long                minpos          = Highest ( minpos );
 
+                                        // first marker is the earliest
+if ( type == AllMarkerTypes && IsIndexValid () && IsNotEmpty () )
+    return  IndexFrom.front ();
+
 
 for ( int i = 0; i < (int) Markers; i++ )
     if ( IsFlag ( Markers[ i ]->Type, type ) )
@@ -1765,6 +1906,9 @@ long   TMarkers::GetMaxPosition ( MarkerType type )   const
 {
 long                maxpos          = Lowest ( maxpos );
 
+if ( type == AllMarkerTypes && IsIndexValid () && IsNotEmpty () )
+    return  IndexMaxTo.back ();
+
 
 for ( int i = 0; i < (int) Markers; i++ )
     if ( IsFlag ( Markers[ i ]->Type, type ) )
@@ -1949,6 +2093,10 @@ else {
         Markers.Append ( markersok[ i ] );  // just copy the pointer
     }
 
+                                        // remaining markers are still in order
+if ( MarkersIndexed )
+    UpdateIndex ();
+
 
 MarkersDirty    = true;
 }
@@ -1996,6 +2144,10 @@ else {
         Markers.Append ( markersok[ i ] );  // just copy the pointer
     }
 
+                                        // remaining markers are still in order
+if ( MarkersIndexed )
+    UpdateIndex ();
+
 
 MarkersDirty    = true;
 }
@@ -2066,6 +2218,8 @@ for ( int i = 0; i < (int) Markers; i++ ) {
 
 Markers.Reset ( DontDeallocate );       // some objects are already deleted, only clear-up the pointers now
 
+ResetIndex ();
+
 
 InsertMarkers ( clippedtags );          // first copy the data..
 
@@ -2122,6 +2276,10 @@ else {
         Markers.Append ( markersok[ i ] );  // just copy the pointer
     }
 
+                                        // remaining markers are still in order
+if ( MarkersIndexed )
+    UpdateIndex ();
+
 
 MarkersDirty    = true;
 }
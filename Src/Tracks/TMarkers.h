@@ -16,6 +16,8 @@ limitations under the License.
 
 #pragma once
 
+#include    <vector>
+
 #include    "Files.TFileName.h"
 #include    "OpenGL.Colors.h"           // TGLColoring
 
@@ -292,6 +294,18 @@ protected:
     TFileName       MarkersFileName;
     bool            MarkersDirty;           // Only set for Append / Insert / Remove operations - any error can be checked by testing returned values
 
+                                            // Index over the sorted markers, for position queries in log time
+    bool                MarkersIndexed;     // set only when markers are sorted and the index up to date
+    std::vector<long>   IndexFrom;          // starting positions, increasing
+    std::vector<long>   IndexMaxTo;         // running max of the ending positions, also increasing
+
+    bool            IsIndexValid            ()      const       { return    MarkersIndexed && (int) IndexFrom.size () == Markers.Num (); }
+    void            UpdateIndex             ();                                                     // from a sorted list
+    void            ResetIndex              ();                                                     // any change in positions or order
+    int             IndexFirstFromAtLeast   ( long pos )    const;
+    int             IndexLastFromAtMost     ( long pos )    const;
+    int             IndexFirstMaxToAtLeast  ( long pos )    const;
+
 
     void            _Sort  ( int l, int r );
 
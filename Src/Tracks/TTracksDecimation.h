@@ -0,0 +1,267 @@
+/************************************************************************\
+ 2024-2025 Denis Brunet, University of Geneva, Switzerland.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+\************************************************************************/
+
+#pragma once
+
+#include    <vector>
+#include    <algorithm>
+
+namespace crtl {
+
+//----------------------------------------------------------------------------
+                                        // Multi-resolution min/max decimation of a set of tracks
+                                        //  - Each track owns a pyramid of (min,max) blocks, of sizes 2^DecimationMinBlockLog2 * 2^level
+                                        //  - Pyramids are built lazily, on the first query of a given track, from the caller's data
+                                        //  - Queries return the exact min/max of each screen column, in O(log(range)) per column
+                                        //  - Does not know anything about OpenGL nor documents, so it can be used & tested on its own
+                                        // Caller has to Reset the object whenever the content of its data has changed
+//----------------------------------------------------------------------------
+                                        // Smallest block is 16 samples, which makes the pyramid about 1/8 of the data size
+constexpr int       DecimationMinBlockLog2      = 4;
+constexpr int       DecimationMinBlockSize      = 1 << DecimationMinBlockLog2;
+
+
+template <class TypeD>
+class   TTracksDecimation
+{
+public:
+                    TTracksDecimation ();
+                    TTracksDecimation ( int numtracks, int numpoints );
+
+
+    void            Reset   ();                                 // invalidates all pyramids, keeps the dimensions
+    void            Set     ( int numtracks, int numpoints );   // new dimensions, invalidates all pyramids
+
+
+    int             GetNumTracks    ()              const   { return  (int) Pyramids.size (); }
+    int             GetNumPoints    ()              const   { return  NumPoints; }
+    bool            IsBuilt         ( int track )   const   { return  track >= 0 && track < GetNumTracks () && Pyramids[ track ].Built; }
+
+    void            Build           ( int track, const TypeD* data );
+                                        // data is the full track, of NumPoints samples; from and to are inclusive
+    void            GetMinMax       ( int track, const TypeD* data, int from, int to, TypeD& minv, TypeD& maxv );
+                                        // Splits [from..to] into numcolumns consecutive intervals, and returns the min/max of each of them
+    int             GetColumns      ( int track, const TypeD* data, int from, int to, int numcolumns, TypeD* colmin, TypeD* colmax );
+
+
+protected:
+
+    class   TPyramid
+    {
+    public:
+        bool                Built;
+        std::vector<TypeD>  Min;
+        std::vector<TypeD>  Max;
+        std::vector<int>    LevelOrigin;    // offset of each level into Min & Max
+    };
+
+    int                     NumPoints;
+    std::vector<TPyramid>   Pyramids;
+
+};
+
+
+//----------------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------------
+template <class TypeD>
+        TTracksDecimation<TypeD>::TTracksDecimation ()
+{
+NumPoints       = 0;
+}
+
+
+template <class TypeD>
+        TTracksDecimation<TypeD>::TTracksDecimation ( int numtracks, int numpoints )
+{
+Set ( numtracks, numpoints );
+}
+
+
+template <class TypeD>
+void    TTracksDecimation<TypeD>::Reset ()
+{
+for ( auto& pyramid : Pyramids )
+    pyramid.Built   = false;
+}
+
+
+template <class TypeD>
+void    TTracksDecimation<TypeD>::Set ( int numtracks, int numpoints )
+{
+NumPoints       = numpoints > 0 ? numpoints : 0;
+
+Pyramids.resize ( numtracks > 0 ? numtracks : 0 );
+
+Reset ();
+}
+
+
+//----------------------------------------------------------------------------
+template <class TypeD>
+void    TTracksDecimation<TypeD>::Build ( int track, const TypeD* data )
+{
+if ( track < 0 || track >= GetNumTracks () || data == 0 )
+    return;
+
+
+TPyramid&           pyramid         = Pyramids[ track ];
+
+pyramid.LevelOrigin.clear ();
+                                        // count how many full blocks each level holds
+int                 numtotal        = 0;
+
+for ( int numblocks = NumPoints >> DecimationMinBlockLog2; numblocks > 0; numblocks >>= 1 ) {
+
+    pyramid.LevelOrigin.push_back ( numtotal );
+
+    numtotal   += numblocks;
+    }
+
+pyramid.Min.resize ( numtotal );
+pyramid.Max.resize ( numtotal );
+
+if ( numtotal == 0 ) {
+    pyramid.Built   = true;
+    return;
+    }
+
+                                        // first level straight from the data
+int                 numblocks       = NumPoints >> DecimationMinBlockLog2;
+const TypeD*        todata          = data;
+
+for ( int b = 0; b < numblocks; b++ ) {
+
+    TypeD               minv            = *todata;
+    TypeD               maxv            = *todata;
+
+    for ( int i = 0; i < DecimationMinBlockSize; i++, todata++ ) {
+        if ( *todata < minv )   minv    = *todata;
+        if ( *todata > maxv )   maxv    = *todata;
+        }
+
+    pyramid.Min[ b ]    = minv;
+    pyramid.Max[ b ]    = maxv;
+    }
+
+                                        // next levels merge pairs of blocks from the previous level
+for ( int level = 1; level < (int) pyramid.LevelOrigin.size (); level++ ) {
+
+    int                 prev            = pyramid.LevelOrigin[ level - 1 ];
+    int                 curr            = pyramid.LevelOrigin[ level     ];
+
+    numblocks >>= 1;
+
+    for ( int b = 0; b < numblocks; b++ ) {
+        pyramid.Min[ curr + b ] = std::min ( pyramid.Min[ prev + 2 * b ], pyramid.Min[ prev + 2 * b + 1 ] );
+        pyramid.Max[ curr + b ] = std::max ( pyramid.Max[ prev + 2 * b ], pyramid.Max[ prev + 2 * b + 1 ] );
+        }
+    }
+
+
+pyramid.Built   = true;
+}
+
+
+//----------------------------------------------------------------------------
+template <class TypeD>
+void    TTracksDecimation<TypeD>::GetMinMax ( int track, const TypeD* data, int from, int to, TypeD& minv, TypeD& maxv )
+{
+if ( from < 0             )     from    = 0;
+if ( to   > NumPoints - 1 )     to      = NumPoints - 1;
+
+if ( from > to || data == 0 ) {
+    minv    = maxv  = 0;
+    return;
+    }
+
+                                        // no pyramid for this track? we can still scan the raw data
+bool                usepyramid      = track >= 0 && track < GetNumTracks ();
+
+if ( usepyramid && ! IsBuilt ( track ) )
+    Build ( track, data );
+
+
+minv    = maxv  = data[ from ];
+
+int                 i               = from;
+
+while ( i <= to ) {
+                                        // raw samples, until we reach a full & aligned block
+    if ( ! usepyramid || ( i & ( DecimationMinBlockSize - 1 ) ) || i + DecimationMinBlockSize - 1 > to ) {
+
+        if ( data[ i ] < minv )     minv    = data[ i ];
+        if ( data[ i ] > maxv )     maxv    = data[ i ];
+        i++;
+        continue;
+        }
+
+    const TPyramid&     pyramid         = Pyramids[ track ];
+    int                 level           = 0;
+                                        // then climb up as long as the bigger block is still aligned and within range
+    while ( level + 1 < (int) pyramid.LevelOrigin.size () ) {
+
+        int     nextsize    = DecimationMinBlockSize << ( level + 1 );
+
+        if ( ( i & ( nextsize - 1 ) ) || i + nextsize - 1 > to )
+            break;
+
+        level++;
+        }
+
+
+    int                 b               = pyramid.LevelOrigin[ level ] + ( i >> ( DecimationMinBlockLog2 + level ) );
+
+    if ( pyramid.Min[ b ] < minv )  minv    = pyramid.Min[ b ];
+    if ( pyramid.Max[ b ] > maxv )  maxv    = pyramid.Max[ b ];
+
+    i  += DecimationMinBlockSize << level;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+template <class TypeD>
+int     TTracksDecimation<TypeD>::GetColumns ( int track, const TypeD* data, int from, int to, int numcolumns, TypeD* colmin, TypeD* colmax )
+{
+if ( from < 0             )     from    = 0;
+if ( to   > NumPoints - 1 )     to      = NumPoints - 1;
+
+int                 numpoints       = to - from + 1;
+
+if ( numpoints <= 0 || numcolumns <= 0 || colmin == 0 || colmax == 0 )
+    return  0;
+
+if ( numcolumns > numpoints )
+    numcolumns  = numpoints;
+
+                                        // columns boundaries are spread evenly, so that they always cover the whole range
+for ( int c = 0; c < numcolumns; c++ ) {
+
+    int     colfrom     = from + (int) ( ( (long long) numpoints *   c       ) / numcolumns );
+    int     colto       = from + (int) ( ( (long long) numpoints * ( c + 1 ) ) / numcolumns ) - 1;
+
+    GetMinMax ( track, data, colfrom, colto, colmin[ c ], colmax[ c ] );
+    }
+
+return  numcolumns;
+}
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+}
@@ -112,6 +112,11 @@ NumParts        = 0;
                                         // some refreshing operations are really slow, don't do them all the time but only on intervals
 TitleLastTimeCalled     =
 WindowLastTimeCalled    = GetWindowsTimeInMillisecond ();
+ValueLastTimeCalled     = 0;
+ShownValue              = -1;
+
+PendingSteps.clear ();
+Canceled        = false;
 
 
 DisplayedValue  = 0;
@@ -286,6 +291,13 @@ if ( part >= NumParts ) {
     Range .Resize ( NumParts, (MemoryAllocationType) ( MemoryAuto | ResizeKeepMemory ) );
     Count .Resize ( NumParts, (MemoryAllocationType) ( MemoryAuto | ResizeKeepMemory ) );
     Occupy.Resize ( NumParts, (MemoryAllocationType) ( MemoryAuto | ResizeKeepMemory ) );
+                                        // atomics can not be moved around, so allocate a new vector and transfer the values
+    std::vector<std::atomic<int>>   pending ( NumParts );
+
+    for ( int i = 0; i < NumParts; i++ )
+        pending[ i ]    = i < (int) PendingSteps.size () ? PendingSteps[ i ].load () : 0;
+
+    PendingSteps.swap ( pending );
     }
 
                                         // Here part is within existing NumParts
@@ -403,12 +415,25 @@ Occupy     *= 100 / NonNull ( totaloccupy );
 
 
 //----------------------------------------------------------------------------
-                                        // !step will be rescaled by the number of current threads, in case we are in a parallel block!
+                                        // Can be called from any thread: steps from the other threads are accumulated, then accounted for by the main thread
 void    TSuperGauge::Next ( int part, SuperGaugeUpdate update, int step )
 {
-if ( ! IsAlive () )
+if ( Gauge == 0 )
     return;
 
+                                        // other threads only publish their progress, at the cost of an atomic increment
+                                        // parts are not added during the parallel processing, so the size of PendingSteps is constant here
+if ( ! IsMainThread () ) {
+
+    if ( part == SuperGaugeDefaultPart )
+        part    = CurrentPart;
+
+    if ( IsInsideLimits ( part, 0, (int) PendingSteps.size () - 1 ) )
+        PendingSteps[ part ]   += step;
+
+    return;
+    }
+
 
 if ( part == SuperGaugeDefaultPart )
     part    = CurrentPart;
@@ -419,8 +444,10 @@ if ( ! IsInsideLimits ( part, 0, NumParts - 1 ) )
 //assert ( IsInsideLimits ( part, 0, NumParts - 1 ) );
 //#endif
                                         // !sign of step is not tested, so it is valid to actually decrease the progress bar!
-                                        // !we also extrapolate the stepping with the current amount of active threads (this could be erroneous if not ALL threads are allocated to the processing being monitored)!
-SetValue ( part, Count ( part ) + step * StepThread () );
+                                        // main thread also collects all the steps done by the other threads so far
+FlushPendingSteps ();
+
+SetValue ( part, Count ( part ) + step );
 
                                         // this one is optional, there might be multiple gauge at once, not all should be allowed to update the title
 if ( update == SuperGaugeUpdateTitle ) {
@@ -487,6 +514,8 @@ if ( ! IsInsideLimits ( part, 0, NumParts - 1 ) )
 //assert ( IsInsideLimits ( part, 0, NumParts - 1 ) );
 //#endif
 
+                                        // steps from the other threads are accounted for in all parts, though this part is then overwritten by the explicit value
+FlushPendingSteps ();
                                         // avoid weird under- or over-flow, done per part
 Count ( part )  = Clip ( value, 0, Range ( part ) );
 
@@ -494,6 +523,16 @@ Count ( part )  = Clip ( value, 0, Range ( part ) );
 Show ( GetTotalCount () );
 }
 
+                                        // Transfer the steps published by the other threads into the counters - display is left to the caller
+void    TSuperGauge::FlushPendingSteps ()
+{
+for ( int i = 0; i < (int) PendingSteps.size (); i++ )
+
+    if ( PendingSteps[ i ] != 0 )
+
+        Count ( i )     = Clip ( Count ( i ) + PendingSteps[ i ].exchange ( 0 ), 0, Range ( i ) );
+}
+
                                         // Update the range at some point, f.ex. when the actual range is known well after the creation of the gauge / part
                                         // it should not affect the display thanks to the occupy mechanism
 void    TSuperGauge::SetRange ( int part, int range )
@@ -557,8 +596,19 @@ void    TSuperGauge::Actualize ( int displayvalue )
 if ( ! IsAlive () )
     return;
 
-                                        // retrieving and setting window position is super costly, just ask once in a while only
 ULONGLONG           now             = GetWindowsTimeInMillisecond ();
+
+                                        // same value as currently displayed, and refreshed recently enough: no need to bother the window and the messages
+if ( displayvalue == ShownValue && now - ValueLastTimeCalled < SuperGaugeRefreshDelayValue )
+    return;
+
+ValueLastTimeCalled     = now;
+
+                                        // polling the cancellation only at refresh time
+if ( VkEscape () )
+    Canceled    = true;
+
+                                        // retrieving and setting window position is super costly, just ask once in a while only
                                         // using a much greater time period than for the title
 if ( now - WindowLastTimeCalled > SuperGaugeRefreshDelayWindow ) {
 
@@ -574,8 +624,10 @@ if ( now - WindowLastTimeCalled > SuperGaugeRefreshDelayWindow ) {
     }
 
 
-if ( displayvalue >= 0 )
+if ( displayvalue >= 0 ) {
     Gauge->SetValue ( displayvalue );
+    ShownValue  = displayvalue;
+    }
 
 Gauge->UpdateWindow ();
 
@@ -650,6 +702,8 @@ Actualize ( DisplayedValue );
 void    TSuperGauge::Finished ()
 {
 if ( IsAlive () ) {
+                                        // any remaining steps from the other threads
+    FlushPendingSteps ();
 
 //  Gauge->Create ();                   // force show the window
     crtl::WindowRestore ( Gauge );      // or simply restore window
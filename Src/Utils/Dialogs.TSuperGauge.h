@@ -17,6 +17,8 @@ limitations under the License.
 #pragma once
 
 #include    <owl/gauge.h>
+#include    <atomic>
+#include    <vector>
 
 #include    "System.h"
 #include    "WindowingUtils.h"
@@ -57,6 +59,7 @@ constexpr int       SuperGaugeMaxTitle          = 256;
 constexpr int       SuperGaugeDefaultPart       = -1;
 constexpr int       SuperGaugeDefaultOccupy     = -1;
 
+constexpr ULONGLONG SuperGaugeRefreshDelayValue     =   30;
 constexpr ULONGLONG SuperGaugeRefreshDelayTitle     =   50;
 constexpr ULONGLONG SuperGaugeRefreshDelayWindow    = 1000;
 
@@ -85,12 +88,14 @@ public:
                    ~TSuperGauge ();
 
 
-    int             CurrentPart;                    // set by caller, when passed to a function that doesn't know which part to update
+    std::atomic<int>    CurrentPart;                // set by caller, when passed to a function that doesn't know which part to update - also read by the other threads
 
 
     bool            IsAlive         ()  const                   { return    Gauge != 0 && IsMainThread ();  }           // gauge is in use, and this is the main thread
     bool            IsNotAlive      ()  const                   { return    ! IsAlive ();                   }           // gauge is not in use, or not the main thread
     bool            IsDone          ()  const                   { return    DisplayedValue == TotalRange;   }           // counter reached max - to avoid possible rounding problems, another way would be to explcitly check all Count are at max
+    bool            IsCanceled      ()  const                   { return    Canceled;                       }           // user asked to stop, through the Escape key - cheap enough to be tested by any thread, from any loop
+    void            ResetCanceled   ()                          { Canceled  = false;                        }           // f.ex. when user did not confirm the cancellation
 
 
     void            Reset           ();
@@ -112,7 +117,7 @@ public:
     bool            IsStyleCount        ()  const               { return    Style & SuperGaugeCount;      }
 
 
-    void            Next        ( int part = SuperGaugeDefaultPart, SuperGaugeUpdate update = SuperGaugeNoTitle, int step = 1 );   // increment current counter & update - !accounts for multithreading!
+    void            Next        ( int part = SuperGaugeDefaultPart, SuperGaugeUpdate update = SuperGaugeNoTitle, int step = 1 );   // increment current counter & update - can be called from any thread, only the main thread will refresh the display
     void            SetValue    ( int part, int value );                                        // directly set the counter value & update - use SuperGaugeDefaultPart for CurrentPart
     int             GetRange    ( int part = SuperGaugeDefaultPart );
     void            SetRange    ( int part, int range );                                        // udpate the range, in case we know it only later - use SuperGaugeDefaultPart for CurrentPart
@@ -153,14 +158,20 @@ protected:
     TArray1<int>    Count;
     TVector<double> Occupy;
     int             NumParts;
+    ULONGLONG       ValueLastTimeCalled;                    // we might want to restrain the number of calls to refresh
     ULONGLONG       TitleLastTimeCalled;                    // we might want to restrain the number of calls to refresh
     ULONGLONG       WindowLastTimeCalled;                   // we might want to restrain the number of calls to refresh
 
+    std::vector<std::atomic<int>>   PendingSteps;           // per part, steps published by the other threads, waiting for the main thread to account for them
+    std::atomic<bool>   Canceled;
+
     int             DisplayedValue;
+    int             ShownValue;                             // actual value in the gauge window, which can differ from DisplayedValue while blinking
     int             TotalRange;
 
 
     void            UpdateVariables ();
+    void            FlushPendingSteps ();                   // main thread only
     void            Show            ( int value );          // actually set a value on the gauge, then update
 
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include    "Strings.Utils.h"
 #include    "Strings.TStrings.h"
 #include    "Strings.Grep.h"
+#include    "Files.Stream.h"
 
 #include    "TMicroStatesFitDialog.h"   // FitSubjectNameLong
 
@@ -155,6 +156,7 @@ protected:
     char            LocaleListSeparator[ SpreadSheetSeparatorListSize ];    // depends on the user settings...
 
     std::ofstream*  OutStream;          // in write mode
+    TStreamTextBuffer OutBuffer;        // records are formatted here, then written by big blocks
     bool            OutNewRecord;
     char            OutListSeparator[ SpreadSheetSeparatorListSize ];
 };
@@ -513,12 +515,12 @@ return  ! OutStream->fail ();
 void    TSpreadSheet::WriteAttribute ( const char* sattr, int iattr )
 {
 if ( ! OutNewRecord )
-    *OutStream << OutListSeparator;
+    OutBuffer.AppendText ( OutListSeparator );
 
-*OutStream << sattr;
+OutBuffer.AppendText ( sattr );
 
 if ( iattr >= 0 )
-    *OutStream << iattr;
+    OutBuffer.AppendInteger ( iattr, 0 );
 
 OutNewRecord        = false;
 }
@@ -527,20 +529,20 @@ OutNewRecord        = false;
 void    TSpreadSheet::WriteAttribute ( int iattr )
 {
 if ( ! OutNewRecord )
-    *OutStream << OutListSeparator;
+    OutBuffer.AppendText ( OutListSeparator );
 
-*OutStream << iattr;
+OutBuffer.AppendInteger ( iattr, 0 );
 
 OutNewRecord        = false;
 }
 
-
+                                        // same as default stream formatting
 void    TSpreadSheet::WriteAttribute ( float fattr )
 {
 if ( ! OutNewRecord )
-    *OutStream << OutListSeparator;
+    OutBuffer.AppendText ( OutListSeparator );
 
-*OutStream << fattr;
+OutBuffer.AppendGeneral ( fattr, 6 );
 
 OutNewRecord        = false;
 }
@@ -549,7 +551,9 @@ OutNewRecord        = false;
 void    TSpreadSheet::WriteNextRecord ()
 {
 OutNewRecord        = true;
-*OutStream << fastendl;
+
+OutBuffer.AppendText  ( fastendl );
+OutBuffer.FlushIfFull ( *OutStream );
 }
 
 
@@ -558,6 +562,8 @@ void    TSpreadSheet::WriteFinished ()
 if ( ! OutStream )
     return;
 
+OutBuffer.Flush ( *OutStream );
+
 //OutStream->flush ();
 
 delete  OutStream;
@@ -20,6 +20,8 @@ limitations under the License.
 #include    <iomanip>
 #include    <io.h>
 #include    <fstream>
+#include    <string>
+#include    <charconv>
 
 #include    "System.h"                  // LONGLONG_to_LARGE_INTEGER, LARGE_INTEGER_to_LONGLONG
 
@@ -71,6 +73,54 @@ inline  ostream&    StreamFormatInt64       (ostream& os)       { os << " " << s
 constexpr auto      StreamFormatText        = StreamFormatLeft;
 
 
+//----------------------------------------------------------------------------
+                                        // Bulk text formatting of numerical values
+                                        // Values are converted with std::to_chars into a reusable character buffer, which is then sent with a single write
+                                        // It is locale-free, and reproduces the streams formatting:
+                                        //  - AppendFloat32 / AppendFloat64 / AppendInt32 are the equivalent of StreamFormatFixed + StreamFormatFloat32 / StreamFormatFloat64 / StreamFormatInt32
+                                        //  - AppendGeneral is the equivalent of the default stream formatting (StreamFormatGeneral)
+constexpr size_t    StreamTextBufferFlushSize   = 256 * KiloByte;
+
+
+class   TStreamTextBuffer
+{
+public:
+
+    inline          TStreamTextBuffer   ( size_t flushsize = StreamTextBufferFlushSize );
+
+
+    inline bool     IsEmpty         ()  const           { return  Buffer.empty ();  }
+    inline bool     IsFull          ()  const           { return  Buffer.size () >= FlushSize; }
+    inline size_t   GetSize         ()  const           { return  Buffer.size ();   }
+    inline void     Reset           ()                  { Buffer.clear ();          }
+
+
+    inline void     AppendText      ( const char* text )    { Buffer.append ( text ); }
+    inline void     AppendChar      ( char        c    )    { Buffer.push_back ( c ); }
+    inline void     AppendFixed     ( double    value, int precision, int width );  // right-aligned, fixed notation, same as "%*.*f"
+    inline void     AppendGeneral   ( double    value, int precision = 6 );         // same as "%.*g"
+    inline void     AppendInteger   ( long long value, int width );                 // right-aligned, same as "%*lld"
+
+    inline void     AppendFloat32   ( float     value )     { AppendChar ( ' ' ); AppendFixed   ( value,  7, WidthFloat32 - LeadingWidth ); }
+    inline void     AppendFloat64   ( double    value )     { AppendChar ( ' ' ); AppendFixed   ( value, 15, WidthFloat64 - LeadingWidth ); }
+    inline void     AppendInt32     ( long      value )     { AppendChar ( ' ' ); AppendInteger ( value,     WidthInt32   - LeadingWidth ); }
+
+                                        // Whole row of values, each one followed by a separator, with an optional stride between values
+    template <class TypeD>
+    inline void     AppendFloat32Row( const TypeD* values, int numvalues, int step = 1, const char* separator = Tab );
+
+
+    inline void     Flush           ( std::ostream& os );                   // single write of the whole buffer, then reset
+    inline void     FlushIfFull     ( std::ostream& os )    { if ( IsFull () ) Flush ( os ); }
+
+
+protected:
+
+    std::string     Buffer;
+    size_t          FlushSize;
+};
+
+
 //----------------------------------------------------------------------------
                                         // Stream utilities
 
@@ -309,6 +359,81 @@ of->flush ();
 }
 
 
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+        TStreamTextBuffer::TStreamTextBuffer ( size_t flushsize )
+      : FlushSize ( flushsize )
+{
+                                        // some head room, so that the last row before flushing does not trigger a re-allocation
+Buffer.reserve ( FlushSize + 16 * KiloByte );
+}
+
+
+//----------------------------------------------------------------------------
+void    TStreamTextBuffer::AppendFixed ( double value, int precision, int width )
+{
+                                        // big enough for any double in fixed notation: 309 digits + sign + point + precision
+char                number[ 384 ];
+auto                result          = std::to_chars ( number, number + sizeof ( number ), value, std::chars_format::fixed, precision );
+int                 length          = result.ec == std::errc () ? (int) ( result.ptr - number )
+                                                                : snprintf ( number, sizeof ( number ), "%.*f", precision, value );
+
+if ( length < width )
+    Buffer.append ( width - length, ' ' );
+
+Buffer.append ( number, length );
+}
+
+
+void    TStreamTextBuffer::AppendGeneral ( double value, int precision )
+{
+char                number[ 64 ];
+auto                result          = std::to_chars ( number, number + sizeof ( number ), value, std::chars_format::general, precision );
+int                 length          = result.ec == std::errc () ? (int) ( result.ptr - number )
+                                                                : snprintf ( number, sizeof ( number ), "%.*g", precision, value );
+
+Buffer.append ( number, length );
+}
+
+
+void    TStreamTextBuffer::AppendInteger ( long long value, int width )
+{
+char                number[ 32 ];
+auto                result          = std::to_chars ( number, number + sizeof ( number ), value );
+int                 length          = (int) ( result.ptr - number );
+
+if ( length < width )
+    Buffer.append ( width - length, ' ' );
+
+Buffer.append ( number, length );
+}
+
+
+//----------------------------------------------------------------------------
+template <class TypeD>
+void    TStreamTextBuffer::AppendFloat32Row ( const TypeD* values, int numvalues, int step, const char* separator )
+{
+for ( int i = 0; i < numvalues; i++, values += step ) {
+
+    AppendFloat32 ( (float) *values );
+    AppendText    ( separator );
+    }
+}
+
+
+//----------------------------------------------------------------------------
+void    TStreamTextBuffer::Flush ( std::ostream& os )
+{
+if ( IsEmpty () )
+    return;
+
+os.write ( Buffer.data (), Buffer.size () );
+
+Reset ();
+}
+
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 
@@ -17,9 +17,14 @@ limitations under the License.
 #pragma     hdrstop
 //-=-=-=-=-=-=-=-=-
 
+#include    <vector>
+#include    <complex>
+
 #include    "Strings.Utils.h"
+#include    "Math.Utils.h"
 #include    "TArray1.h"
 #include    "TVector.h"
+#include    "Math.FFT.h"
 #include    "Math.FFT.MKL.h"
 
 using namespace std;
@@ -168,6 +173,70 @@ for ( int fi0 = 0; fi0 <= DataSize / 2; fi0++ )
 }
 
 
+namespace crtl {
+
+//----------------------------------------------------------------------------
+                                        // Cross-correlation is a convolution with the reversed x, which becomes a product in the frequency domain:
+                                        //      cc = FFTI ( conj ( FFT ( x ) ) * FFT ( y ) )
+                                        // Zero-padding to at least nx + ny - 1 avoids any circular wrapping of the lags
+                                        // Done in double precision, to match the direct sum - TMklFft being single precision only, the descriptor is set here
+void    CrossCorrelationFFT ( const double* x, int nx, const double* y, int ny, double* cc )
+{
+if ( nx <= 0 || ny <= 0 )
+    return;
+
+
+int                 numlags         = nx + ny - 1;
+int                 numpts          = Power2Above ( numlags );
+int                 numfreqs        = numpts / 2 + 1;
+
+                                        // same descriptor for both directions, only the inverse is rescaled
+DFTI_DESCRIPTOR_HANDLE  mklh        = NULL;
+
+DftiCreateDescriptor    ( &mklh, DFTI_DOUBLE, DFTI_REAL, 1, numpts );
+DftiSetValue            (  mklh, DFTI_BACKWARD_SCALE, 1 / (double) numpts );
+DftiSetValue            (  mklh, DFTI_PLACEMENT, DFTI_NOT_INPLACE );
+DftiCommitDescriptor    (  mklh );
+
+
+vector<double>              X  ( numpts, 0.0 );
+vector<double>              Y  ( numpts, 0.0 );
+vector<complex<double>>     FX ( numfreqs );
+vector<complex<double>>     FY ( numfreqs );
+vector<double>              R  ( numpts );
+
+                                        // zero-padded copies
+for ( int i = 0; i < nx; i++ )
+    X[ i ]      = x[ i ];
+
+for ( int i = 0; i < ny; i++ )
+    Y[ i ]      = y[ i ];
+
+
+DftiComputeForward      ( mklh, X.data (), FX.data () );
+DftiComputeForward      ( mklh, Y.data (), FY.data () );
+
+
+for ( int fi = 0; fi < numfreqs; fi++ )
+    FX[ fi ]    = conj ( FX[ fi ] ) * FY[ fi ];
+
+
+DftiComputeBackward     ( mklh, FX.data (), R.data () );
+
+DftiFreeDescriptor      ( &mklh );
+
+                                        // negative lags are wrapped at the end of the results
+for ( int T = - ( nx - 1 ); T < ny; T++ )
+    cc[ T + nx - 1 ]    = R[ ( T + numpts ) % numpts ];
+}
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+}
+
+
 
 
 
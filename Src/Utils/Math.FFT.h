@@ -34,6 +34,17 @@ return  samplingfrequency / 2;
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Below this total size, direct summation of the cross-correlation is faster than going through FFT
+constexpr int       CrossCorrelationFFTMinSize  = 128;
+                                        // Relative difference under which 2 lags are considered equally good
+constexpr double    CrossCorrelationTieTolerance= 1e-9;
+
+                                        // Full cross-correlation curve in O(N log N): cc[ T + nx - 1 ] = Sum_i x[ i ] * y[ i + T ], for all lags T in [-(nx-1)..ny-1]
+                                        // cc should have nx + ny - 1 values - defined with the MKL wrapper
+void            CrossCorrelationFFT     ( const double* x, int nx, const double* y, int ny, double* cc );
+
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 
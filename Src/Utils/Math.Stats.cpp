@@ -17,6 +17,9 @@ limitations under the License.
 #pragma     hdrstop
 //-=-=-=-=-=-=-=-=-
 
+#include    <vector>
+#include    <algorithm>
+
 #include    "Math.Resampling.h"
 #include    "Math.Random.h"
 #include    "Math.Stats.h"
@@ -50,6 +53,7 @@ Data.ResetMemory ();                    // Do NOT deallocate the Data array so t
 
 NumItems            = 0;
 Sorted              = true;
+NumSelections       = 0;
 
 CacheSum            = 0;
 CacheSum2           = 0;
@@ -63,6 +67,7 @@ CacheMax            = -DBL_MAX;
 Data                = op.Data;
 NumItems            = op.NumItems;
 Sorted              = op.Sorted;
+NumSelections       = op.NumSelections;
 
 CacheSum            = op.CacheSum;
 CacheSum2           = op.CacheSum2;
@@ -80,6 +85,7 @@ if ( &op2 == this )
 Data                = op2.Data;
 NumItems            = op2.NumItems;
 Sorted              = op2.Sorted;
+NumSelections       = op2.NumSelections;
 
 CacheSum            = op2.CacheSum;
 CacheSum2           = op2.CacheSum2;
@@ -115,8 +121,8 @@ if ( IsAllocated () ) {
     StringAppend    ( buff,     NewLine "Median: "  Tab Tab,    FloatToString ( Median ()             ) );
     StringAppend    ( buff,     NewLine "Mode: "    Tab Tab,    FloatToString ( MaxModeHistogram ()   ) );
     StringAppend    ( buff,     NewLine "IQRange: " Tab,        FloatToString ( InterQuartileRange () ) );
-    StringAppend    ( buff,     NewLine "Sn: "      Tab Tab,    FloatToString ( Sn ( 1000 )           ) );
-    StringAppend    ( buff,     NewLine "Qn: "      Tab Tab,    FloatToString ( Qn ( 1000 )           ) );
+    StringAppend    ( buff,     NewLine "Sn: "      Tab Tab,    FloatToString ( Sn ()                 ) );
+    StringAppend    ( buff,     NewLine "Qn: "      Tab Tab,    FloatToString ( Qn ()                 ) );
     StringAppend    ( buff,     NewLine "MAD: "     Tab Tab,    FloatToString ( MAD ()                ) );
     StringAppend    ( buff,     NewLine "MCoV: "    Tab Tab,    FloatToString ( RobustCoV ()          ) );
     }
@@ -986,11 +992,45 @@ if ( /*! IsAllocated () ||*/ Sorted && ! force )
 
 Data.Sort ( Descending, NumItems );
 
-Sorted      = true;
+Sorted          = true;
+NumSelections   = 0;
 
 //OmpCriticalEnd
 }
 
+                                        // Recursively selecting the middle requested index, then the ones on each side
+void    SelectDescending ( float* data, int from, int to, const int* indexes, int numindexes )
+{
+if ( numindexes <= 0 || from >= to )
+    return;
+
+
+int                 mid             = numindexes / 2;
+int                 k               = indexes[ mid ];
+
+std::nth_element ( data + from, data + k, data + to + 1, [] ( float v1, float v2 ) { return v1 > v2; } );
+
+SelectDescending ( data, from,  k - 1, indexes,           mid                  );
+SelectDescending ( data, k + 1, to,    indexes + mid + 1, numindexes - mid - 1 );
+}
+
+                                        // Partial ordering: each requested item (indexes ascending) ends up where a full descending sort would put it,
+                                        // with only greater or equal values before it, and only lower or equal values after it
+                                        // Introselect is linear on average, and doesn't degrade with ties, like masked data full of 0's
+void    TEasyStats::SelectItems ( const int* indexes, int numindexes )
+{
+if ( Sorted || numindexes <= 0 )
+    return;
+                                        // same data being queried many times? sort once and for all
+if ( ++NumSelections > TEasyStatsMaxSelections ) {
+    Sort ();
+    return;
+    }
+
+
+SelectDescending ( Data.GetArray (), 0, NumItems - 1, indexes, numindexes );
+}
+
 
 //----------------------------------------------------------------------------
                                         // Useful when stats contain all pairs within a dataset and we want to recover the original number of items/nodes
@@ -1017,9 +1057,13 @@ double  TEasyStats::Max ()
 {
 if ( IsAllocated () ) {
 
-    Sort ();
+    if ( NumItems == 0 )
+        return  0;
                                         // sort is descending: first item
-    return  NumItems ? Data[ 0 ] : 0;
+    if ( Sorted )
+        return  Data[ 0 ];
+                                        // no need to sort for a single value
+    return  *std::max_element ( Data.GetArray (), Data.GetArray () + NumItems );
     }
 else
     return  CacheMax;
@@ -1030,9 +1074,13 @@ double  TEasyStats::Min ()
 {
 if ( IsAllocated () ) {
 
-    Sort ();
+    if ( NumItems == 0 )
+        return  0;
                                         // sort is descending: last item
-    return  NumItems ? Data[ NumItems - 1 ] : 0;
+    if ( Sorted )
+        return  Data[ NumItems - 1 ];
+                                        // no need to sort for a single value
+    return  *std::min_element ( Data.GetArray (), Data.GetArray () + NumItems );
     }
 else
     return  CacheMin;
@@ -1067,13 +1115,17 @@ if ( NumItems == 1 )
     return  Data[ 0 ];
                                         // here at least 2 data
 
-Sort ();
-
                                         // get index to half truncated position
 int                 halfi           = ( NumItems - 1 ) / 2;
+bool                strict          = strictvalue || IsOdd ( NumItems );
+int                 indexes[ 2 ]    = { halfi, halfi + 1 };
+
+                                        // no need for a full sort, only the central item(s)
+SelectItems ( indexes, strict ? 1 : 2 );
+
 
-return  strictvalue || IsOdd ( NumItems ) ?   Data[ halfi ]                             // return the exact center value, or the closest one to remain within the dataset
-                                          : ( Data[ halfi ] + Data[ halfi + 1 ] ) / 2;  // in case of even numbers, do the average between each sides - the result is NOT part of the original dataset, which sometimes could be problematic
+return  strict ?   Data[ halfi ]                                // return the exact center value, or the closest one to remain within the dataset
+               : ( Data[ halfi ] + Data[ halfi + 1 ] ) / 2;     // in case of even numbers, do the average between each sides - the result is NOT part of the original dataset, which sometimes could be problematic
 }
 
                                         // Do a Variance separately on right and left
@@ -1252,22 +1304,60 @@ return  sd ? Median ( false ) / sd : 0;
 
 double  TEasyStats::Quantile ( double p )
 {
-if ( ! ( IsAllocated () && NumItems ) )
-    return  0;
+double              q;
 
+Quantiles ( 1, &p, &q );
+
+return  q;
+}
+
+                                        // All the needed items are selected at once, then each quantile is computed as by a full sort
+void    TEasyStats::Quantiles ( int numq, const double* p, double* q )
+{
+if ( numq <= 0 )
+    return;
+
+if ( ! ( IsAllocated () && NumItems ) ) {
+    for ( int i = 0; i < numq; i++ )
+        q[ i ]  = 0;
+    return;
+    }
 
-Sort ();
                                         // truncated position, always returning an existing value
 //return  Data[ Round ( ( NumItems - 1 ) * Clip ( 1 - p, (double) 0, (double) 1 ) ) ];  // data sorted descending
 
                                         // interpolated value, which will return a non-existing value (most of the time)
                                                             // data is sorted descending, Quantile starts from the lowest values
-double              cut             = ( NumItems - 1 ) * Clip ( 1 - p, (double) 0, (double) 1 );
-double              frac            = Fraction ( cut );
+std::vector<double> cuts    ( numq );
+std::vector<int>    indexes;
+
+for ( int i = 0; i < numq; i++ ) {
+
+    cuts[ i ]   = ( NumItems - 1 ) * Clip ( 1 - p[ i ], (double) 0, (double) 1 );
+
+    indexes.push_back ( (int) cuts[ i ] );
+                                        // fractional part -> there are neighbors on each side
+    if ( Fraction ( cuts[ i ] ) != 0 )
+        indexes.push_back ( (int) cuts[ i ] + 1 );
+    }
+
+std::sort ( indexes.begin (), indexes.end () );
+
+indexes.erase ( std::unique ( indexes.begin (), indexes.end () ), indexes.end () );
+
+
+SelectItems ( indexes.data (), (int) indexes.size () );
+
+
+for ( int i = 0; i < numq; i++ ) {
+
+    int                 cut             = (int) cuts[ i ];
+    double              frac            = Fraction ( cuts[ i ] );
 
                                         // returns an interpolated value if needed (can matter with few data points)
-if ( frac == 0 )    return  Data[ (int) cut ];
-else                return  ( 1 - frac ) * Data[ (int) cut ] + frac * Data[ (int) cut + 1 ];    // fractional part -> there are neighbors on each side
+    if ( frac == 0 )    q[ i ]  = Data[ cut ];
+    else                q[ i ]  = ( 1 - frac ) * Data[ cut ] + frac * Data[ cut + 1 ];
+    }
 }
 
 
@@ -1275,8 +1365,13 @@ double  TEasyStats::InterQuartileRange ()
 {
 if ( ! ( IsAllocated () && NumItems ) )
     return  0;
+
+double              p[ 2 ]          = { 0.25, 0.75 };
+double              q[ 2 ];
+
+Quantiles ( 2, p, q );
                                                  // rescaling to be an unbiased estimator of standard deviation sigma
-return  ( Quantile ( 0.75 ) - Quantile ( 0.25 ) ) * IQRToSigma;
+return  ( q[ 1 ] - q[ 0 ] ) * IQRToSigma;
 }
 
                                         // Note: by splitting the data in 2, it finally boils down to MADAsym...
@@ -2257,7 +2352,7 @@ if ( ! ( IsAllocated () && NumItems ) ) {
                                         // Degenerate case: all constant values
 if ( Data == Data[ 0 ] ) {
                                         // then mode is this value, no need to mingle with complex histogram
-    statcenter.Add ( Data[ 0 ] );
+    statcenter.Add ( Data[ 0 ], ThreadSafetyIgnore );
 
     return;
     }
@@ -2277,11 +2372,12 @@ double              c3      = MaxModeHRM ();        // not bad, but a bit on the
 double              c4      = FirstMode ( 0.50 );   // quite the best for positive data
 
 
-statcenter.Add ( c1 );
-statcenter.Add ( c2 );
-statcenter.Add ( c3 );
+                                        // statcenter belongs to the caller, which can be itself running in parallel - no need to lock
+statcenter.Add ( c1, ThreadSafetyIgnore );
+statcenter.Add ( c2, ThreadSafetyIgnore );
+statcenter.Add ( c3, ThreadSafetyIgnore );
                                         // not using this estimator if null
-if ( c4 )   statcenter.Add ( c4 );
+if ( c4 )   statcenter.Add ( c4, ThreadSafetyIgnore );
 
 //#endif
 
@@ -2367,6 +2463,68 @@ return  0; // H.ToReal ( RealUnit, 0 );
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Helpers for the Rousseeuw and Croux estimators below
+                                        // Weighted high median: smallest value for which the cumulated weights of values <= to it exceed half of the total weight
+                                        // Done by successive partitions around the median value, so in linear time on average
+double  WeightedHighMedian ( const std::vector<double>& values, const std::vector<long long>& weights, int numvalues )
+{
+std::vector<std::pair<double,long long>>    candidates ( numvalues );
+std::vector<std::pair<double,long long>>    remaining;
+long long           wtotal          = 0;
+long long           wrest           = 0;
+
+
+for ( int i = 0; i < numvalues; i++ ) {
+    candidates[ i ] = std::make_pair ( values[ i ], weights[ i ] );
+    wtotal         += weights[ i ];
+    }
+
+
+do {
+    int                 mid             = (int) candidates.size () / 2;
+
+    std::nth_element ( candidates.begin (), candidates.begin () + mid, candidates.end (),
+                       [] ( const std::pair<double,long long>& p1, const std::pair<double,long long>& p2 ) { return p1.first < p2.first; } );
+
+    double              trial           = candidates[ mid ].first;
+    long long           wleft           = 0;
+    long long           wmid            = 0;
+
+    for ( const auto& c : candidates )
+        if      ( c.first <  trial )    wleft  += c.second;
+        else if ( c.first == trial )    wmid   += c.second;
+
+
+    remaining.clear ();
+
+    if      ( 2 * ( wrest + wleft ) > wtotal ) {
+                                        // weighted median is below trial
+        for ( const auto& c : candidates )
+            if ( c.first < trial )      remaining.push_back ( c );
+        }
+    else if ( 2 * ( wrest + wleft + wmid ) > wtotal )
+
+        return  trial;
+
+    else {
+                                        // weighted median is above trial
+        wrest  += wleft + wmid;
+
+        for ( const auto& c : candidates )
+            if ( c.first > trial )      remaining.push_back ( c );
+        }
+
+
+    candidates.swap ( remaining );
+
+    } while ( ! candidates.empty () );
+
+
+return  0;                              // doesn't happen, just for the sake of code consistency
+}
+
+
 //----------------------------------------------------------------------------
                                         // Rousseeuw and Croux Sn for Robust Standard Deviation
                                         // Taken from their original Fortran source code (better than in Wikipedia!): http://ftp.uni-bayreuth.de/math/statlib/general/snqn
@@ -2378,97 +2536,258 @@ return  0; // H.ToReal ( RealUnit, 0 );
                                         // gross-error sensitivity. As a default choice, we recommend
                                         // using the estimator Sn.
                                         // "
-double  TEasyStats::Sn ( int maxitems )
+                                        // Sn = c * lomed_i himed_j | x_i - x_j |, computed in O(n log n) on the whole data:
+                                        // once sorted, each inner himed is found by a binary search that merges the values below and above x_i
+double  TEasyStats::Sn ()
 {
 if ( ! ( IsAllocated () && NumItems >= 2 ) )
     return  0;
 
 
-Maxed ( maxitems, 10 );
-                                        // downsample data, this stuff can explode (numerically speaking)!
-int                 step            = AtLeast ( 1, Round ( NumItems / ( (double) maxitems / 1.5 ) ) );
-int                 numitems        = ( NumItems + step - 1 ) / step;
+int                 n               = NumItems;
+                                        // sorted copy, as the internal sort is descending and data should be preserved
+std::vector<double> x ( Data.GetArray (), Data.GetArray () + n );
+
+std::sort ( x.begin (), x.end () );
+
+                                        // himed_j | x_i - x_j |, for each i
+std::vector<double> a2 ( n );
+int                 np1_2           = ( n + 1 ) / 2;
+
+
+a2[ 0 ]     = x[ n / 2 ] - x[ 0 ];
+
+                                        // lower half: more values above x_i than below
+for ( int i = 2; i <= np1_2; i++ ) {
 
+    int                 nA              = i - 1;
+    int                 nB              = n - i;
+    int                 diff            = nB - nA;
+    int                 leftA           = 1;
+    int                 leftB           = 1;
+    int                 rightA          = nB;
+    int                 Amin            = diff / 2 + 1;
+    int                 Amax            = diff / 2 + nA;
 
-TEasyStats          deltai ( numitems     );
-TEasyStats          deltaj ( numitems - 1 );
+    while ( leftA < rightA ) {
 
+        int                 length          = rightA - leftA + 1;
+        int                 even            = 1 - length % 2;
+        int                 half            = ( length - 1 ) / 2;
+        int                 tryA            = leftA + half;
+        int                 tryB            = leftB + half;
 
-for ( int i = 0; i < NumItems; i += step ) {
+        if      ( tryA < Amin ) {
+            leftA   = tryA + even;
+            }
+        else if ( tryA > Amax ) {
+            rightA  = tryA;
+            leftB   = tryB + even;
+            }
+        else if ( x[ i - 1 ] - x[ i - tryA + Amin - 2 ] >= x[ tryB + i - 1 ] - x[ i - 1 ] ) {
+            rightA  = tryA;
+            leftB   = tryB + even;
+            }
+        else {
+            leftA   = tryA + even;
+            }
+        }
+
+    a2[ i - 1 ] = leftA > Amax  ?        x[ leftB + i - 1 ] - x[ i - 1 ]
+                                : min (  x[ i - 1 ] - x[ i - leftA + Amin - 2 ],
+                                         x[ leftB + i - 1 ] - x[ i - 1 ]         );
+    }
+
+                                        // upper half: more values below x_i than above
+for ( int i = np1_2 + 1; i <= n - 1; i++ ) {
 
-    deltaj.Reset ();
+    int                 nA              = n - i;
+    int                 nB              = i - 1;
+    int                 diff            = nB - nA;
+    int                 leftA           = 1;
+    int                 leftB           = 1;
+    int                 rightA          = nB;
+    int                 Amin            = diff / 2 + 1;
+    int                 Amax            = diff / 2 + nA;
 
-    for ( int j = 0; j < NumItems; j += step )
-        if ( j != i )
-            deltaj.Add ( fabs ( Data[ i ] - Data[ j ] ), ThreadSafetyIgnore );
-        
+    while ( leftA < rightA ) {
+
+        int                 length          = rightA - leftA + 1;
+        int                 even            = 1 - length % 2;
+        int                 half            = ( length - 1 ) / 2;
+        int                 tryA            = leftA + half;
+        int                 tryB            = leftB + half;
+
+        if      ( tryA < Amin ) {
+            leftA   = tryA + even;
+            }
+        else if ( tryA > Amax ) {
+            rightA  = tryA;
+            leftB   = tryB + even;
+            }
+        else if ( x[ i + tryA - Amin ] - x[ i - 1 ] >= x[ i - 1 ] - x[ i - tryB - 1 ] ) {
+            rightA  = tryA;
+            leftB   = tryB + even;
+            }
+        else {
+            leftA   = tryA + even;
+            }
+        }
 
-    deltai.Add ( deltaj.Median ( false ), ThreadSafetyIgnore );
+    a2[ i - 1 ] = leftA > Amax  ?        x[ i - 1 ] - x[ i - leftB - 1 ]
+                                : min (  x[ i + leftA - Amin ] - x[ i - 1 ],
+                                         x[ i - 1 ] - x[ i - leftB - 1 ]         );
     }
 
+
+a2[ n - 1 ] = x[ n - 1 ] - x[ np1_2 - 1 ];
+
+                                        // lomed_i
+std::nth_element ( a2.begin (), a2.begin () + np1_2 - 1, a2.end () );
+
+
                                         // correction factor, depending on the sample size
-double              csn             = NumItems >= 10 ? IsOdd ( numitems ) ? numitems / (double) ( numitems - 0.9 ) 
-                                                                          : 1
-                                    : NumItems == 1  ? 1    // doesn't happen, just for the sake of code consistency
-                                    : NumItems == 2  ? 0.743
-                                    : NumItems == 3  ? 1.851
-                                    : NumItems == 4  ? 0.954
-                                    : NumItems == 5  ? 1.351
-                                    : NumItems == 6  ? 0.993
-                                    : NumItems == 7  ? 1.198
-                                    : NumItems == 8  ? 1.005
-                                    : NumItems == 9  ? 1.131
-                                    :                  1;   // doesn't happen, just for the sake of code consistency
+double              csn             = n >= 10 ? IsOdd ( n ) ? n / (double) ( n - 0.9 )
+                                                            : 1
+                                    : n == 1  ? 1       // doesn't happen, just for the sake of code consistency
+                                    : n == 2  ? 0.743
+                                    : n == 3  ? 1.851
+                                    : n == 4  ? 0.954
+                                    : n == 5  ? 1.351
+                                    : n == 6  ? 0.993
+                                    : n == 7  ? 1.198
+                                    : n == 8  ? 1.005
+                                    : n == 9  ? 1.131
+                                    :           1;      // doesn't happen, just for the sake of code consistency
 
                                         // final formula
-double              Sn              = csn * 1.1926 * deltai.Median ( false );
+double              Sn              = csn * 1.1926 * a2[ np1_2 - 1 ];
 
 return  Sn;
 }
 
 
-double  TEasyStats::Qn ( int maxitems )
+                                        // Qn = c * { | x_i - x_j |, i < j }_(k), with k = h ( h - 1 ) / 2 and h = n / 2 + 1, computed in O(n log n) on the whole data:
+                                        // once sorted, the matrix x_i - x_(n-1-j) is increasing along rows and columns, and the k-th value is selected
+                                        // by repeatedly splitting the remaining candidates with the weighted median of the rows' medians
+double  TEasyStats::Qn ()
 {
 if ( ! ( IsAllocated () && NumItems >= 2 ) )
     return  0;
 
 
-Maxed ( maxitems, 10 );
-                                        // downsample data, this stuff can explode (numerically speaking)!
-int                 step            = AtLeast ( 1, Round ( NumItems / ( (double) maxitems / 1.5 ) ) );
-int                 numitems        = ( NumItems + step - 1 ) / step;
+int                 n               = NumItems;
+                                        // sorted copy, as the internal sort is descending and data should be preserved
+std::vector<double> y ( Data.GetArray (), Data.GetArray () + n );
+
+std::sort ( y.begin (), y.end () );
+
+auto                delta           = [ &y, n ] ( int i, int j ) { return  y[ i ] - y[ n - 1 - j ]; };
+
+
+int                 h               = n / 2 + 1;
+long long           k               = (long long) h * ( h - 1 ) / 2;
+                                        // the full matrix holds the n ( n - 1 ) / 2 negative differences, then the n null diagonal values, before the positive differences
+long long           knew            = k + (long long) n * ( n + 1 ) / 2;
+long long           nl              = 0;                    // number of values known to be below the remaining candidates
+long long           nr              = (long long) n * n;    // number of values up to the last candidate
+std::vector<int>    left    ( n, 0     );                   // per row range of remaining candidates
+std::vector<int>    right   ( n, n - 1 );
+std::vector<int>    P       ( n );
+std::vector<int>    Q       ( n );
+std::vector<double>     work    ( n );
+std::vector<long long>  weight  ( n );
+bool                found           = false;
+double              qn              = 0;
+
+
+while ( nr - nl > n ) {
+                                        // median of the candidates of each row, weighted by their number
+    int                 numrows         = 0;
+
+    for ( int i = 0; i < n; i++ )
+
+        if ( left[ i ] <= right[ i ] ) {
+            weight[ numrows ]   = right[ i ] - left[ i ] + 1;
+            work  [ numrows ]   = delta ( i, left[ i ] + ( right[ i ] - left[ i ] ) / 2 );
+            numrows++;
+            }
+
+    double              trial           = WeightedHighMedian ( work, weight, numrows );
+
+                                        // count values strictly below trial
+    for ( int i = n - 1, j = 0; i >= 0; i-- ) {
+        while ( j < n && delta ( i, j ) < trial )
+            j++;
+        P[ i ]  = j;
+        }
+                                        // count values below or equal to trial
+    for ( int i = 0, j = n; i < n; i++ ) {
+        while ( j > 0 && delta ( i, j - 1 ) > trial )
+            j--;
+        Q[ i ]  = j;
+        }
 
 
-TEasyStats          delta ( numitems * ( numitems - 1 ) / 2 );
+    long long           sumP            = 0;
+    long long           sumQ            = 0;
 
-                                        // all pairwise distances
-for ( int i = 0;     i < NumItems; i += step ) 
-for ( int j = i + 1; j < NumItems; j += step )
+    for ( int i = 0; i < n; i++ ) {
+        sumP   += P[ i ];
+        sumQ   += Q[ i ];
+        }
+
+
+    if      ( knew <= sumP ) {
+        for ( int i = 0; i < n; i++ )
+            right[ i ]  = P[ i ] - 1;
+        nr      = sumP;
+        }
+    else if ( knew >  sumQ ) {
+        for ( int i = 0; i < n; i++ )
+            left [ i ]  = Q[ i ];
+        nl      = sumQ;
+        }
+    else {
+        found   = true;                 // trial is the k-th value
+        qn      = trial;
+        break;
+        }
+    }
+
+
+if ( ! found ) {
+                                        // few candidates left: select among them
+    std::vector<double> remaining;
+
+    for ( int i = 0; i < n; i++ )
+    for ( int j = left[ i ]; j <= right[ i ]; j++ )
+        remaining.push_back ( delta ( i, j ) );
+
+    int                 ki              = (int) ( knew - nl - 1 );
+
+    std::nth_element ( remaining.begin (), remaining.begin () + ki, remaining.end () );
+
+    qn      = remaining[ ki ];
+    }
 
-    delta.Add ( fabs ( Data[ i ] - Data[ j ] ), ThreadSafetyIgnore );
-        
 
                                         // correction factor, depending on the sample size
-double              cqn             = NumItems >= 10 ? IsOdd ( numitems ) ? numitems / (double) ( numitems + 1.4 ) 
-                                                                          : numitems / (double) ( numitems + 3.8 ) 
-                                    : NumItems == 1  ? 1    // doesn't happen, just for the sake of code consistency
-                                    : NumItems == 2  ? 0.399
-                                    : NumItems == 3  ? 0.994
-                                    : NumItems == 4  ? 0.512
-                                    : NumItems == 5  ? 0.844
-                                    : NumItems == 6  ? 0.611
-                                    : NumItems == 7  ? 0.857
-                                    : NumItems == 8  ? 0.669
-                                    : NumItems == 9  ? 0.872
-                                    :                  1;   // doesn't happen, just for the sake of code consistency
-
-int                 h               = numitems / 2 + 1;
-int                 k               = ( h * ( h - 1 ) ) / 2;
-                                        // order of the sort is Descending here, we need to invert the index
-delta.Sort ();
+double              cqn             = n >= 10 ? IsOdd ( n ) ? n / (double) ( n + 1.4 )
+                                                            : n / (double) ( n + 3.8 )
+                                    : n == 1  ? 1       // doesn't happen, just for the sake of code consistency
+                                    : n == 2  ? 0.399
+                                    : n == 3  ? 0.994
+                                    : n == 4  ? 0.512
+                                    : n == 5  ? 0.844
+                                    : n == 6  ? 0.611
+                                    : n == 7  ? 0.857
+                                    : n == 8  ? 0.669
+                                    : n == 9  ? 0.872
+                                    :           1;      // doesn't happen, just for the sake of code consistency
 
                                         // final formula
-double              Qn              = cqn * 2.2219 * delta[ delta.NumItems - k ];
+double              Qn              = cqn * 2.2219 * qn;
 
 return  Qn;
 }
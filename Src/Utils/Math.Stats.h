@@ -38,6 +38,8 @@ constexpr double    MADToSigma          = 1.4825796886;
 constexpr double    IQRToSigma          = 0.7412898443;
 
 constexpr int       NumMaxModeRobustEstimates   = 4;
+                                        // Number of partial orderings (selections) of the same data before doing a full sort instead
+constexpr int       TEasyStatsMaxSelections     = 8;
 
 
 //----------------------------------------------------------------------------
@@ -214,8 +216,9 @@ public:
     double          MaxModeHRM              ();                         // #2 estimate for 2 modes  - Done by Half Range Mode   ;HRM & HSM will asymptotically behave the same past ~128 samples
     double          MaxModeHSM              ();                         // #2 estimate for 1 mode   - Done by Half Sample Mode  ;HRM & HSM will asymptotically behave the same past ~128 samples
     void            MaxModeRobust           ( TEasyStats& statcenter );
-    double          Qn                      ( int maxitems );           // Rousseeuw and Croux Qn for Robust Standard Deviation
+    double          Qn                      ();                         // Rousseeuw and Croux Qn for Robust Standard Deviation, O(n log n) on all data
     double          Quantile                ( double p );               // can return an interpolated value
+    void            Quantiles               ( int numq, const double* p, double* q );   // multiple quantiles at once, with a single partial ordering of the data
     double          RobustCoV               ();                         // CoV with Median and MAD: MAD / Median
     double          RobustKurtosis          ();                         // Using Median and MAD
     double          RobustKurtosisCS        ();                         // Crow Siddiqui estimate
@@ -227,7 +230,7 @@ public:
     double          RobustSkewnessQuartiles ();                         // non-parametric, robust
     double          RobustSkewnessMAD       ( double center );          // non-parametric, robust - Cartool made
     void            SDAsym                  ( double center, double &sdleft,  double &sdright  );
-    double          Sn                      ( int maxitems );           // Rousseeuw and Croux Sn for Robust Standard Deviation
+    double          Sn                      ();                         // Rousseeuw and Croux Sn for Robust Standard Deviation, O(n log n) on all data
     double          SkewnessPearson         ();                         // adjusted Fisher-Pearson, parametric, sensitive to outliers
     double          SkewnessPearson         ( double center );          // adjusted Fisher-Pearson, parametric, sensitive to outliers
     void            SkewnessPearsonAsym     ( double center, double &skewleft, double &skewright );
@@ -268,6 +271,7 @@ private:
     TVector<float>  Data;               // unallocated, or allocated to max size
     int             NumItems;           // actual # of data
     bool            Sorted;             // remember if data has been sorted or not
+    int             NumSelections;      // number of partial orderings since last full sort
 
                                         // for faster & simpler stats, we need only these fields:
     double          CacheSum;
@@ -277,6 +281,7 @@ private:
 
 
     void           _Add         ( double  v );  // non thread-safe method which does the actual work of Add
+    void            SelectItems ( const int* indexes, int numindexes ); // partial ordering, enough for order statistics at the given positions
 };
 
 
@@ -44,6 +44,8 @@ namespace crtl {
 
                                         // single parallel for, WITHIN an existing parallel block
 #define OmpFor                          __pragma( omp for )
+                                        // same, but iterations are handed to threads as they become free - f.ex. when the main thread is busy with something else
+#define OmpForDynamic                   __pragma( omp for schedule(dynamic) )
 #define OmpForSum(...)                    __pragma( omp for reduction (+:__VA_ARGS__) )
                                         // STAND-ALONE, single parallel for(s) - NOT WITHIN an existing parallel block
 #define OmpParallelFor                  __pragma( omp parallel for )
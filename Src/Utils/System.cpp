@@ -132,6 +132,19 @@ switch ( how ) {
 }
 
 
+size_t  GetAvailableMemory ()
+{
+MEMORYSTATUSEX      memstatus;
+
+memstatus.dwLength  = sizeof ( memstatus );
+
+if ( ! GlobalMemoryStatusEx ( &memstatus ) )
+    return  0;
+
+return  (size_t) memstatus.ullAvailPhys;
+}
+
+
 //----------------------------------------------------------------------------
 
 bool    GetEnvironmentVariableEx ( const char* variable, TFileName& result )
@@ -132,6 +132,8 @@ enum    ProcessPriorityFlags
 
 void    SetProcessPriority  ( ProcessPriorityFlags how = DefaultPriority );
 
+size_t  GetAvailableMemory  ();         // physical memory currently available, in bytes
+
 
 //----------------------------------------------------------------------------
 
@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 \************************************************************************/
 
+#include    "System.OpenMP.h"
+
 #include    "TParser.h"
 
 #include    "Strings.Utils.h"
@@ -1428,6 +1430,439 @@ return  true;
 }
 
 
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+void    TFusedPlan::Reset ()
+{
+Result          = 0;
+Groups.clear ();
+Program.clear ();
+MaxDepth        = 0;
+NumFiles        = 0;
+NumTracks       = 0;
+NumTimeFrames   = 0;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Running the whole program for a single time frame of the current blocks
+                                        // registers is the evaluation stack, one row of NumTracks values per level
+void    TFusedPlan::Execute ( const std::vector<TTracks<float>>& blocks, int tf, TArray2<float>& registers, float* results )   const
+{
+int                 depth           = 0;
+
+
+for ( const auto& inst : Program ) {
+
+    if      ( inst.Type == FusedLoadGroup ) {
+
+        const TTracks<float>&   block   = blocks[ inst.Group ];
+        float*                  r       = registers[ depth++ ];
+
+        for ( int e = 0; e < NumTracks; e++ )
+            r[ e ]  = block ( e, tf );
+        }
+
+    else if ( inst.Type == FusedLoadValue ) {
+
+        float*              r           = registers[ depth++ ];
+
+        for ( int e = 0; e < NumTracks; e++ )
+            r[ e ]  = inst.Value;
+        }
+
+    else if ( inst.Type == FusedUnaryOperator ) {
+
+        float*              r           = registers[ depth - 1 ];
+
+        if      ( inst.Code == OpAbs  )     for ( int e = 0; e < NumTracks; e++ )   r[ e ]  = fabs ( r[ e ] );
+        else if ( inst.Code == OpSqr  )     for ( int e = 0; e < NumTracks; e++ )   r[ e ]  = r[ e ] * r[ e ];
+        else if ( inst.Code == OpSqrt )     for ( int e = 0; e < NumTracks; e++ )   r[ e ]  = sqrt ( r[ e ] );
+                                        // OpScalar: reading has already done the job to go down to scalar
+        }
+
+    else if ( inst.Type == FusedBinaryOperator ) {
+
+        float*              r1          = registers[ depth - 2 ];
+        const float*        r2          = registers[ depth - 1 ];
+
+        if      ( inst.Code == OpBinaryPlus  )  for ( int e = 0; e < NumTracks; e++ )   r1[ e ] += r2[ e ];
+        else if ( inst.Code == OpBinaryMinus )  for ( int e = 0; e < NumTracks; e++ )   r1[ e ] -= r2[ e ];
+        else if ( inst.Code == OpBinaryMult  )  for ( int e = 0; e < NumTracks; e++ )   r1[ e ] *= r2[ e ];
+        else if ( inst.Code == OpBinaryDiv   )  for ( int e = 0; e < NumTracks; e++ )   r1[ e ] /= r2[ e ];
+
+        depth--;
+        }
+    }
+
+                                        // the only remaining level is the result
+CopyVirtualMemory ( results, registers[ 0 ], NumTracks * sizeof ( float ) );
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Same naming scheme as TTokenVariable::CompoundFilenames, but for the whole expression at once
+void    TFusedPlan::GetCompoundFilename ( int filei, char* filename, int maxlength )   const
+{
+std::vector<std::string>    names;
+char                        buff    [ 2 * MaxPathShort ];
+
+
+for ( const auto& inst : Program ) {
+
+    if      ( inst.Type == FusedLoadGroup ) {
+
+        StringCopy  ( buff, Groups[ inst.Group ]->GetFile ( filei ) );
+        GetFilename ( buff );
+
+        names.push_back ( buff );
+        }
+
+    else if ( inst.Type == FusedLoadValue ) {
+
+        const TTokenVariable*   tokvar  = static_cast<const TTokenVariable*> ( inst.Token );
+
+        if ( tokvar->IsValue () )   sprintf ( buff, "%g", inst.Value  );
+        else                        sprintf ( buff, "%s", tokvar->Name );
+
+        names.push_back ( buff );
+        }
+
+    else {
+        const TTokenOperator*   tokop   = static_cast<const TTokenOperator*> ( inst.Token );
+                                        // windows can not stand these chars in filenames
+        const char*             legalop = StringContains ( (const char*) "\\/:*?\"<>|", tokop->Name ) ? "." : tokop->Name;
+
+        if ( inst.Type == FusedUnaryOperator )
+
+            names.back ()   = std::string ( legalop ) + "(" + names.back () + ")";
+
+        else {
+            std::string     name2       = names.back ();
+
+            names.pop_back ();
+
+            names.back ()  += legalop + name2;
+            }
+        }
+    }
+
+
+StringCopy   ( buff, names.back ().c_str (), 2 * MaxPathShort - 1 );
+
+StringShrink ( buff, filename, maxlength );
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Tries to compile the parsed expression into a single pass over the files
+                                        // This works for element-wise scalar expressions over groups of the same dimensions, assigned to a group:
+                                        //      result = Abs ( Group1 - Group2 ) / 2 + Group3
+                                        // Intermediate results are then kept in memory, instead of being written to temp files for each operator.
+                                        // Returns false for anything else (vectors, matrices, matrix multiplication...), which then goes through the regular evaluation.
+bool    TParser::CompileFused ( TFusedPlan& plan )
+{
+plan.Reset ();
+
+int                 numtokens       = Tokens.GetNumTokens ();
+
+                                        // at least a variable, an operand, an operator, and the assignation
+if ( numtokens < 4 )
+    return  false;
+
+                                        // expression has to be an assignation to a group variable
+TToken*             tokfirst        = Tokens[ 0 ];
+TToken*             toklast         = Tokens[ numtokens - 1 ];
+
+if ( ! tokfirst->IsVariable () || tokfirst->Temp || ! toklast->IsOperator ( OpAssign ) )
+    return  false;
+
+                                        // same checks as the regular assignation - anything else is left to the regular evaluation, which will report the error
+TTokenVariable*     tokresult       = static_cast<TTokenVariable*> ( tokfirst );
+
+if ( ! tokresult->IsAllocated () || ! tokresult->IsGroup () )
+    return  false;
+
+
+std::vector<bool>   stackgroup;         // symbolic evaluation stack: true for a group, false for a single value
+int                 numoperators    = 0;
+
+
+for ( int tokeni = 1; tokeni < numtokens - 1; tokeni++ ) {
+
+    TToken*             tok             = Tokens[ tokeni ];
+    TFusedInstruction   inst;
+
+    inst.Type   = FusedLoadValue;
+    inst.Code   = OpUnknown;
+    inst.Group  = -1;
+    inst.Value  = 0;
+    inst.Token  = tok;
+
+
+    if ( tok->IsOperand () ) {
+
+        TTokenVariable*     tokvar      = static_cast<TTokenVariable*> ( tok );
+
+        if      ( tokvar->IsSingleFloat () ) {
+
+            inst.Type   = FusedLoadValue;
+            inst.Value  = *tokvar->DataFloat;
+
+            stackgroup.push_back ( false );
+            }
+
+        else if ( tokvar->IsGroup () ) {
+                                        // only scalar data, 2D, and all groups with the same dimensions
+            if ( ! ( tokvar->IsData () && tokvar->IsFloat () && tokvar->IsArray2D () && tokvar->NumFiles () > 0 ) )
+                return  false;
+                                        // self-referencing assignation, like  a = a + 1 : the result files would be reset before being read
+            if ( tokvar == tokresult || tokvar->DataGof == tokresult->DataGof )
+                return  false;
+
+            if ( plan.Groups.empty () ) {
+                plan.NumFiles       = tokvar->NumFiles ();
+                plan.NumTracks      = tokvar->Size[ 1 ];
+                plan.NumTimeFrames  = tokvar->Size[ 2 ];
+                }
+            else if ( ! tokvar->HasSameFiles ( plan.Groups[ 0 ] ) || ! tokvar->HasSameSize ( plan.Groups[ 0 ] ) )
+                return  false;
+
+                                        // the same group can appear more than once in the expression
+            inst.Type   = FusedLoadGroup;
+            inst.Group  = 0;
+
+            while ( inst.Group < (int) plan.Groups.size () && plan.Groups[ inst.Group ]->DataGof != tokvar->DataGof )
+                inst.Group++;
+
+            if ( inst.Group == (int) plan.Groups.size () )
+                plan.Groups.push_back ( tokvar );
+
+            stackgroup.push_back ( true );
+            }
+
+        else                            // vectors
+            return  false;
+        }
+
+    else if ( tok->IsOperator () ) {
+
+        TTokenOperator*     tokop       = static_cast<TTokenOperator*> ( tok );
+
+        if ( (int) stackgroup.size () < tokop->NumParameters )
+            return  false;
+
+        inst.Code   = tokop->Code;
+
+
+        if      ( tokop->NumParameters == 1
+               && ( tokop->Code == OpAbs || tokop->Code == OpScalar || tokop->Code == OpSqr || tokop->Code == OpSqrt ) )
+
+            inst.Type   = FusedUnaryOperator;   // stack remains the same
+
+        else if ( tokop->NumParameters == 2
+               && ( tokop->Code == OpBinaryPlus || tokop->Code == OpBinaryMinus || tokop->Code == OpBinaryMult || tokop->Code == OpBinaryDiv ) ) {
+
+            bool                group1      = stackgroup[ stackgroup.size () - 2 ];
+            bool                group2      = stackgroup[ stackgroup.size () - 1 ];
+
+                                        // same restrictions as the regular evaluation: Group * Group is a matrix multiplication, and no division by a group
+            if ( group2 && ( group1 && tokop->Code == OpBinaryMult || tokop->Code == OpBinaryDiv ) )
+                return  false;
+
+            inst.Type   = FusedBinaryOperator;
+
+            stackgroup.pop_back ();
+            stackgroup.back ()  = group1 || group2;
+            }
+
+        else
+            return  false;
+
+        numoperators++;
+        }
+
+    else
+        return  false;
+
+
+    plan.Program.push_back ( inst );
+
+    plan.MaxDepth   = max ( plan.MaxDepth, (int) stackgroup.size () );
+    }
+
+                                        // a single final result, which has to be a group, and some actual computation (plain assignation is a simple file copy)
+if ( stackgroup.size () != 1 || ! stackgroup.back () || numoperators == 0 ) {
+    plan.Reset ();
+    return  false;
+    }
+
+
+plan.Result     = tokresult;
+
+return  true;
+}
+
+
+//----------------------------------------------------------------------------
+                                        // Single pass over all files: each group is read per blocks of time frames,
+                                        // the whole expression is then evaluated in parallel for each time frame, then written straight to the result files.
+bool    TParser::EvaluateFused ( const TFusedPlan& plan, bool verbose )
+{
+if ( plan.IsEmpty () || plan.Result == 0 )
+    return  false;
+
+
+TCartoolDocManager*     docmanager      = Cartool.CartoolDocManager;
+TTokenVariable*         result          = plan.Result;
+const TTokenVariable*   group0          = plan.Groups[ 0 ];
+int                     numgroups       = (int) plan.Groups.size ();
+int                     numel           = plan.NumTracks;
+int                     numtf           = plan.NumTimeFrames;
+int                     blocksize       = AtLeast ( 1, NoMore ( FusedEvaluationBlockSize, numtf ) );
+TExportTracks           fileout;
+TFileName               filename;
+char                    buff    [ KiloByte ];
+long                    remainlen;
+
+
+fileout.CloneParameters ( result->OutputExt, group0->GetFile () );
+                                        // result type
+fileout.SetAtomType ( AtomTypeScalar );
+
+                                        // set content properties, except variable name - same as assignation
+result->DataGof->Reset ();
+
+result->Content     = ContentData;
+result->DataType    = AtomTypeScalar;
+result->Size[ 0 ]   = group0->Size[ 0 ];
+result->Size[ 1 ]   = group0->Size[ 1 ];
+result->Size[ 2 ]   = group0->Size[ 2 ];
+result->Size[ 3 ]   = group0->Size[ 3 ];
+
+                                        // create result dir & file names
+result->CreateGof ( group0->GetFile (), plan.NumFiles );
+
+                                        // then cook the file names from the whole expression
+for ( int fi = 0; fi < plan.NumFiles; fi++ ) {
+
+    StringCopy      ( filename, result->GetFile ( fi ) );
+    RemoveFilename  ( filename );
+                                        // what room is left to filename (excluding extension)
+    remainlen   = NoMore ( WindowsMaxComponentLength, MaxPathShort ) - 16 - StringLength ( filename );
+
+    plan.GetCompoundFilename ( fi, buff, AtLeast ( 8L, remainlen ) );
+
+    AddExtension    ( buff, fileout.GetExtension () );
+
+    ReplaceFilename ( result->GetFile ( fi ), buff );
+    }
+
+                                        // check that all files ARE actually different
+bool                    alldifferent    = true;
+
+for ( int i = 0; alldifferent && i < plan.NumFiles - 1; i++ )
+    for ( int j = i + 1; alldifferent && j < plan.NumFiles; j++ )
+        alldifferent    = StringIsNot ( result->GetFile ( i ), result->GetFile ( j ) );
+
+if ( ! alldifferent )                   // append numbers at the end
+    for ( int i = 0; i < plan.NumFiles; i++ )
+        PostfixFilename ( result->GetFile ( i ), IntegerToString ( buff, i + 1 ) );
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+std::vector<TTracksDoc*>        docs    ( numgroups );
+std::vector<TTracks<float>>     blocks  ( numgroups );
+TArray1<float>                  results;
+
+for ( auto& block : blocks )
+    block.Resize ( numel, blocksize );
+
+                                        // the same file could appear in different groups, close each doc only once
+auto                    CloseDocs       = [ &docs, docmanager ] ( int numdocs )
+{
+for ( int g = 0; g < numdocs; g++ ) {
+
+    bool                firstseen       = true;
+
+    for ( int g2 = 0; g2 < g; g2++ )
+        firstseen  &= docs[ g2 ] != docs[ g ];
+
+    if ( firstseen && docs[ g ]->CanClose ( true ) )
+        docmanager->CloseDoc ( docs[ g ] );
+    }
+};
+
+
+TSuperGauge             GaugeF ( "Files", 100, SuperGaugeLevelDefault, SuperGaugeDefault );
+
+
+for ( int fi = 0; fi < plan.NumFiles; fi++ ) {
+
+    GaugeF.SetValue ( SuperGaugeDefaultPart, Percentage ( fi, plan.NumFiles - 1 ) );
+
+
+    for ( int g = 0; g < numgroups; g++ ) {
+
+        docs[ g ]   = dynamic_cast<TTracksDoc*> ( docmanager->OpenDoc ( plan.Groups[ g ]->GetFile ( fi ), dtOpenOptionsNoView ) );
+
+        if ( docs[ g ] == 0 ) {
+
+            if ( verbose ) {
+                sprintf ( buff, "Can not open file \"%s\"", plan.Groups[ g ]->GetFile ( fi ) );
+                ShowMessage ( buff, ParserTitleError, ShowMessageWarning );
+                }
+
+            CloseDocs ( g );
+
+            return  false;
+            }
+        }
+
+
+    StringCopy ( fileout.Filename, result->GetFile ( fi ) );
+
+
+    for ( int tf1 = 0; tf1 < numtf; tf1 += blocksize ) {
+
+        int             tf2             = NoMore ( numtf, tf1 + blocksize ) - 1;
+        int             numtfblock      = tf2 - tf1 + 1;
+
+        for ( int g = 0; g < numgroups; g++ )
+            docs[ g ]->GetTracks ( tf1, tf2, blocks[ g ] );
+
+                                        // results are multiplexed, time frame by time frame
+        results.Resize ( numtfblock * numel );
+
+
+        OmpParallelBegin
+                                        // private evaluation stack
+        TArray2<float>      registers ( plan.MaxDepth, numel );
+
+        OmpFor
+
+        for ( int tf = 0; tf < numtfblock; tf++ )
+
+            plan.Execute ( blocks, tf, registers, results.GetArray () + tf * numel );
+
+        OmpParallelEnd
+
+
+        fileout.Write ( results );
+        }
+
+                                        // explicitly closing current file
+    fileout.End ();
+
+    CloseDocs ( numgroups );
+    }
+
+
+return  true;
+}
+
+
 //----------------------------------------------------------------------------
                                         // Force parsing (from potentially) new expression - not optimal, Parsing should be called only once for the same expression
 bool    TParser::Evaluate ( const char* expression, const TTokensStack& variables, bool verbose )
@@ -1450,6 +1885,13 @@ if ( Tokens.IsEmpty () )
 
 //Tokens.Show ( "Evaluate::Tokens Parsed" );
 
+                                        // element-wise expressions over groups can be done in a single pass
+TFusedPlan              plan;
+
+if ( CompileFused ( plan ) )
+
+    return  EvaluateFused ( plan, verbose );
+
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
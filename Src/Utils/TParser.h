@@ -16,8 +16,12 @@ limitations under the License.
 
 #pragma once
 
+#include    <vector>
+
 #include    "Geometry.TPoint.h"
 #include    "Files.TGoF.h"
+#include    "TArray2.h"
+#include    "TTracks.h"
 
 namespace crtl {
 
@@ -309,6 +313,57 @@ protected:
 };
 
 
+//----------------------------------------------------------------------------
+                                        // Fused evaluation
+                                        // Expressions made only of element-wise operations on groups of scalar data files, values and scalar variables,
+                                        // are compiled into a single postfix program. All groups are then streamed together block by block,
+                                        // and the program is applied on each time frame, without writing any intermediate results to temp files.
+enum                FusedInstructionType
+                    {
+                    FusedLoadGroup,
+                    FusedLoadValue,
+                    FusedUnaryOperator,
+                    FusedBinaryOperator,
+                    };
+
+
+class   TFusedInstruction
+{
+public:
+    FusedInstructionType    Type;
+    OperatorType            Code;       // operators only
+    int                     Group;      // group loading only: index in TFusedPlan::Groups
+    float                   Value;      // value loading only
+    const TToken*           Token;      // original token, used to compound the file names
+};
+
+                                        // Time frames read at once from each group
+constexpr int       FusedEvaluationBlockSize    = 512;
+
+
+class   TFusedPlan
+{
+public:
+                    TFusedPlan ()                   { Reset (); }
+
+
+    TTokenVariable*                 Result;     // the group variable assigned with the results
+    std::vector<TTokenVariable*>    Groups;     // all distinct input groups
+    std::vector<TFusedInstruction>  Program;    // postfix program
+    int             MaxDepth;                   // max depth of the evaluation stack
+    int             NumFiles;                   // common dimensions of all groups
+    int             NumTracks;
+    int             NumTimeFrames;
+
+
+    void            Reset               ();
+    bool            IsEmpty             ()  const   { return    Program.empty (); }
+
+    void            Execute             ( const std::vector<TTracks<float>>& blocks, int tf, TArray2<float>& registers, float* results )   const;
+    void            GetCompoundFilename ( int filei, char* filename, int maxlength )    const;
+};
+
+
 //----------------------------------------------------------------------------
 
 constexpr char*     ParserTitleError        = "Syntax Error";
@@ -336,6 +391,9 @@ protected:
 
     TTokensStack    Tokens;
 
+    bool            CompileFused        ( TFusedPlan& plan );
+    bool            EvaluateFused       ( const TFusedPlan& plan, bool verbose );
+
     bool            CheckChars          ( const char* expression, bool verbose )    const;
     bool            Tokenize            ( const char* expression, const TTokensStack& variables, TTokensStack& tokens, bool verbose )   const;
     void            SimplifiesUnaryOperators        ( TTokensStack& tokenstack );
@@ -160,6 +160,9 @@ for ( int tf = 0; tf < datain.GetNumMaps (); tf++ ) {
 
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
+                                        // static, so that content ids are never reused, even by a new object allocated at the same address
+std::atomic<UINT>   TRois::LastContentId ( 0 );
+
 
         TRois::TRois ()
       : Rois ( 0 )
@@ -210,6 +213,8 @@ TotalSelected       = 0;
 RoisSelected    .Reset ();
 RoiNames        .Reset ();
 AtomsNotSelected.Reset ();
+
+NewContentId ();
 }
 
 
@@ -227,6 +232,8 @@ RoiNames.Set ( numrois, RoiNameLength );
 
 AtomsNotSelected= TSelection ( dimension, OrderSorted );
 AtomsNotSelected.Set ();
+
+NewContentId ();
 }
 
 
@@ -290,6 +297,8 @@ if ( StringIsEmpty ( RoiNames[ NumRois ] ) )
 
 NumRois++;                              // now, we do have a new roi
 
+NewContentId ();
+
 
 if ( doallocate )                       // we assume it's the end
     AddRoiFinalize ();
@@ -321,6 +330,8 @@ for ( int r = 0; r < NumRois; r++ ) {
 TotalSelected   = (int) selcount;
 
 UpdateToRoisSelected ();
+
+NewContentId ();
 }
 
 
@@ -330,6 +341,8 @@ if ( NumRois == 0 )
     return;
 
 NumRois--;
+
+NewContentId ();
 }
 
 
@@ -339,6 +352,8 @@ void    TRois::UpdateToRoisSelected ()
 {
 for ( int r = 0; r < NumRois; r++ )
     RoisSelected.Set ( r, (bool) Rois[ r ].Selection );
+
+NewContentId ();
 }
 
                                         // scan RoisSelected, and set / clear the Rois
@@ -586,6 +601,8 @@ if ( ! Clipped ( roi, 0, GetNumRois () - 1 ) )
 
 RoisSelected.Set ( roi );
 Rois[ roi ].Selection.Set ();
+
+NewContentId ();
 }
 
 
@@ -604,6 +621,8 @@ if ( ! Clipped ( roi, 0, GetNumRois () - 1 ) )
 
 RoisSelected.Reset ( roi );
 Rois[ roi ].Selection.Reset ();
+
+NewContentId ();
 }
 
 
@@ -16,6 +16,8 @@ limitations under the License.
 
 #pragma once
 
+#include    <atomic>
+
 #include    "OpenGL.Colors.h"           // TGLColor
 
 namespace crtl {
@@ -81,6 +83,7 @@ public:
     int             GetDimension    ()      const           { return    Dimension; }
     int             GetNumRois      ()      const           { return    NumRois; }
     int             GetTotalSelected()      const           { return    TotalSelected; }
+    UINT            GetContentId    ()      const           { return    ContentId; }    // changes each time the ROIs are modified, and is unique across all TRois objects - used to cache results computed from a given content
 
     const TStrings* GetRoiNames ()          const           { return   &RoiNames; }
     const char*     GetRoiName  ( int r )   const           { return    RoiNames[ r ]; }
@@ -123,8 +126,8 @@ public:
 
 
     const TRoi&     operator    []      ( int i )   const   { return    Rois[ i ]; }
-          TRoi&     operator    []      ( int i )           { return    Rois[ i ]; }
-                    operator    TSelection& ()              { return    RoisSelected; }
+          TRoi&     operator    []      ( int i )           { NewContentId ();  return  Rois[ i ]; }   // caller might modify the ROI
+                    operator    TSelection& ()              { NewContentId ();  return  RoisSelected; }   // caller might modify the selection
 
 protected:
 
@@ -138,8 +141,11 @@ protected:
     TSelection      RoisSelected;           // handy to know which Rois are active (working like Tracks)
     TStrings        RoiNames;               // names of rois
     TSelection      AtomsNotSelected;       // keep track of elements that are not part of any ROI
+    UINT            ContentId;
+    static std::atomic<UINT>    LastContentId;
 
 
+    void            NewContentId ()                         { ContentId = ++LastContentId; }
     void            ResetClass ();
     void            Allocate ( int numrois, int dimension );
     void            AddRoiFinalize ();
@@ -16,10 +16,13 @@ limitations under the License.
 
 #pragma once
 
+#include    <algorithm>
+
 #include    "CartoolTypes.h"            // FilterTypes TMap
 #include    "TArray1.h"
 #include    "Geometry.TPoint.h"
 #include    "Strings.TSplitStrings.h"
+#include    "Math.FFT.h"                // CrossCorrelationFFT
 
 using namespace std;
 
@@ -163,6 +166,7 @@ public:
     double          CorrelationFisher   ( const TVector<TypeD> &v, bool centeraverage = true )                                                      const;  // Pearson Correlation -> Fisher
     double          CorrelationKendall  ( const TVector<TypeD> &v, bool centeraverage = true )                                                      const;  // Pearson Correlation -> Kendall Tau
     double          CrossCorrelation    ( const TVector<TypeD> &v, int T )                                                                          const;  // with v shifted by T
+    void            CrossCorrelations   ( const TVector<TypeD> &v, TVector<double>& cc )                                                            const;  // all shifts, cc[ i ] is for T = i - Dim1
     double          CorrelationToP      ( const TVector<TypeD> &v, bool centeraverage = true )                                                      const;  // Pearson Correlation to Significance p value (how much that correlation is meaningful)
     double          CorrelationToZ      ( const TVector<TypeD> &v, bool centeraverage = true )                                                      const;  // Pearson Correlation to Z Normal value (Fisher transformation)
     void            Cumulate            ( const TVector<TypeD> &v, double weight );             // weighted sum, weight could be negative
@@ -1033,33 +1037,14 @@ else                            SortDescending ( 0, IsInsideLimits ( size, 1, Di
 }
 
 
+                                        // Introsort: quicksort with median-of-3 pivots, switching to heapsort if recursion goes too deep, and insertion sort for small ranges
+                                        // No quadratic worst case nor deep recursion, even with lots of ties, like masked data full of 0's
 template <class TypeD>
 void    TVector<TypeD>::SortAscending ( int l, int r )
 {
 if ( r <= l )   return;
 
-
-int                 i               = l;
-int                 j               = r;
-TypeD               v               = GetValue ( ( l + r ) / 2 );
-
-
-do {
-    while ( GetValue ( i ) < v )    i++;
-
-    while ( v < GetValue ( j ) )    j--;
-
-    if ( i <= j ) {
-                                        // permutate i and j
-        Permutate ( Array[ i ], Array[ j ] );
-        i++;    j--;
-        }
-
-    } while ( i <= j );
-
-
-if ( l < j )    SortAscending ( l, j );
-if ( i < r )    SortAscending ( i, r );
+std::sort ( Array + l, Array + r + 1, [] ( const TypeD& v1, const TypeD& v2 ) { return v1 < v2; } );
 }
 
 
@@ -1068,28 +1053,7 @@ void    TVector<TypeD>::SortDescending ( int l, int r )
 {
 if ( r <= l )   return;
 
-
-int                 i               = l;
-int                 j               = r;
-TypeD               v               = GetValue ( ( l + r ) / 2 );
-
-
-do {
-    while ( GetValue ( i ) > v )    i++;
-
-    while ( v > GetValue ( j ) )    j--;
-
-    if ( i <= j ) {
-                                        // permutate i and j
-        Permutate ( Array[ i ], Array[ j ] );
-        i++;    j--;
-        }
-
-    } while ( i <= j );
-
-
-if ( l < j )    SortDescending ( l, j );
-if ( i < r )    SortDescending ( i, r );
+std::sort ( Array + l, Array + r + 1, [] ( const TypeD& v1, const TypeD& v2 ) { return v1 > v2; } );
 }
 
 
@@ -2651,22 +2615,56 @@ for ( int i = 0; i < Dim1; i++ )
 template <class TypeD>
 double  TVector<TypeD>::MaxCrossCorrelation ( const TVector<TypeD> &v, int &T )   const
 {
-double              cc;
-double              maxcc           = CrossCorrelation ( v, 0 );
+TVector<double>     cc;
+
+CrossCorrelations ( v, cc );
+
+                                        // lag 0 has precedence, then the first max
+double              maxcc           = cc[ Dim1 ];
+                                        // FFT and direct sums differ by rounding noise, which should not decide between equal lags
+double              tolerance       = CrossCorrelationTieTolerance * cc.GetAbsMaxValue ();
 
 T = 0;
 
-for ( int t = -Dim1; t < v.Dim1; t++ ) {
-    cc = CrossCorrelation ( v, t );
-    if ( cc > maxcc ) {
-        maxcc = cc;
-        T = t;
+for ( int t = -Dim1; t < v.Dim1; t++ )
+
+    if ( cc[ t + Dim1 ] > maxcc + tolerance ) {
+        maxcc   = cc[ t + Dim1 ];
+        T       = t;
         }
-    }
 
 return      maxcc;
 }
 
+                                        // Cross-correlation for all shifts T in [-Dim1..v.Dim1-1], cc[ T + Dim1 ] = CrossCorrelation ( v, T )
+                                        // Done in O(N log N) through FFT, except for short vectors where the direct O(N^2) sum is faster
+template <class TypeD>
+void    TVector<TypeD>::CrossCorrelations ( const TVector<TypeD> &v, TVector<double>& cc )  const
+{
+cc.Resize ( Dim1 + v.Dim1 + 1 );        // 1 extra slot so that lag 0 always exists, even for empty vectors
+
+if ( Dim1 == 0 || v.Dim1 == 0 )
+    return;
+
+
+if ( Dim1 + v.Dim1 < CrossCorrelationFFTMinSize ) {
+
+    for ( int t = -Dim1; t < v.Dim1; t++ )
+        cc[ t + Dim1 ]  = CrossCorrelation ( v, t );
+
+    return;
+    }
+
+                                        // lag -Dim1 has no overlap, and remains 0
+TVector<double>     x ( Dim1   );
+TVector<double>     y ( v.Dim1 );
+
+for ( int i = 0; i < Dim1;   i++ )      x[ i ]  =   Array[ i ];
+for ( int i = 0; i < v.Dim1; i++ )      y[ i ]  = v.Array[ i ];
+
+CrossCorrelationFFT ( x.GetArray (), Dim1, y.GetArray (), v.Dim1, cc.GetArray () + 1 );
+}
+
 
 template <class TypeD>
 void    TVector<TypeD>::Maxed ( const TVector<TypeD> &v )
@@ -2792,8 +2790,8 @@ double              center          = statcenter.Median ( false );
                                         // Bunch of estimates for  spreading
 //double            s0              = stat.SD ();                   //
 //double            s1              = stat.InterQuartileRange ();   // Robust, doesn't need a center
-double              s3              = stat.Sn ( 1000 );             // Robust, doesn't need a center
-double              s4              = stat.Qn ( 1000 );             // Robust, doesn't need a center - smaller values than Sn
+double              s3              = stat.Sn ();                   // Robust, doesn't need a center
+double              s4              = stat.Qn ();                   // Robust, doesn't need a center - smaller values than Sn
 double              s2              = stat.MAD ( CanAlterData );    // Robust, doesn't need a center
 
 double              spread          = ( s2 + s3 + s4 ) / 3;
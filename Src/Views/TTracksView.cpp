@@ -2201,6 +2201,8 @@ if ( HasWindowSlots () && ( how & GLPaintOpaque ) ) {
     int                         minp            = 0;
     int                         maxp            = CDPt.GetLength() - 1;
     int                         nump            = maxp - minp + 1;
+    int                         numcolumns;
+    bool                        decimate;
     float                      *tobuff;
     float                      *tobuff1;
     float                      *tobuff2;
@@ -2316,6 +2318,8 @@ if ( HasWindowSlots () && ( how & GLPaintOpaque ) ) {
         scaleh      = CurrentDisplaySpace == DisplaySpaceNone && ! OneMoreHoriz () ? (double) ( toslot->ToRight.Norm() - margin - 1 ) / ( nump > 1 ? nump - 1 : 1 )
                                                                                    : (double) ( toslot->ToRight.Norm() - margin     ) /   nump ;
 
+        numcolumns  = AtLeast ( 1, (int) ( toslot->ToRight.Norm() - margin ) );
+
                                         // smart superimpose: asked / not enough space / not pseudo tracks
         trackssuper =  ! IsIntensityModes () 
                     && ( ( TracksSuper && firstsel <= EEGDoc->GetLastRegularIndex() ) || ! enoughh );
@@ -2614,6 +2618,17 @@ if ( HasWindowSlots () && ( how & GLPaintOpaque ) ) {
 
             regel       = st <= EEGDoc->GetLastRegularIndex();  // regular electrode
 
+                                        // many more time frames than pixels? draw only the min/max of each screen column
+            decimate    =   IsTracksMode () 
+                        && ! ( (bool) Montage && regel ) 
+                        && ! IsFilling 
+                        && CurrentDisplaySpace == DisplaySpaceNone 
+                        && ! Outputing () 
+                        && CaptureMode != CaptureGLMagnify
+                        && nump >= TracksDecimationRatio * numcolumns
+                                        // columns are computed once, for both the background and the actual lines - regular drawing is used if this fails
+                        && SetDecimatedTrack ( st, minp, maxp, numcolumns, regel ? OffsetTracks : 0 );
+
             glScaled ( 1, scalet, 1 );
             descaley    = 1 / scalev / scalet;
 
@@ -2899,7 +2914,14 @@ if ( HasWindowSlots () && ( how & GLPaintOpaque ) ) {
 
                 BackColor.GLize ();
 
-                if ( IsTracksMode () ) {
+                if ( decimate ) {       // IsTracksMode (), zoomed-out
+
+                    glLineWidth ( linewidth + 2 );
+
+                    DrawDecimatedTrack ();
+                    }
+
+                else if ( IsTracksMode () ) {
 
                     glLineWidth ( linewidth + 2 );
 
@@ -3384,6 +3406,11 @@ if ( HasWindowSlots () && ( how & GLPaintOpaque ) ) {
 
                 } // IsBarsMode ()
 
+            else if ( decimate ) {      // IsTracksMode (), zoomed-out
+
+                DrawDecimatedTrack ();
+                }
+
             else { // IsTracksMode ()
 
                 glBegin ( GL_LINE_STRIP );
@@ -6453,6 +6480,72 @@ UpdateBuffers ( -1, -1, CDPt.GetMin(), CDPt.GetMax() );
 }
 
 
+//----------------------------------------------------------------------------
+                                        // Preparing a track at screen resolution when there are many more time frames than pixels.
+                                        // Each column is drawn from the min to the max values it covers, alternating direction
+                                        // so the line strip stays continuous - visually identical to the full drawing, but with
+                                        // only 2 vertices per column, sent as a single vertex array.
+                                        // Returns false if decimation is not worth it or could not be done, caller then draws the usual way.
+bool    TTracksView::SetDecimatedTrack ( int st, int minp, int maxp, int numcolumns, float offset )
+{
+DecimationVertices.clear ();
+
+int                 nump            = maxp - minp + 1;
+
+if ( numcolumns <= 0 || nump < TracksDecimationRatio * numcolumns )
+    return  false;
+
+                                        // pyramids span the whole current page
+if ( Decimation.GetNumTracks () != EegBuff.GetDim1 () 
+  || Decimation.GetNumPoints () != CDPt.GetLength () )
+
+    Decimation.Set ( EegBuff.GetDim1 (), CDPt.GetLength () );
+
+
+DecimationMin.resize ( numcolumns );
+DecimationMax.resize ( numcolumns );
+
+numcolumns  = Decimation.GetColumns ( st, EegBuff[ st ], minp, maxp, numcolumns, DecimationMin.data (), DecimationMax.data () );
+
+if ( numcolumns <= 0 )
+    return  false;
+
+
+DecimationVertices.resize ( 4 * numcolumns );
+
+GLfloat*            tov             = DecimationVertices.data ();
+
+for ( int c = 0; c < numcolumns; c++ ) {
+                                        // center of the column, in time frames
+    GLfloat     x       = minp + ( (double) nump * ( c + 0.5 ) ) / numcolumns - 0.5;
+    bool        upward  = IsEven ( c );
+
+    *tov++  = x;
+    *tov++  = ( upward ? DecimationMin[ c ] : DecimationMax[ c ] ) - offset;
+    *tov++  = x;
+    *tov++  = ( upward ? DecimationMax[ c ] : DecimationMin[ c ] ) - offset;
+    }
+
+return  true;
+}
+
+                                        // Drawing the vertices set by SetDecimatedTrack - can be called multiple times for the same track
+void    TTracksView::DrawDecimatedTrack ()
+{
+if ( DecimationVertices.empty () )
+    return;
+
+
+glEnableClientState     ( GL_VERTEX_ARRAY );
+glVertexPointer         ( 2, GL_FLOAT, 0, DecimationVertices.data () );
+
+glDrawArrays            ( GL_LINE_STRIP, 0, (GLsizei) DecimationVertices.size () / 2 );
+
+glVertexPointer         ( 2, GL_FLOAT, 0, 0 );
+glDisableClientState    ( GL_VERTEX_ARRAY );
+}
+
+
 //----------------------------------------------------------------------------
                                         // Optimized reload of the eeg buffer; handles ALL the cases.
 void    TTracksView::UpdateBuffers ( long oldtfmin, long oldtfmax, long newtfmin, long newtfmax )
@@ -6461,6 +6554,9 @@ void    TTracksView::UpdateBuffers ( long oldtfmin, long oldtfmax, long newtfmin
 if ( oldtfmin == newtfmin && oldtfmax == newtfmax )
     return;
 
+                                        // buffer content is going to change in any case below
+Decimation.Reset ();
+
                                         // trick: in case of 2D5 buffer, this will still do the current page
 auto                bigblock        = [] ( const TArray2<float>& buff ) -> size_t   { return  buff.GetDim1 () * buff.GetDim2 (); };
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include    "TTFCursor.h"
 
 #include    "TTracksDoc.h"
+#include    "TTracksDecimation.h"
 #include    "TElectrodesDoc.h"
 #include    "TRoisDoc.h"
 
@@ -65,6 +66,10 @@ constexpr int       EEGGLVIEW_DELTATRACKS       =   5;
 constexpr double    EEGGLVIEW_MAXSPEEDMIN       = 10.0;
 
 
+                                        // min/max decimation kicks in when there are at least that many time frames per screen column
+constexpr int       TracksDecimationRatio       = 4;
+
+
 constexpr double    TracksAltitude3D            = 0.10;
 
 constexpr double    CursorHeightFactor3D        = 1.5;
@@ -426,6 +431,11 @@ protected:
     GLfloat             LineWidth;
     TGLQuadMesh         QuadMesh;
 
+    TTracksDecimation<float>    Decimation;         // min/max pyramids of EegBuff, rebuilt lazily after each buffer update
+    std::vector<float>          DecimationMin;
+    std::vector<float>          DecimationMax;
+    std::vector<GLfloat>        DecimationVertices; // vertex array sent in one go to OpenGL
+
                                         // Display mode handling
     bool                IsTracksMode            ()  const   { return IsFlag ( DisplayMode, DisplayTracks          );    }
     bool                IsBarsMode              ()  const   { return IsFlag ( DisplayMode, DisplayBars            );    }
@@ -455,6 +465,8 @@ protected:
     void                SetTextMargin               ();
     virtual void        UpdateBuffers               ( long oldtfmin, long oldtfmax, long newtfmin, long newtfmax );
     void                ReloadBuffers               ();
+    bool                SetDecimatedTrack           ( int st, int minp, int maxp, int numcolumns, float offset );
+    void                DrawDecimatedTrack          ();
     virtual bool        HasStandardDeviation        ()                          const       { return ShowSD && EEGDoc->HasStandardDeviation (); }
     virtual void        ResetScaleTracks            ( const TSelection *sel = 0 );
     double              ScalingContrastToColorTable ( double scalingcontrast )  const       { return 0.1 + 999.9 * scalingcontrast * scalingcontrast; }
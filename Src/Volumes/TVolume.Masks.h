@@ -1244,6 +1244,13 @@ Insert ( edge );
 }
 */
 
+                                        // Watershed by flooding, with a hierarchical queue of one FIFO per level:
+                                        //  - levels are processed by increasing altitude, i.e. increasing values for ridges, decreasing ones for valleys
+                                        //  - voxels reached by the flood take the basin of their deepest neighbor
+                                        //  - voxels not reached when their level comes up are the seeds of new basins
+                                        //  - when two basins meet, the shallow one is fused into the deeper one if it is relatively close to the current altitude,
+                                        //    otherwise the meeting voxel is an edge, set to the current altitude
+                                        // Each voxel is queued at most once, so processing is linear in the number of voxels and of levels
 template <class TypeD>
 void    TVolume<TypeD>::FilterWaterfall ( FilterTypes filtertype, FctParams& /*params*/, bool showprogress )
 {
@@ -1259,236 +1266,228 @@ headmask.Filter ( FilterTypeToMask, p );
 
 p ( FilterParamDiameter )     = 1;
 headmask.Filter ( FilterTypeDilate, p );
-//headmask.Filter ( FilterTypeErode, p );
 
-                                        // we can restrict the processing to a smaller interval
-TBoundingBox<int>   bounding ( headmask, false, 1 );
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+bool                ridges          = filtertype == FilterTypeWaterfallRidges;
+double              maxlevel        = GetMaxValue ();
+double              minlevel        = GetMinValue ();
+                                        // fusion tolerance, between the current altitude and the bottom of the shallow basin
+double              reldiff         = ridges ? 0.99 : 0.30;
+
+
+if ( maxlevel == 0 || maxlevel == minlevel )
+    return;
+
+                                        // altitude of the flood always increases, and remains positive
+auto                ToAltitude      = [ & ] ( double v )    { return  ridges ? v : maxlevel - v; };
+
+                                        // integer data: one level per value, as long as there are not too many of them
+int                 numlevels       = IsInteger () ? NoMore ( WaterfallMaxNumLevels, (int) ( maxlevel - minlevel ) + 1 ) : WaterfallMaxNumLevels;
+double              altmin          = ToAltitude ( ridges ? minlevel : maxlevel );
+double              altscale        = ( numlevels - 1 ) / ( maxlevel - minlevel );
+
+auto                ToLevel         = [ & ] ( int i )       { return  Clip ( Round ( ( ToAltitude ( Array[ i ] ) - altmin ) * altscale ), 0, numlevels - 1 ); };
+auto                LevelToAltitude = [ & ] ( int l )       { return  altmin + l / altscale; };
 
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Voxels of the head sorted by levels, with a counting sort
+TArray1<int>        level       ( LinearDim );
+TArray1<int>        levelstart  ( numlevels + 1 );
 
-//TVolume<TypeD>    original    ( *this );
-TVolume<TypeD>      edge        ( Dim1, Dim2, Dim3 );
-TVolume<uchar>      done        ( Dim1, Dim2, Dim3 );
-TVolume<uchar>      newdone     ( Dim1, Dim2, Dim3 );
+for ( int i = 0; i < LinearDim; i++ )
+    if ( headmask[ i ] ) {
+        level[ i ]  = ToLevel ( i );
+        levelstart[ level[ i ] + 1 ]++;
+        }
+
+for ( int l = 0; l < numlevels; l++ )
+    levelstart[ l + 1 ]    += levelstart[ l ];
+
+
+TArray1<int>        sorted      ( levelstart[ numlevels ] );
+TArray1<int>        fill        ( numlevels );
+
+for ( int l = 0; l < numlevels; l++ )
+    fill[ l ]   = levelstart[ l ];
+
+for ( int i = 0; i < LinearDim; i++ )
+    if ( headmask[ i ] )
+        sorted[ fill[ level[ i ] ]++ ]  = i;
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Hierarchical queue: one linked FIFO per level, each voxel being queued only once
+TArray1<int>        queuehead   ( numlevels );
+TArray1<int>        queuetail   ( numlevels );
+TArray1<int>        queuenext   ( LinearDim );
+TVolume<uchar>      queued      ( Dim1, Dim2, Dim3 );
+
+for ( int l = 0; l < numlevels; l++ )
+    queuehead[ l ]  = queuetail[ l ]    = -1;
+
+
+auto                Push            = [ & ] ( int i, int l )
+{
+queued[ i ]     = true;
+queuenext[ i ]  = -1;
+
+if ( queuetail[ l ] < 0 )   queuehead[ l ]              = i;
+else                        queuenext[ queuetail[ l ] ] = i;
+
+queuetail[ l ]  = i;
+};
+
+
+auto                Pop             = [ & ] ( int l )
+{
+int                 i               = queuehead[ l ];
+
+queuehead[ l ]  = queuenext[ i ];
+
+if ( queuehead[ l ] < 0 )
+    queuetail[ l ]  = -1;
+
+return  i;
+};
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Basins, 0 being unassigned, fused with a union-find forest
 TVolume<int>        region      ( Dim1, Dim2, Dim3 );
-TVolume<TypeD>      height      ( Dim1, Dim2, Dim3 );
+TArray1<int>        parent      ( levelstart[ numlevels ] + 1 );
+TArray1<double>     height      ( levelstart[ numlevels ] + 1 );    // altitude of the bottom of each basin
+int                 numregions      = 0;
 
+auto                FindRoot        = [ &parent ] ( int r )
+{
+while ( parent[ r ] != r ) {
+    parent[ r ] = parent[ parent[ r ] ];
+    r           = parent[ r ];
+    }
+return  r;
+};
 
-bool                ridges          = filtertype == FilterTypeWaterfallRidges;
-TypeD               maxlevel        = GetMaxValue ();
-TypeD               minlevel        = GetMinValue ();
-TypeD               firstl          = ridges ? minlevel : maxlevel;
-//int                 incl            = ridges ? 1 : -1;  // or some delta?
-TypeD               delta           = ( maxlevel - minlevel ) / 255;
-TypeD               incl            = ridges ? delta : -delta;
-bool                edgegrown;
-TypeD               w;
-int                 nextregioni     = 0;
 
+TVolume<TypeD>      edge        ( Dim1, Dim2, Dim3 );
+int                 neighbors[ 6 ];
+int                 numneighbors;
 
-if ( maxlevel == 0 )
-    return;
+                                        // 6 neighbors within the volume
+auto                GetNeighbors    = [ & ] ( int i )
+{
+int                 x;
+int                 y;
+int                 z;
 
+LinearIndexToXYZ ( i, x, y, z );
 
-TSuperGauge         Gauge ( FilterPresets[ filtertype ].Text, showprogress ? 100 : 0 );
+numneighbors    = 0;
 
+if ( x > 0        )     neighbors[ numneighbors++ ] = IndexesToLinearIndex ( x - 1, y,     z     );
+if ( x < Dim1 - 1 )     neighbors[ numneighbors++ ] = IndexesToLinearIndex ( x + 1, y,     z     );
+if ( y > 0        )     neighbors[ numneighbors++ ] = IndexesToLinearIndex ( x,     y - 1, z     );
+if ( y < Dim2 - 1 )     neighbors[ numneighbors++ ] = IndexesToLinearIndex ( x,     y + 1, z     );
+if ( z > 0        )     neighbors[ numneighbors++ ] = IndexesToLinearIndex ( x,     y,     z - 1 );
+if ( z < Dim3 - 1 )     neighbors[ numneighbors++ ] = IndexesToLinearIndex ( x,     y,     z + 1 );
+};
 
-                                        // grow from the 0 to max level
-for ( TypeD l = firstl; IsInsideLimits ( l, minlevel, maxlevel ); l += incl ) {
+                                        // assign a basin to a voxel from its already flooded neighbors, then queue its free neighbors
+auto                Flood           = [ & ] ( int i, int l )
+{
+double              w               = LevelToAltitude ( l );
 
-                                        // increasing values
-    w       = ridges ? l : maxlevel - l;
+GetNeighbors ( i );
 
-    Gauge.SetValue ( SuperGaugeDefaultPart, Percentage ( w + 1, maxlevel ) );
+                                        // allocate voxel to the deepest neighboring basin
+int                 best            = 0;
 
+for ( int n = 0; n < numneighbors; n++ ) {
 
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // 1) ~region growing of current edge, @ current level
-    do {
-        edgegrown   = false;
-        newdone     = done;
-                                        // Not very efficient, still does a boost
-        OmpParallelFor
+    if ( ! region[ neighbors[ n ] ] )
+        continue;
 
-        for ( int x = bounding.XMin (); x <= bounding.XMax (); x ++ )
-        for ( int y = bounding.YMin (); y <= bounding.YMax (); y ++ )
-        for ( int z = bounding.ZMin (); z <= bounding.ZMax (); z ++ ) {
+    int         r       = FindRoot ( region[ neighbors[ n ] ] );
 
-                                        // already done, or not from current level?
-//          if ( ! headmask ( x, y,z ) || done ( x, y, z ) || GetValue ( x, y, z ) != l )
-            if ( ! headmask ( x, y,z ) || done ( x, y, z ) || fabs ( GetValue ( x, y, z ) - l ) > delta )   // ????? to be tested ?????
-                continue;
+    if ( best == 0 || height[ r ] < height[ best ] )
+        best    = r;
+    }
 
-                                        // not an edge?
-            if ( done.GetNumNeighbors ( x, y, z, Neighbors6 ) == 0 )
-//          if ( done.GetNumNeighbors ( x, y, z, Neighbors18 ) == 0 )
-//          if ( done.GetNumNeighbors ( x, y, z, Neighbors26 ) == 0 )
-                continue;
+                                        // no flooded neighbors: this is a new basin
+if ( best == 0 ) {
+    best            = ++numregions;
+    parent[ best ]  = best;
+    height[ best ]  = w;
+    }
 
-                                        // grow edge!
-            newdone ( x, y, z )     = true;     // don't update original voxels now, as we also test # of neighbors from it...
-            edgegrown               = true;     // global flag
-            TypeD       newh        = w;
+region[ i ]     = best;
 
-                                        // allocate new voxel to best neighborhood bidder
-            auto    IsBestNeighbor  = [ & ] ( int X, int Y, int Z )    { if ( height ( X, Y, Z ) && height ( X, Y, Z ) < newh )  { newh = height ( X, Y, Z );  region ( x, y, z ) = region ( X, Y, Z ); } };
+                                        // any other basin met: fusion or edge
+for ( int n = 0; n < numneighbors; n++ ) {
 
-                                        // 6 neighbors
-            IsBestNeighbor ( x + 1, y, z );
-            IsBestNeighbor ( x - 1, y, z );
-            IsBestNeighbor ( x, y + 1, z );
-            IsBestNeighbor ( x, y - 1, z );
-            IsBestNeighbor ( x, y, z + 1 );
-            IsBestNeighbor ( x, y, z - 1 );
-/*                                        // 18 neighbors
-            IsBestNeighbor ( x + 1, y + 1, z );
-            IsBestNeighbor ( x + 1, y - 1, z );
-            IsBestNeighbor ( x - 1, y + 1, z );
-            IsBestNeighbor ( x - 1, y - 1, z );
-
-            IsBestNeighbor ( x + 1, y, z + 1 );
-            IsBestNeighbor ( x + 1, y, z - 1 );
-            IsBestNeighbor ( x - 1, y, z + 1 );
-            IsBestNeighbor ( x - 1, y, z - 1 );
-
-            IsBestNeighbor ( x, y + 1, z + 1 );
-            IsBestNeighbor ( x, y + 1, z - 1 );
-            IsBestNeighbor ( x, y - 1, z + 1 );
-            IsBestNeighbor ( x, y - 1, z - 1 );
-*/
-/*                                        // 26 neighbors
-            IsBestNeighbor ( x + 1, y + 1, z + 1 );
-            IsBestNeighbor ( x + 1, y + 1, z - 1 );
-            IsBestNeighbor ( x + 1, y - 1, z + 1 );
-            IsBestNeighbor ( x + 1, y - 1, z - 1 );
-            IsBestNeighbor ( x - 1, y + 1, z + 1 );
-            IsBestNeighbor ( x - 1, y + 1, z - 1 );
-            IsBestNeighbor ( x - 1, y - 1, z + 1 );
-            IsBestNeighbor ( x - 1, y - 1, z - 1 );
-*/
-            height  ( x, y, z )     = newh;
+    if ( ! region[ neighbors[ n ] ] )
+        continue;
 
-            } // for x, y, z
+    int         r       = FindRoot ( region[ neighbors[ n ] ] );
 
+    if ( r == best )
+        continue;
 
-        if ( edgegrown )
-            done    = newdone;
+    if ( RelativeDifference ( w, height[ r ] ) < reldiff
+      && height[ best ] < height[ r ] ) {
 
-        } while ( edgegrown ); // do grow level
+        parent[ r ]     = best;
+        edge[ i ]       = 0;
+        }
+    else
+        edge[ i ]       = (TypeD) w;
+    }
 
+                                        // neighbors are flooded at their own level, or at the current one if lower
+for ( int n = 0; n < numneighbors; n++ ) {
 
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // 2) edges have been grown, create new seeds which have no neighbors
-    for ( int x = bounding.XMin (); x <= bounding.XMax (); x ++ )
-    for ( int y = bounding.YMin (); y <= bounding.YMax (); y ++ )
-    for ( int z = bounding.ZMin (); z <= bounding.ZMax (); z ++ )
-                                        // each new voxel is a region, fusion will take place at next step
-//      if ( headmask ( x, y,z ) && ! done ( x, y, z ) && GetValue ( x, y, z ) == l ) {
-        if ( headmask ( x, y,z ) && ! done ( x, y, z ) && fabs ( GetValue ( x, y, z ) - l ) <= delta ) {
-            region ( x, y, z )  = ++nextregioni;
-            done   ( x, y, z )  = true;
-            height ( x, y, z )  = w;
-            }
+    int         j       = neighbors[ n ];
 
+    if ( headmask[ j ] && ! queued[ j ] )
+        Push ( j, max ( l, level[ j ] ) );
+    }
+};
 
-    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // 3) check for boundaries -> fusion or edges
-//  double      reldiff     = ridges ? 0.05 : 0.30;
-    double      reldiff     = ridges ? 0.99 : 0.30;
-//    #define     absdiff     30
-                                        // Not very efficient, still does a boost
-    OmpParallelFor
 
-    for ( int x = AtLeast ( 1, bounding.XMin () ); x <= NoMore ( Dim1 - 2, bounding.XMax () ); x ++ )
-    for ( int y = AtLeast ( 1, bounding.YMin () ); y <= NoMore ( Dim2 - 2, bounding.YMax () ); y ++ )
-    for ( int z = AtLeast ( 1, bounding.ZMin () ); z <= NoMore ( Dim3 - 2, bounding.ZMax () ); z ++ ) {
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-                                        // not done?
-        if ( ! headmask ( x, y,z ) || ! done ( x, y, z ) )
-////        if ( ! headmask ( x, y,z ) || ! done ( x, y, z ) || GetValue ( x, y, z ) != l )
-//        if ( ! headmask ( x, y,z ) || ! done ( x, y, z ) || fabs ( GetValue ( x, y, z ) - l ) > delta )
-            continue;
+TSuperGauge         Gauge ( FilterPresets[ filtertype ].Text, showprogress ? 100 : 0 );
 
-                                        // test neighborhood
-
-//            if ( w - height ( x + 1, y, z ) < absdiff && height ( x, y, z ) < height ( x + 1, y, z ) ) {
-//            if ( ( ( ridges && RelativeDifference ( w, height ( X, Y, Z ) ) > reldiff ) || ( ! ridges && RelativeDifference ( w, height ( X, Y, Z ) ) < reldiff ) )
-//            if ( RelativeDifference ( w, height ( X, Y, Z ) ) < reldiff )
-
-
-#define FusionOrEdge(X,Y,Z) \
-        if ( region ( X, Y, Z ) && region ( x, y, z ) != region ( X, Y, Z ) ) { \
-            if ( ( RelativeDifference ( w, height ( X, Y, Z ) ) < reldiff ) \
-              && height ( x, y, z ) < height ( X, Y, Z ) ) { \
-                int     toremap     = region ( X, Y, Z ); \
-                int     newreg      = region ( x, y, z ); \
-                TypeD   newh        = height ( x, y, z ); \
-                edge ( x, y, z )    = 0; \
- \
-                for ( int i = 0; i < LinearDim; i++ ) \
-                    if ( region[ i ] == toremap ) { \
-                        region[ i ] = newreg; \
-                        height[ i ] = newh; \
-                        } \
-                } \
-            else \
-                edge ( x, y, z )    = w; \
-            }
-                                        // 6 neighbors
-        FusionOrEdge ( x + 1, y, z );
-        FusionOrEdge ( x - 1, y, z );
-        FusionOrEdge ( x, y + 1, z );
-        FusionOrEdge ( x, y - 1, z );
-        FusionOrEdge ( x, y, z + 1 );
-        FusionOrEdge ( x, y, z - 1 );
-/*                                        // 18 neighbors
-        FusionOrEdge ( x + 1, y + 1, z );
-        FusionOrEdge ( x + 1, y - 1, z );
-        FusionOrEdge ( x - 1, y + 1, z );
-        FusionOrEdge ( x - 1, y - 1, z );
-
-        FusionOrEdge ( x + 1, y, z + 1 );
-        FusionOrEdge ( x + 1, y, z - 1 );
-        FusionOrEdge ( x - 1, y, z + 1 );
-        FusionOrEdge ( x - 1, y, z - 1 );
-
-        FusionOrEdge ( x, y + 1, z + 1 );
-        FusionOrEdge ( x, y + 1, z - 1 );
-        FusionOrEdge ( x, y - 1, z + 1 );
-        FusionOrEdge ( x, y - 1, z - 1 );
-*/
-/*                                        // 26 neighbors
-        FusionOrEdge ( x + 1, y + 1, z + 1 );
-        FusionOrEdge ( x + 1, y + 1, z - 1 );
-        FusionOrEdge ( x + 1, y - 1, z + 1 );
-        FusionOrEdge ( x + 1, y - 1, z - 1 );
-        FusionOrEdge ( x - 1, y + 1, z + 1 );
-        FusionOrEdge ( x - 1, y + 1, z - 1 );
-        FusionOrEdge ( x - 1, y - 1, z + 1 );
-        FusionOrEdge ( x - 1, y - 1, z - 1 );
-*/
-        } // for x, y, z
 
+for ( int l = 0; l < numlevels; l++ ) {
 
-                                        // debugging!
-//    Insert ( edge );
-    } // for l
+    Gauge.SetValue ( SuperGaugeDefaultPart, Percentage ( l + 1, numlevels ) );
 
+                                        // 1) grow the existing basins, the FIFO order propagating the flood from the shores
+    while ( queuehead[ l ] >= 0 )
+        Flood ( Pop ( l ), l );
 
-//edge.ApplyMaskToData ( headmask );
+                                        // 2) voxels of this level not reached by the flood are new seeds, which then grow through their plateau
+    for ( int si = levelstart[ l ]; si < levelstart[ l + 1 ]; si++ ) {
 
-                                        // copy resulting edges
-Insert ( edge );
+        int         i       = sorted[ si ];
 
-                                        // show the regions !!!!!!!
-//for ( int i = 0; i < LinearDim; i++ ) {
-//    GetValue ( i ) = (uchar) ( region ( i ) ? region ( i ) % 253 + 1 : 0 );
-////    if ( edge ( i ) )   GetValue ( i ) = (uchar) 255;
-//    }
+        if ( queued[ i ] )
+            continue;
+
+        Push ( i, l );
+
+        while ( queuehead[ l ] >= 0 )
+            Flood ( Pop ( l ), l );
+        }
+    } // for l
 
-}
 
+                                        // copy resulting edges
+Insert ( edge );
+}
 
 //----------------------------------------------------------------------------
                                         // this  Operation=  operand2
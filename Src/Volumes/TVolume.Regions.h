@@ -1,19 +1,19 @@
-/************************************************************************\
- 2024-2025 Denis Brunet, University of Geneva, Switzerland.
-
-Licensed under the Apache License, Version 2.0 (the "License");
-you may not use this file except in compliance with the License.
-You may obtain a copy of the License at
-
-   http://www.apache.org/licenses/LICENSE-2.0
-
-Unless required by applicable law or agreed to in writing, software
-distributed under the License is distributed on an "AS IS" BASIS,
-WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-See the License for the specific language governing permissions and
-limitations under the License.
-\************************************************************************/
-
+/************************************************************************\
+ 2024-2025 Denis Brunet, University of Geneva, Switzerland.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+\************************************************************************/
+
 #pragma once
 
 namespace crtl {
@@ -128,308 +128,221 @@ do {
 
 
 //----------------------------------------------------------------------------
-                                        // Each geometrical cluster of same level becomes a region
+                                        // Connected components labeling, with a two-pass union-find:
+                                        //  - first pass gives provisional labels, merging them whenever 2 already scanned neighbors are connected
+                                        //  - second pass resolves the labels, and gathers the size and bounding box of each component
+                                        // Components are numbered in the order of their first voxel in memory, which is also the order the former seed-growing scan was producing
+                                        // Regions are then directly allocated to their bounding box, so the whole process remains linear with the volume size
 template <class TypeD>
-void    TVolume<TypeD>::LevelsClustersToRegions ( TVolumeRegions& gor, int minvoxels, int maxvoxels, NeighborhoodType neighborhood, bool showprogress )
+void    TVolume<TypeD>::ConnectedComponentsToRegions ( TVolumeRegions& gor, int minvoxels, int maxvoxels, NeighborhoodType neighborhood, bool samelevel, bool showprogress )
 {
 gor.Reset ();
 
-                                        // account for the remaining voxels to process
-TVolume<uchar>      voxelstodo ( Dim1, Dim2, Dim3 );
-                                        // binarize
-OmpParallelFor
-
-for ( int i = 0; i < LinearDim; i++ )
-    voxelstodo[ i ] = (bool) Array[ i ];
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-int                 index           = 1;
-TypeD               l;
-TVolumeRegion*      region;
+int                 numvoxelstotal  = GetNumSet ();
 
-TVolume<uchar>      edge ( Dim1, Dim2, Dim3 );
-int                 edgecount;
-//int                 x,  y,  z;
-int                 j;
-int                 numvoxelstotal  = voxelstodo.GetNumSet ();
-int                 numvoxelstodo   = numvoxelstotal;
-TBoundingBox<int>   bremain;
-TBoundingBox<int>   bedge;
+if ( numvoxelstotal == 0 )
+    return;
 
 
-TSuperGauge         Gauge ( FilterPresets[ FilterTypeClustersToRegions ].Text, showprogress ? numvoxelstotal : 0 );
+TSuperGauge         Gauge ( FilterPresets[ FilterTypeClustersToRegions ].Text, showprogress ? 2 * Dim1 : 0 );
 
 Gauge.SetValue ( SuperGaugeDefaultPart, 0 );
 
 
-do {
-
-    l           = 0;
-    edge.ResetMemory ();
-    edgecount   = 0;
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Neighbors already scanned, i.e. before current voxel in memory order (x, then y, then z)
+                                        // 3 / 9 / 13 of them, having up to 1 / 2 / 3 non-null offsets, for the 6 / 18 / 26 neighborhoods
+int                 maxoffsets      = neighborhood == Neighbors6 ? 1 : neighborhood == Neighbors18 ? 2 : 3;
+int                 numbackward     = 0;
+int                 backward[ 13 ][ 3 ];
+
+for ( int dx = -1; dx <= 0; dx++ )
+for ( int dy = -1; dy <= 1; dy++ )
+for ( int dz = -1; dz <= 1; dz++ ) {
+
+    if ( ! ( dx < 0 || dx == 0 && dy < 0 || dx == 0 && dy == 0 && dz < 0 ) )
+        continue;
+
+    if ( abs ( dx ) + abs ( dy ) + abs ( dz ) > maxoffsets )
+        continue;
+
+    backward[ numbackward ][ 0 ]    = dx;
+    backward[ numbackward ][ 1 ]    = dy;
+    backward[ numbackward ][ 2 ]    = dz;
+    numbackward++;
+    }
 
-                                        // global box of remaining voxels
-    bremain     = TBoundingBox<int> ( voxelstodo, false, 0.1 );
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // First pass: provisional labels
+TArray1<int>        component ( LinearDim );            // 0 for background
+TArray1<int>        parent    ( numvoxelstotal + 1 );   // union-find forest of provisional labels, 0 being unused
+int                 numprovisional  = 0;
 
-    for ( int x = bremain.XMin (); x <= bremain.XMax () && ! edgecount; x++ )
-    for ( int y = bremain.YMin (); y <= bremain.YMax () && ! edgecount; y++ )
-    for ( int z = bremain.ZMin (); z <= bremain.ZMax (); z++ )
+                                        // with path halving
+auto                FindRoot        = [ &parent ] ( int c )
+{
+while ( parent[ c ] != c ) {
+    parent[ c ] = parent[ parent[ c ] ];
+    c           = parent[ c ];
+    }
+return  c;
+};
+                                        // the lowest label always remains the root, which is also the first one met in the scan
+auto                Union           = [ &parent, &FindRoot ] ( int c1, int c2 )
+{
+c1  = FindRoot ( c1 );
+c2  = FindRoot ( c2 );
 
-        if ( voxelstodo ( x, y, z ) ) {
+if      ( c1 < c2 )     parent[ c2 ]    = c1;
+else if ( c2 < c1 )     parent[ c1 ]    = c2;
+};
 
-            edge       ( x, y, z )  = true; // edge seed
-            edgecount               = 1;
-            bedge.Set ( x, x, y, y, z, z );
 
-            voxelstodo ( x, y, z )  = false;
-            numvoxelstodo--;
+for ( int x = 0; x < Dim1; x++ ) {
 
-            l                       = GetValue ( x, y, z );
-            break;
-            }
+    Gauge.SetValue ( SuperGaugeDefaultPart, x );
 
-    if ( edgecount == 0 )               // no more voxels?
-        break;                          // finito
+    for ( int y = 0; y < Dim2; y++ )
+    for ( int z = 0; z < Dim3; z++ ) {
 
+        int         i       = IndexesToLinearIndex ( x, y, z );
 
-    region          = new TVolumeRegion ( this, index );
+        if ( ! Array[ i ] )
+            continue;
 
+        int         c       = 0;
 
-    do {                                // progress the edge, if the same level, connected, and not already done
+        for ( int n = 0; n < numbackward; n++ ) {
 
-        for ( int x = bedge.XMin (); x <= bedge.XMax (); x++ )
-        for ( int y = bedge.YMin (); y <= bedge.YMax (); y++ )
-        for ( int z = bedge.ZMin (); z <= bedge.ZMax (); z++ ) {
+            int     x2      = x + backward[ n ][ 0 ];
+            int     y2      = y + backward[ n ][ 1 ];
+            int     z2      = z + backward[ n ][ 2 ];
 
-            if ( ! edge ( x, y, z ) )
+            if ( x2 < 0 || y2 < 0 || y2 >= Dim2 || z2 < 0 || z2 >= Dim3 )
                 continue;
 
-                                        // reset current edge
-            region->Add ( x, y, z );
-            edge        ( x, y, z ) = false;
-            edgecount--;
-
-                                        // progress the edge, doing as much as possible in straight directions
-                                        // 6 neighbors
-            {
-            for ( int x2 = x - 1; x2 >= bremain.XMin (); x2-- ) {
-                j   = IndexesToLinearIndex ( x2, y, z );
-                if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                else break;
-                }
-
-            for ( int x2 = x + 1; x2 <= bremain.XMax (); x2++ ) {
-                j   = IndexesToLinearIndex ( x2, y, z );
-                if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                else break;
-                }
-
-            for ( int y2 = y - 1; y2 >= bremain.YMin (); y2-- ) {
-                j   = IndexesToLinearIndex ( x, y2, z );
-                if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                else break;
-                }
+            int     j       = IndexesToLinearIndex ( x2, y2, z2 );
 
-            for ( int y2 = y + 1; y2 <= bremain.YMax (); y2++ ) {
-                j   = IndexesToLinearIndex ( x, y2, z );
-                if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                else break;
-                }
-
-            for ( int z2 = z - 1; z2 >= bremain.ZMin (); z2-- ) {
-                j   = IndexesToLinearIndex ( x, y, z2 );
-                if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                else break;
-                }
+            if ( component[ j ] == 0
+              || samelevel && Array[ j ] != Array[ i ] )
+                continue;
 
-            for ( int z2 = z + 1; z2 <= bremain.ZMax (); z2++ ) {
-                j   = IndexesToLinearIndex ( x, y, z2 );
-                if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                else break;
-                }
+            if ( c == 0 )   c   = component[ j ];
+            else            Union ( c, component[ j ] );
             }
 
+                                        // not connected to anything scanned so far?
+        if ( c == 0 ) {
+            c               = ++numprovisional;
+            parent[ c ]     = c;
+            }
 
-                                        // 18 neighbors
-            if ( neighborhood >= Neighbors18 ) {
-
-                for ( int x2 = x - 1, y2 = y - 1; x2 >= bremain.XMin () && y2 >= bremain.YMin (); x2--, y2-- ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
-
-                for ( int x2 = x - 1, y2 = y + 1; x2 >= bremain.XMin () && y2 <= bremain.YMax (); x2--, y2++ ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
-
-                for ( int x2 = x + 1, y2 = y - 1; x2 <= bremain.XMax () && y2 >= bremain.YMin (); x2++, y2-- ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
-
-                for ( int x2 = x + 1, y2 = y + 1; x2 <= bremain.XMax () && y2 <= bremain.YMax (); x2++, y2++ ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
-
-
-                for ( int x2 = x - 1, z2 = z - 1; x2 >= bremain.XMin () && z2 >= bremain.ZMin (); x2--, z2-- ) {
-                    j   = IndexesToLinearIndex ( x2, y, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
-
-                for ( int x2 = x - 1, z2 = z + 1; x2 >= bremain.XMin () && z2 <= bremain.ZMax (); x2--, z2++ ) {
-                    j   = IndexesToLinearIndex ( x2, y, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
-
-                for ( int x2 = x + 1, z2 = z - 1; x2 <= bremain.XMax () && z2 >= bremain.ZMin (); x2++, z2-- ) {
-                    j   = IndexesToLinearIndex ( x2, y, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+        component[ i ]  = c;
+        }
+    }
 
-                for ( int x2 = x + 1, z2 = z + 1; x2 <= bremain.XMax () && z2 <= bremain.ZMax (); x2++, z2++ ) {
-                    j   = IndexesToLinearIndex ( x2, y, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Resolving labels - roots always have a lower label, so they are processed before their children
+TArray1<int>        finallabel ( numprovisional + 1 );
+int                 numcomponents   = 0;
 
-                for ( int y2 = y - 1, z2 = z - 1; y2 >= bremain.YMin () && z2 >= bremain.ZMin (); y2--, z2-- ) {
-                    j   = IndexesToLinearIndex ( x, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+for ( int c = 1; c <= numprovisional; c++ ) {
 
-                for ( int y2 = y - 1, z2 = z + 1; y2 >= bremain.YMin () && z2 <= bremain.ZMax (); y2--, z2++ ) {
-                    j   = IndexesToLinearIndex ( x, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+    int         r       = FindRoot ( c );
 
-                for ( int y2 = y + 1, z2 = z - 1; y2 <= bremain.YMax () && z2 >= bremain.ZMin (); y2++, z2-- ) {
-                    j   = IndexesToLinearIndex ( x, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+    finallabel[ c ]     = r == c ? ++numcomponents : finallabel[ r ];
+    }
 
-                for ( int y2 = y + 1, z2 = z + 1; y2 <= bremain.YMax () && z2 <= bremain.ZMax (); y2++, z2++ ) {
-                    j   = IndexesToLinearIndex ( x, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
 
-                } // Neighbors18
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Second pass: final labels, size and bounding box of each component
+TArray1<int>        count ( numcomponents + 1 );
+TArray2<int>        box   ( numcomponents + 1, 6 );
 
+for ( int c = 1; c <= numcomponents; c++ ) {
+    box ( c, 0 )    = box ( c, 2 )  = box ( c, 4 )  = Highest<int> ();
+    box ( c, 1 )    = box ( c, 3 )  = box ( c, 5 )  = Lowest <int> ();
+    }
 
-                                        // 26 neighbors
-            if ( neighborhood >= Neighbors26 ) {
 
-                for ( int x2 = x - 1, y2 = y - 1, z2 = z - 1; x2 >= bremain.XMin () && y2 >= bremain.YMin () && z2 >= bremain.ZMin (); x2--, y2--, z2-- ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+for ( int x = 0; x < Dim1; x++ ) {
 
-                for ( int x2 = x - 1, y2 = y - 1, z2 = z + 1; x2 >= bremain.XMin () && y2 >= bremain.YMin () && z2 <= bremain.ZMax (); x2--, y2--, z2++ ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+    Gauge.SetValue ( SuperGaugeDefaultPart, Dim1 + x );
 
-                for ( int x2 = x - 1, y2 = y + 1, z2 = z - 1; x2 >= bremain.XMin () && y2 <= bremain.YMax () && z2 >= bremain.ZMin (); x2--, y2++, z2-- ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+    for ( int y = 0; y < Dim2; y++ )
+    for ( int z = 0; z < Dim3; z++ ) {
 
-                for ( int x2 = x - 1, y2 = y + 1, z2 = z + 1; x2 >= bremain.XMin () && y2 <= bremain.YMax () && z2 <= bremain.ZMax (); x2--, y2++, z2++ ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+        int         i       = IndexesToLinearIndex ( x, y, z );
 
-                for ( int x2 = x + 1, y2 = y - 1, z2 = z - 1; x2 <= bremain.XMax () && y2 >= bremain.YMin () && z2 >= bremain.ZMin (); x2++, y2--, z2-- ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+        if ( component[ i ] == 0 )
+            continue;
 
-                for ( int x2 = x + 1, y2 = y - 1, z2 = z + 1; x2 <= bremain.XMax () && y2 >= bremain.YMin () && z2 <= bremain.ZMax (); x2++, y2--, z2++ ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+        int         c       = finallabel[ component[ i ] ];
 
-                for ( int x2 = x + 1, y2 = y + 1, z2 = z - 1; x2 <= bremain.XMax () && y2 <= bremain.YMax () && z2 >= bremain.ZMin (); x2++, y2++, z2-- ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+        component[ i ]  = c;
+        count    [ c ]++;
 
-                for ( int x2 = x + 1, y2 = y + 1, z2 = z + 1; x2 <= bremain.XMax () && y2 <= bremain.YMax () && z2 <= bremain.ZMax (); x2++, y2++, z2++ ) {
-                    j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    if ( Array[ j ] == l && voxelstodo[ j ] ) { edge[ j ] = true; edgecount++; voxelstodo[ j ] = false; numvoxelstodo--; }
-                    else break;
-                    }
+        Mined ( box ( c, 0 ), x );  Maxed ( box ( c, 1 ), x );
+        Mined ( box ( c, 2 ), y );  Maxed ( box ( c, 3 ), y );
+        Mined ( box ( c, 4 ), z );  Maxed ( box ( c, 5 ), z );
+        }
+    }
 
-                } // Neighbors26
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Regions of the right size, allocated to their bounding box
+TArray1<TVolumeRegion*>     regions ( numcomponents + 1 );
+int                         index           = 1;
 
-                                        // inflate edge only, using current point
-//            bedge.Set ( max ( bremain.XMin (), min ( bedge.XMin (), x - 1 ) ), min ( bremain.XMax (), max ( bedge.XMax (), x + 1 ) ),
-//                        max ( bremain.YMin (), min ( bedge.YMin (), y - 1 ) ), min ( bremain.YMax (), max ( bedge.YMax (), y + 1 ) ),
-//                        max ( bremain.ZMin (), min ( bedge.ZMin (), z - 1 ) ), min ( bremain.ZMax (), max ( bedge.ZMax (), z + 1 ) ) );
+for ( int c = 1; c <= numcomponents; c++ )
 
-            } // process edge
+    regions[ c ]    = IsInsideLimits ( count[ c ], minvoxels, maxvoxels ) ? new TVolumeRegion ( box ( c, 1 ) - box ( c, 0 ) + 1, box ( c, 3 ) - box ( c, 2 ) + 1, box ( c, 5 ) - box ( c, 4 ) + 1,
+                                                                                                box ( c, 0 ),                     box ( c, 2 ),                     box ( c, 4 ),
+                                                                                                index++ )
+                                                                          : 0;
 
 
-                                        // exact box, handles inflation and deletion
-//        bedge       = TBoundingBox<int> ( edge, 0.1 );
-                                        // inflate edge only with global increment
-        bedge.Set ( max ( bremain.XMin (), bedge.XMin () - 1 ), min ( bremain.XMax (), bedge.XMax () + 1 ),
-                    max ( bremain.YMin (), bedge.YMin () - 1 ), min ( bremain.YMax (), bedge.YMax () + 1 ),
-                    max ( bremain.ZMin (), bedge.ZMin () - 1 ), min ( bremain.ZMax (), bedge.ZMax () + 1 ) );
-
+for ( int i = 0; i < LinearDim; i++ ) {
 
-        Gauge.SetValue ( SuperGaugeDefaultPart, numvoxelstotal - numvoxelstodo );
+    int         c       = component[ i ];
 
-        } while ( edgecount );
+    if ( c == 0 || regions[ c ] == 0 )
+        continue;
 
-                                        // update region
-    region->Set ( true );
+    int         x;
+    int         y;
+    int         z;
 
-                                        // enough points?
-    int         rnp     = region->GetNumPoints ();
+    LinearIndexToXYZ ( i, x, y, z );
 
-    if ( rnp >= minvoxels && rnp <= maxvoxels ) {
-
-        gor.Add ( region );
+    (*regions[ c ]) ( x - box ( c, 0 ), y - box ( c, 2 ), z - box ( c, 4 ) )  = 1;
+    }
 
-        index++;
-        }
-    else
-        delete  region;
+                                        // update regions: already compacted, computing stats only
+OmpParallelFor
 
+for ( int c = 1; c <= numcomponents; c++ )
+    if ( regions[ c ] )
+        regions[ c ]->Set ( true );
 
-//  Gauge.SetValue ( SuperGaugeDefaultPart, numvoxelstotal - numvoxelstodo );
 
-    } while ( numvoxelstodo );
+for ( int c = 1; c <= numcomponents; c++ )
+    if ( regions[ c ] )
+        gor.Add ( regions[ c ] );
 
                                         // By decreasing # of points in regions
 gor.Sort ( SortRegionsCount );
+}
+
 
+//----------------------------------------------------------------------------
+                                        // Each geometrical cluster of same level becomes a region
+template <class TypeD>
+void    TVolume<TypeD>::LevelsClustersToRegions ( TVolumeRegions& gor, int minvoxels, int maxvoxels, NeighborhoodType neighborhood, bool showprogress )
+{
+ConnectedComponentsToRegions ( gor, minvoxels, maxvoxels, neighborhood, true, showprogress );
 }
 
 
@@ -734,330 +647,11 @@ gor.Sort ( SortRegionsCount );
 */
 
 //----------------------------------------------------------------------------
-                                        // Second version of ClustersToRegions
                                         // Each geometrical cluster of ANY level becomes a region
 template <class TypeD>
 void    TVolume<TypeD>::ClustersToRegions ( TVolumeRegions& gor, int minvoxels, int maxvoxels, NeighborhoodType neighborhood, bool showprogress )
 {
-gor.Reset ();
-
-                                        // coding content to do
-enum        VoxelCodeEnum
-            {
-            VoxelDone       = 0,
-            VoxelToDo       = 1,
-            VoxelRegion     = 2,
-            VoxelSeed       = 3,
-            };
-                                        // account for the remaining voxels to process - keeping MriType for the TBoundingBox constructor
-TVolume<uchar>      voxelcode ( Dim1, Dim2, Dim3 );
-
-OmpParallelFor
-
-for ( int i = 0; i < LinearDim; i++ )
-    voxelcode[ i ]  = (uchar) ( Array[ i ] ? VoxelToDo : VoxelDone );
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-int                 index           = 1;
-TVolumeRegion*      region;
-
-//int                 x,  y,  z;
-int                 numvoxelstotal  = voxelcode.GetNumSet ();
-int                 numvoxelstodo   = numvoxelstotal;
-TBoundingBox<int>   bremain;
-TBoundingBox<int>   bseed;
-bool                expanded;
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-TSuperGauge         Gauge ( FilterPresets[ FilterTypeClustersToRegions ].Text, showprogress ? numvoxelstotal : 0 );
-
-Gauge.SetValue ( SuperGaugeDefaultPart, 0 );
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-
-do {
-
-    Gauge.SetValue ( SuperGaugeDefaultPart, numvoxelstotal - numvoxelstodo );
-
-                                        // recompute remaining voxels' box at each iteration
-    bremain.Set ( voxelcode, false, 0.1 );
-
-                                        // get next voxel seed
-    for ( int x = bremain.XMin (); x <= bremain.XMax (); x++ )
-    for ( int y = bremain.YMin (); y <= bremain.YMax (); y++ )
-    for ( int z = bremain.ZMin (); z <= bremain.ZMax (); z++ )
-
-        if ( voxelcode ( x, y, z ) == VoxelToDo ) {
-                                        // single voxel seed
-            voxelcode ( x, y, z )   = VoxelSeed;
-
-            bseed  .Set ( x, x, y, y, z, z );
-
-            goto seedexists;
-            }
-
-    break;                              // no seed -> exit the main loop
-
-    seedexists:
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // expand seed / region
-    int                 numvoxels       = 0;
-
-
-    do {
-//      Gauge.Blink ();
-
-
-        expanded = false;
-
-        OmpParallelFor
-
-        for ( int x = bseed.XMin (); x <= bseed.XMax (); x++ )
-        for ( int y = bseed.YMin (); y <= bseed.YMax (); y++ )
-        for ( int z = bseed.ZMin (); z <= bseed.ZMax (); z++ ) {
-
-                                        // expand only from a part of the current region
-            if ( voxelcode ( x, y, z ) != VoxelSeed )
-                continue;
-
-                                        // continue current expansion if not already done, adding only voxels not yet marked by the current region
-#define         regiongrowinginnerloop(J) \
-                if      ( voxelcode[ J ] == VoxelToDo )   { voxelcode[ J ] = VoxelSeed; expanded = true; } \
-                else if ( voxelcode[ J ] == VoxelDone )     break;
-//              else VoxelSeed || VoxelRegion               continue;   // to progress the scan
-
-
-/*                                        // continue current expansion if not already done,
-#define         regiongrowinginnerloop(J) \
-                if      ( voxelcode[ J ] == VoxelToDo || voxelcode[ J ] == VoxelSeed )    { voxelcode[ J ] = VoxelSeed; expanded = true; } \
-                else if ( voxelcode[ J ] == VoxelDone )                                     break;
-//              else VoxelRegion                                                            continue;   // to progress the scan*/
-
-
-/*                                        // continue current expansion if not already done, marking untouched voxels and re-seeding previous seeds, too
-#define         regiongrowinginnerloop(J) \
-                if ( voxelcode[ J ] == VoxelToDo || voxelcode[ J ] == VoxelSeed ) { voxelcode[ J ] = VoxelSeed; expanded = true; } \
-                else                                                                break;*/
-
-
-/*#define         regiongrowinginnerloop(J) \
-                if ( voxelcode[ J ] == VoxelToDo )    { voxelcode[ J ] = VoxelSeed; expanded = true; } \
-                else                                    break;*/
-
-
-                                        // 6 neighbors
-//          if ( neighborhood >= Neighbors6 ) {
-                {
-                for ( int x2 = x - 1; x2 >= bremain.XMin (); x2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y, z );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1; x2 <= bremain.XMax (); x2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y, z );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int y2 = y - 1; y2 >= bremain.YMin (); y2-- ) {
-                    int     j   = IndexesToLinearIndex ( x, y2, z );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int y2 = y + 1; y2 <= bremain.YMax (); y2++ ) {
-                    int     j   = IndexesToLinearIndex ( x, y2, z );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int z2 = z - 1; z2 >= bremain.ZMin (); z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x, y, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int z2 = z + 1; z2 <= bremain.ZMax (); z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x, y, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                } // Neighbors6
-
-                                        // 18 neighbors
-            if ( neighborhood >= Neighbors18 ) {
-
-                for ( int x2 = x - 1, y2 = y - 1; x2 >= bremain.XMin () && y2 >= bremain.YMin (); x2--, y2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x - 1, y2 = y + 1; x2 >= bremain.XMin () && y2 <= bremain.YMax (); x2--, y2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1, y2 = y - 1; x2 <= bremain.XMax () && y2 >= bremain.YMin (); x2++, y2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1, y2 = y + 1; x2 <= bremain.XMax () && y2 <= bremain.YMax (); x2++, y2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z );
-                    regiongrowinginnerloop ( j );
-                    }
-
-
-                for ( int x2 = x - 1, z2 = z - 1; x2 >= bremain.XMin () && z2 >= bremain.ZMin (); x2--, z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x - 1, z2 = z + 1; x2 >= bremain.XMin () && z2 <= bremain.ZMax (); x2--, z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1, z2 = z - 1; x2 <= bremain.XMax () && z2 >= bremain.ZMin (); x2++, z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1, z2 = z + 1; x2 <= bremain.XMax () && z2 <= bremain.ZMax (); x2++, z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-
-                for ( int y2 = y - 1, z2 = z - 1; y2 >= bremain.YMin () && z2 >= bremain.ZMin (); y2--, z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int y2 = y - 1, z2 = z + 1; y2 >= bremain.YMin () && z2 <= bremain.ZMax (); y2--, z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int y2 = y + 1, z2 = z - 1; y2 <= bremain.YMax () && z2 >= bremain.ZMin (); y2++, z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int y2 = y + 1, z2 = z + 1; y2 <= bremain.YMax () && z2 <= bremain.ZMax (); y2++, z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                } // Neighbors18
-
-                                        // 26 neighbors
-            if ( neighborhood >= Neighbors26 ) {
-
-                for ( int x2 = x - 1, y2 = y - 1, z2 = z - 1; x2 >= bremain.XMin () && y2 >= bremain.YMin () && z2 >= bremain.ZMin (); x2--, y2--, z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x - 1, y2 = y - 1, z2 = z + 1; x2 >= bremain.XMin () && y2 >= bremain.YMin () && z2 <= bremain.ZMax (); x2--, y2--, z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x - 1, y2 = y + 1, z2 = z - 1; x2 >= bremain.XMin () && y2 <= bremain.YMax () && z2 >= bremain.ZMin (); x2--, y2++, z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x - 1, y2 = y + 1, z2 = z + 1; x2 >= bremain.XMin () && y2 <= bremain.YMax () && z2 <= bremain.ZMax (); x2--, y2++, z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1, y2 = y - 1, z2 = z - 1; x2 <= bremain.XMax () && y2 >= bremain.YMin () && z2 >= bremain.ZMin (); x2++, y2--, z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1, y2 = y - 1, z2 = z + 1; x2 <= bremain.XMax () && y2 >= bremain.YMin () && z2 <= bremain.ZMax (); x2++, y2--, z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1, y2 = y + 1, z2 = z - 1; x2 <= bremain.XMax () && y2 <= bremain.YMax () && z2 >= bremain.ZMin (); x2++, y2++, z2-- ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                for ( int x2 = x + 1, y2 = y + 1, z2 = z + 1; x2 <= bremain.XMax () && y2 <= bremain.YMax () && z2 <= bremain.ZMax (); x2++, y2++, z2++ ) {
-                    int     j   = IndexesToLinearIndex ( x2, y2, z2 );
-                    regiongrowinginnerloop ( j );
-                    }
-
-                } // Neighbors26
-
-
-            voxelcode ( x, y, z )  = VoxelRegion;
-                                        // one more voxel
-            OmpAtomic
-            numvoxels++;
-            } // for x, y, z
-                                        // force edge box to be the whole remaining data - seems faster (!?)
-        bseed       = bremain;
-
-        } while ( expanded );
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // Region has fully grown here
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // update remaining nunmber of voxels
-    numvoxelstodo  -= numvoxels;
-
-                                        // we might create a region with the right size straight away?
-    region          = IsInsideLimits ( numvoxels, minvoxels, maxvoxels )    ?   new TVolumeRegion ( this, index )  :   0;
-
-
-    OmpParallelFor
-
-    for ( int x = bremain.XMin (); x <= bremain.XMax (); x++ )
-    for ( int y = bremain.YMin (); y <= bremain.YMax (); y++ )
-    for ( int z = bremain.ZMin (); z <= bremain.ZMax (); z++ ) {
-
-        if ( voxelcode ( x, y, z ) == VoxelRegion ) {
-//          OmpCriticalBegin (ClustersToRegions)
-                                        // if region OK
-            if ( region )   (*region) ( x, y, z )   = 1;
-                                        // reset in all cases
-            voxelcode ( x, y, z ) = VoxelDone;
-
-//          OmpCriticalEnd
-            }
-        }
-
-
-    if ( region ) {
-                                        // update region: compacting memory & computing stats
-        region->Set ( true );
-
-//      if ( VkQuery () )  region->Show ( "region scanned" );
-
-        gor.Add ( region );
-
-        index++;
-        }
-
-    } while ( numvoxelstodo >= minvoxels );
-
-
-//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-                                        // By decreasing # of points in regions
-gor.Sort ( SortRegionsCount );
-
+ConnectedComponentsToRegions ( gor, minvoxels, maxvoxels, neighborhood, false, showprogress );
 }
 
 
@@ -1279,6 +873,40 @@ TEasyStats          globalnonregionstat;
 //TEasyStats          statlocal;
 
 
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+                                        // Local stats spherical neighborhood, stored as runs of consecutive z, one for each (dx,dy)
+int                 statsextent     = (int) statsradius;
+TArray2<int>        statsspans      ( Square ( 2 * statsextent + 1 ), 3 );  // dx, dy, half z length
+int                 numstatsspans   = 0;
+
+if ( localstats )
+
+    for ( int dx = -statsextent; dx <= statsextent; dx++ )
+    for ( int dy = -statsextent; dy <= statsextent; dy++ ) {
+
+        double              r2              = Square ( (double) dx ) + Square ( (double) dy );
+
+        if ( r2 > statsradius2 )
+            continue;
+
+        int                 dz              = 0;
+
+        while ( dz < statsextent && r2 + Square ( (double) ( dz + 1 ) ) <= statsradius2 )
+            dz++;
+
+        statsspans ( numstatsspans, 0 ) = dx;
+        statsspans ( numstatsspans, 1 ) = dy;
+        statsspans ( numstatsspans, 2 ) = dz;
+        numstatsspans++;
+        }
+
+                                        // Growing front: the only voxels that need to be tested at each iteration
+TArray1<int>        front           ( LinearDim );
+int                 numfront;
+int                 neighbors[ 26 ][ 3 ];
+int                 numneighbors;
+
+
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // seed is already 1
 iteration       = 1;
@@ -1363,6 +991,67 @@ do {
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
                                         // 2) Growing region
+                                        // offsets of the current neighborhood, 6 / 18 / 26 neighbors having up to 1 / 2 / 3 non-null offsets
+    int                 maxoffsets      = neighborhood == Neighbors6 ? 1 : neighborhood == Neighbors18 ? 2 : 3;
+
+    numneighbors    = 0;
+
+    for ( int dx = -1; dx <= 1; dx++ )
+    for ( int dy = -1; dy <= 1; dy++ )
+    for ( int dz = -1; dz <= 1; dz++ ) {
+
+        int                 numoffsets      = abs ( dx ) + abs ( dy ) + abs ( dz );
+
+        if ( numoffsets == 0 || numoffsets > maxoffsets )
+            continue;
+
+        neighbors[ numneighbors ][ 0 ]  = dx;
+        neighbors[ numneighbors ][ 1 ]  = dy;
+        neighbors[ numneighbors ][ 2 ]  = dz;
+        numneighbors++;
+        }
+
+                                        // the front: stats voxels with at least a free neighbor, as the inner ones can not grow anything
+                                        // when moving, any stats voxel can be revoked, so they all belong to the front
+    numfront        = 0;
+
+    for ( int i = 0; i < LinearDim; i++ ) {
+
+        if ( mask && ! mask->GetValue ( i ) )
+            continue;
+
+        if ( ! ( statsmask && IsVoxelMask ( regionvol[ i ] )
+              || statsring && IsVoxelRing ( regionvol[ i ] ) ) )
+            continue;
+
+        if ( moveregion ) {
+            front[ numfront++ ] = i;
+            continue;
+            }
+
+
+        int                 x,  y,  z;
+        LinearIndexToXYZ ( i, x, y, z );
+
+        for ( int n = 0; n < numneighbors; n++ ) {
+
+            int     x2      = x + neighbors[ n ][ 0 ];
+            int     y2      = y + neighbors[ n ][ 1 ];
+            int     z2      = z + neighbors[ n ][ 2 ];
+
+            if ( ! WithinBoundary ( x2, y2, z2 ) )
+                continue;
+
+            int     j       = IndexesToLinearIndex ( x2, y2, z2 );
+
+            if ( mask && ! mask->GetValue ( j ) || regionvol[ j ] )
+                continue;
+
+            front[ numfront++ ] = i;
+            break;
+            }
+        }
+
                                         // make a copy of current region
     regionvolnew.Insert ( regionvol );
 
@@ -1378,16 +1067,9 @@ do {
 
     OmpFor
 
-    for ( int i = 0; i < LinearDim; i++ ) {
-
-        if ( mask && ! mask->GetValue ( i ) )
-            continue;
-
-        if ( ! ( statsmask && IsVoxelMask ( regionvol[ i ] )
-              || statsring && IsVoxelRing ( regionvol[ i ] ) ) )
-            continue;
-
+    for ( int fi = 0; fi < numfront; fi++ ) {
 
+        int                 i               = front[ fi ];
         int                 x;
         int                 y;
         int                 z;
@@ -1400,44 +1082,40 @@ do {
                                         // do local stats around current voxel
         if ( localstats ) {
 
-            int                 xmin            = AtLeast ( 0,          x - (int) statsradius );
-            int                 xmax            = NoMore  ( Dim1 - 1,   x + (int) statsradius );
-            int                 ymin            = AtLeast ( 0,          y - (int) statsradius );
-            int                 ymax            = NoMore  ( Dim2 - 1,   y + (int) statsradius );
-            int                 zmin            = AtLeast ( 0,          z - (int) statsradius );
-            int                 zmax            = NoMore  ( Dim3 - 1,   z + (int) statsradius );
-
-
             localregionstat   .Reset ();
             localnonregionstat.Reset ();
 
-                                        // cubic local neighborhood
-            for ( int xk = xmin; xk <= xmax; xk++ )
-            for ( int yk = ymin; yk <= ymax; yk++ )
-            for ( int zk = zmin; zk <= zmax; zk++ ) {
+                                        // spherical local neighborhood, scanned by runs of consecutive voxels
+            for ( int si = 0; si < numstatsspans; si++ ) {
 
-                int             in          = IndexesToLinearIndex ( xk, yk, zk );
+                int             xk          = x + statsspans ( si, 0 );
+                int             yk          = y + statsspans ( si, 1 );
 
-                if ( mask && ! mask->GetValue ( in ) )
+                if ( xk < 0 || xk >= Dim1 || yk < 0 || yk >= Dim2 )
                     continue;
 
-                                        // inside spherical neighborhood?
-                if ( Square ( (double) ( xk - x ) ) + Square ( (double) ( yk - y ) ) + Square ( (double) ( zk - z ) ) > statsradius2 )
-                    continue;
+                int             zmin        = AtLeast ( 0,          z - statsspans ( si, 2 ) );
+                int             zmax        = NoMore  ( Dim3 - 1,   z + statsspans ( si, 2 ) );
+
+                for ( int in = IndexesToLinearIndex ( xk, yk, zmin ); in <= IndexesToLinearIndex ( xk, yk, zmax ); in++ ) {
+
+                    if ( mask && ! mask->GetValue ( in ) )
+                        continue;
 
 
-                if ( statsmask && IsVoxelMask ( regionvol[ in ] )
-                  || statsring && IsVoxelRing ( regionvol[ in ] ) )
+                    if ( statsmask && IsVoxelMask ( regionvol[ in ] )
+                      || statsring && IsVoxelRing ( regionvol[ in ] ) )
 
-                    localregionstat.Add ( GetValue ( in ), ThreadSafetyIgnore );
+                        localregionstat.Add ( GetValue ( in ), ThreadSafetyIgnore );
 
-                else if ( /*GetValue ( in ) != 0 && or Mask */ ! IsVoxelMask ( regionvol[ in ] ) ) // always global mask
+                    else if ( /*GetValue ( in ) != 0 && or Mask */ ! IsVoxelMask ( regionvol[ in ] ) ) // always global mask
                                         // border of the ring
-//                  if ( regionvol.GetNumNeighbors ( xk, yk, zk, neighborhood ) > 0 )
+//                      if ( regionvol.GetNumNeighbors ( xk, yk, zk, neighborhood ) > 0 )
                                         // we don't have enough samples in the ring-not-in-mask, so use everything not the mask
-                        localnonregionstat.Add ( GetValue ( in ), ThreadSafetyIgnore );
+                            localnonregionstat.Add ( GetValue ( in ), ThreadSafetyIgnore );
 
-                } // for xk, yk, zk
+                    } // for in
+                } // for statsspans
 
 
             regionavg       = localregionstat   .Average ();
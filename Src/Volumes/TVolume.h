@@ -235,6 +235,17 @@ constexpr int   RegionGrowingMaxIterationsDefault   = INT_MAX;
 constexpr auto  SmartNeighbors                      = Neighbors26 + 1;
 
 
+//----------------------------------------------------------------------------
+                                        // Fast Gaussian: above this number of elementary passes, switch to a recursive Gaussian
+constexpr int   FastGaussianMaxRepeat               = 8;
+
+
+//----------------------------------------------------------------------------
+                                        // Waterfall flooding: integer data have one level per value, up to this limit,
+                                        // floating point data are quantized to this number of levels
+constexpr int   WaterfallMaxNumLevels               = 65536;
+
+
 
 enum            GreyLevelsCategories
                 {
@@ -487,6 +498,8 @@ public:
 
 protected:
 
+    void            ConnectedComponentsToRegions ( TVolumeRegions& gor, int minvoxels, int maxvoxels, NeighborhoodType neighborhood, bool samelevel, bool showprogress );
+
     void            FilterLinear        ( FilterTypes filtertype, FctParams& params, bool showprogress = false );
     void            FilterStat          ( FilterTypes filtertype, FctParams& params, bool showprogress = false );
     void            FilterFastGaussian  ( FilterTypes filtertype, FctParams& params, bool showprogress = false );
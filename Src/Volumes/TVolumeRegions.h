@@ -40,6 +40,7 @@ class   TVolumeRegion : public  TVolume<RegionType>,
 public:
                     TVolumeRegion ();
                     TVolumeRegion ( const Volume* volume, int index );    // same size as volume, but empty
+                    TVolumeRegion ( int dim1, int dim2, int dim3, int shift1, int shift2, int shift3, int index );  // sub-volume of a bigger volume, shift being its origin, empty
 
 
     TPointFloat     Center;
@@ -88,9 +89,6 @@ public:
 
 protected:
 
-                    TVolumeRegion ( int dim1, int dim2, int dim3, int shift1, int shift2, int shift3, int index );  // Shrinking from a bigger volume
-
-
     int             NumPoints;
     TPointInt       Translation;        // A region is a sub-volume, this is the offset to access the absolute coordinates
 